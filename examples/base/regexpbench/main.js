@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016-2017  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK.
+ * 
+ *   This work is licensed under the
+ *       Creative Commons Attribution 4.0 International License.
+ *   To view a copy of this license, visit
+ *       <http://creativecommons.org/licenses/by/4.0>.
+ *   or send a letter to Creative Commons, PO Box 1866,
+ *   Mountain View, CA 94042, USA.
+ *
+ */
+
+/*---
+flags: [onlyStrict]
+---*/
+
+/*
+	Regular expression throughput on log lines, URL routing and CSV splitting,
+	and on patterns that backtrack exponentially.
+	Runs as an application, or with xst from a test262 test directory.
+*/
+
+const log = (typeof trace == "function") ? function(s) { trace(s + "\n"); } : print;
+
+const levels = ["INFO", "DEBUG", "WARN", "ERROR"];
+const lines = [];
+for (let i = 0; i < 200; i++)
+	lines.push(`2018-03-${10 + (i % 20)} 12:${10 + (i % 50)}:${10 + (i % 49)} ${levels[i % 4]} [net] request ${i} from 192.168.1.${i % 255} took ${i * 7} ms`);
+const text = lines.join("\n");
+
+const routes = [
+	/^\/$/,
+	/^\/login$/,
+	/^\/logout$/,
+	/^\/users$/,
+	/^\/users\/(\d+)$/,
+	/^\/users\/(\d+)\/posts$/,
+	/^\/posts\/(\d+)\/comments\/(\d+)$/,
+	/^\/static\/([\w.-]+)\.(css|js|png)$/,
+	/^\/api\/v1\/devices\/([0-9a-f]{12})\/status$/,
+	/^\/api\/v1\/devices\/([0-9a-f]{12})\/config$/,
+];
+const paths = ["/", "/users/42", "/users/42/posts", "/posts/7/comments/3", "/static/app.min.js", "/api/v1/devices/0123456789ab/config", "/missing/page"];
+
+function route(path) {
+	for (let i = 0; i < routes.length; i++) {
+		let match = routes[i].exec(path);
+		if (match)
+			return match;
+	}
+}
+
+const rows = [];
+for (let i = 0; i < 100; i++)
+	rows.push(`${i},"name ${i}",${i * 3.5},"a, b and c",${i % 2 ? "true" : "false"},,end`);
+const csv = rows.join("\n");
+
+const runs = [];
+for (let i = 0; i < 10; i++)
+	runs.push("a".repeat(10 + i) + "!bc");
+
+const cases = {
+	"log: search ERROR"() {
+		let count = 0;
+		for (let line of lines)
+			if (/ERROR/.test(line)) count++;
+		return count;
+	},
+	"log: fields"() {
+		let count = 0;
+		for (let line of lines) {
+			let match = /^(\d{4})-(\d\d)-(\d\d) (\d\d):(\d\d):(\d\d) (\w+) \[(\w+)\] (.*)$/.exec(line);
+			if (match) count++;
+		}
+		return count;
+	},
+	"log: global scan"() {
+		let count = 0, regexp = /took (\d+) ms/g;
+		while (regexp.exec(text)) count++;
+		return count;
+	},
+	"log: addresses"() {
+		let count = 0, regexp = /\b(\d{1,3})\.(\d{1,3})\.(\d{1,3})\.(\d{1,3})\b/g;
+		while (regexp.exec(text)) count++;
+		return count;
+	},
+	"route: match"() {
+		let count = 0;
+		for (let i = 0; i < 20; i++) {
+			for (let path of paths)
+				if (route(path)) count++;
+		}
+		return count;
+	},
+	"csv: split"() {
+		let count = 0;
+		for (let row of rows)
+			count += row.split(/,/).length;
+		return count;
+	},
+	"csv: fields"() {
+		let count = 0, regexp = /("[^"]*"|[^,\n]*)(,|\n|$)/g, match;
+		while ((match = regexp.exec(csv)) && match[0].length) count++;
+		return count;
+	},
+	"case insensitive"() {
+		let count = 0;
+		for (let line of lines)
+			if (/request \d+ FROM/i.test(line)) count++;
+		return count;
+	},
+	"hostile: nested quantifiers"() {
+		let count = 0;
+		for (let run of runs)
+			if (/^(a+)+b/.test(run)) count++;
+		return count;
+	},
+	"hostile: overlapping alternatives"() {
+		let count = 0;
+		for (let run of runs)
+			if (/^(a|aa)*c/.test(run)) count++;
+		return count;
+	},
+};
+
+for (let name in cases) {
+	let test = cases[name], result, iterations = 100;
+	let start = Date.now();
+	for (let i = 0; i < iterations; i++)
+		result = test();
+	log(`${name}: ${((Date.now() - start) / iterations).toFixed(2)} ms (${result})`);
+}
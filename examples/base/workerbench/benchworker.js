@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2016-2017  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK.
+ * 
+ *   This work is licensed under the
+ *       Creative Commons Attribution 4.0 International License.
+ *   To view a copy of this license, visit
+ *       <http://creativecommons.org/licenses/by/4.0>.
+ *   or send a letter to Creative Commons, PO Box 1866,
+ *   Mountain View, CA 94042, USA.
+ *
+ */
+
+self.onmessage = function(message) {
+	let result = 0;
+	for (let i = 0; i < message.work; i++)
+		result = (result + i * 7) % 1000003;
+	self.postMessage({ index: message.index, result });
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016-2017  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK.
+ * 
+ *   This work is licensed under the
+ *       Creative Commons Attribution 4.0 International License.
+ *   To view a copy of this license, visit
+ *       <http://creativecommons.org/licenses/by/4.0>.
+ *   or send a letter to Creative Commons, PO Box 1866,
+ *   Mountain View, CA 94042, USA.
+ *
+ */
+
+/*
+	Message and compute throughput with 1, 2, 4 and 8 workers.
+	"messages" bounces a fixed number of small objects through the workers,
+	"compute" spreads a fixed number of busy loops over them.
+*/
+
+import Worker from "worker";
+
+const counts = [1, 2, 4, 8];
+const modes = {
+	messages: { total: 40000, work: 0, inflight: 16 },
+	compute: { total: 16, work: 4000000, inflight: 1 },
+};
+
+function round(mode, count, done) {
+	const { total, work, inflight } = modes[mode];
+	const workers = [];
+	let sent = 0, received = 0;
+	let start = Date.now();
+	function post(worker) {
+		sent++;
+		worker.postMessage({ index: sent, work, payload: "abcdefghijklmnop" });
+	}
+	for (let i = 0; i < count; i++) {
+		let worker = new Worker("benchworker", {stackCount: 256, slotCount: 1024});
+		worker.onmessage = function(message) {
+			received++;
+			if (sent < total)
+				post(this);
+			else if (received == total) {
+				let ms = Date.now() - start;
+				workers.forEach(worker => worker.terminate());
+				done(ms);
+			}
+		};
+		workers.push(worker);
+	}
+	for (let k = 0; k < inflight; k++)
+		workers.forEach(worker => { if (sent < total) post(worker) });
+}
+
+const rounds = [];
+for (let mode in modes)
+	counts.forEach(count => rounds.push({ mode, count }));
+const base = {};
+
+function next() {
+	const item = rounds.shift();
+	if (!item)
+		return;
+	round(item.mode, item.count, ms => {
+		if (1 == item.count)
+			base[item.mode] = ms;
+		let rate = modes[item.mode].total * 1000 / ms;
+		trace(`${item.mode} workers: ${item.count} ${ms} ms ${rate.toFixed(0)}/s speedup ${(base[item.mode] / ms).toFixed(2)}x\n`);
+		next();
+	});
+}
+
+next();
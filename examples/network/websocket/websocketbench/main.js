@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2016-2017  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK.
+ * 
+ *   This work is licensed under the
+ *       Creative Commons Attribution 4.0 International License.
+ *   To view a copy of this license, visit
+ *       <http://creativecommons.org/licenses/by/4.0>.
+ *   or send a letter to Creative Commons, PO Box 1866,
+ *   Mountain View, CA 94042, USA.
+ *
+ */
+
+/*
+	Echo throughput of 1 KB to 1 MB binary messages between a client and a local server.
+	Each size echoes about 4 MB, one message at a time.
+	Remove the larger sizes on devices without the memory for them.
+*/
+
+import {Client, Server} from "websocket";
+
+const port = 8080;
+const sizes = [1024, 4096, 16384, 65536, 262144, 1048576];
+const maxMessage = sizes[sizes.length - 1];
+
+let server = new Server({port, maxMessage});
+server.callback = function(message, value) {
+	if (3 == message)
+		this.write(value);
+};
+
+let client = new Client({host: "localhost", address: "127.0.0.1", port, maxMessage});
+let size, payload, total, received, start;
+
+function next() {
+	size = sizes.shift();
+	if (!size) {
+		client.close();
+		server.close();
+		return;
+	}
+	payload = new ArrayBuffer(size);
+	let bytes = new Uint8Array(payload);
+	for (let i = 0; i < size; i++)
+		bytes[i] = i;
+	total = Math.max(4, (4 * 1048576) / size);
+	received = 0;
+	start = Date.now();
+	client.write(payload);
+}
+
+client.callback = function(message, value) {
+	if (2 == message)
+		next();
+	else if (3 == message) {
+		let bytes = new Uint8Array(value);
+		if ((value.byteLength != size) || (bytes[size - 1] != ((size - 1) & 0xFF)))
+			throw new Error("bad echo");
+		if (++received < total) {
+			this.write(value);
+			return;
+		}
+		let ms = Math.max(1, Date.now() - start);
+		trace(`${size} bytes: ${total} messages ${ms} ms ${((total * size * 2) / (ms * 1048.576)).toFixed(1)} MB/s ${(ms / total).toFixed(3)} ms/message\n`);
+		next();
+	}
+	else if (4 == message)
+		trace("closed\n");
+};
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2016-2017  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK.
+ * 
+ *   This work is licensed under the
+ *       Creative Commons Attribution 4.0 International License.
+ *   To view a copy of this license, visit
+ *       <http://creativecommons.org/licenses/by/4.0>.
+ *   or send a letter to Creative Commons, PO Box 1866,
+ *   Mountain View, CA 94042, USA.
+ *
+ */
+
+/*
+	permessage-deflate on JSON telemetry echoed between a client and a local server.
+	For each setting, reports the ratio of message bytes to bytes the client writes, and round trip time per message.
+	The difference from the uncompressed round trip is the cost of two deflates and two inflates.
+*/
+
+import {Socket} from "socket";
+import {Client, Server} from "websocket";
+
+const port = 8080;
+const count = 1000;
+const settings = [
+	undefined,
+	{level: 1},
+	{level: 6},
+	{level: 9},
+	{level: 1, windowBits: 10},
+	{level: 1, contextTakeover: false},
+	{level: 0},
+];
+
+const messages = [];
+for (let i = 0; i < count; i++) {
+	messages.push(JSON.stringify({
+		device: "sensor-0042",
+		sequence: i,
+		time: 1539700000000 + (i * 1000),
+		temperature: 21.5 + ((i % 7) / 10),
+		humidity: 40 + (i % 13),
+		battery: 3.7 - (i / 10000),
+		status: (i % 50) ? "ok" : "low",
+		tags: ["kitchen", "floor-1"],
+	}));
+}
+
+let written = 0;
+class CountingSocket extends Socket {
+	write(...items) {
+		for (let item of items) {
+			if ("string" !== typeof item)
+				written += item.byteLength;
+		}
+		return super.write(...items);
+	}
+}
+
+let server, client, deflate, index, bytes, start;
+
+function next() {
+	if (!settings.length)
+		return;
+	deflate = settings.shift();
+	server = new Server({port, deflate});
+	server.callback = function(message, value) {
+		if (3 == message)
+			this.write(value);
+	};
+	client = new Client({host: "localhost", address: "127.0.0.1", port, deflate, Socket: CountingSocket});
+	client.callback = function(message, value) {
+		if (2 == message) {
+			index = 0;
+			bytes = 0;
+			written = 0;
+			start = Date.now();
+			this.write(messages[0]);
+		}
+		else if (3 == message) {
+			if (value !== messages[index])
+				throw new Error("bad echo");
+			bytes += value.length;
+			if (++index < count) {
+				this.write(messages[index]);
+				return;
+			}
+			let ms = Date.now() - start;
+			trace(`${deflate ? JSON.stringify(deflate) : "uncompressed"}: ${(bytes / written).toFixed(2)}x ${(ms / count).toFixed(3)} ms/message\n`);
+			this.close();
+			server.close();
+			next();
+		}
+	};
+}
+
+next();
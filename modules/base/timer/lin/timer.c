@@ -26,32 +26,37 @@ typedef struct {
 	xsSlot callback;
 	xsIntegerValue interval;
 	xsIntegerValue repeat;
-	guint g_timer;
+	GSource* g_timer;
 } ModTimerRecord, *ModTimer;
 
 static gboolean ModTimerCallback(gpointer data);
 static ModTimer ModTimerCreate(xsMachine* the);
 static void ModTimerDelete(void* it);
 static void ModTimerRemove(ModTimer self);
+static void ModTimerStart(ModTimer self);
 
 gboolean ModTimerCallback(gpointer data)
 {
 	ModTimer self = data;
+	GSource* g_timer = g_main_current_source();
 	xsBeginHost(self->the);
 	xsVars(2);
 	xsVar(0) = xsAccess(self->callback);
 	xsVar(1) = xsAccess(self->slot);
 	xsCallFunction1(xsVar(0), xsGlobal, xsVar(1));
 	xsEndHost(self->the);
+	if (g_source_is_destroyed(g_timer))	// cleared or scheduled again by the callback, self may be gone or own a new source
+		return G_SOURCE_REMOVE;
 	if (self->repeat) {
 		if (self->interval != self->repeat) {
 			self->interval = self->repeat;
-			self->g_timer = g_timeout_add(self->interval, ModTimerCallback, self);
+			ModTimerRemove(self);
+			ModTimerStart(self);
 			return G_SOURCE_REMOVE;
 		}
 		return G_SOURCE_CONTINUE;
 	}
-	self->g_timer = 0;
+	ModTimerRemove(self);
 	return G_SOURCE_REMOVE;
 }
 
@@ -78,27 +83,36 @@ void ModTimerDelete(void* it)
 
 void ModTimerRemove(ModTimer self)
 {
-	guint g_timer = self->g_timer;
+	GSource* g_timer = self->g_timer;
 	if (g_timer) {
-		g_source_remove(g_timer);
-		self->g_timer = 0;
+		g_source_destroy(g_timer);
+		g_source_unref(g_timer);
+		self->g_timer = NULL;
 	}
 }
 
+void ModTimerStart(ModTimer self)
+{
+	// thread default context, so that timers of workers fire on their own loop
+	self->g_timer = g_timeout_source_new(self->interval);
+	g_source_set_callback(self->g_timer, ModTimerCallback, self, NULL);
+	g_source_attach(self->g_timer, g_main_context_get_thread_default());
+}
+
 void xs_timer_set(xsMachine *the)
 {
 	int argc = xsToInteger(xsArgc);
 	ModTimer self = ModTimerCreate(the);
 	self->interval = (argc > 1) ? xsToInteger(xsArg(1)) : 0;
 	self->repeat = (argc > 2) ? xsToInteger(xsArg(2)) : 0;
-	self->g_timer = g_timeout_add(self->interval, ModTimerCallback, self);
+	ModTimerStart(self);
 }
 
 void xs_timer_repeat(xsMachine *the)
 {
 	ModTimer self = ModTimerCreate(the);
 	self->interval = self->repeat = xsToInteger(xsArg(1));
-	self->g_timer = g_timeout_add(self->interval, ModTimerCallback, self);
+	ModTimerStart(self);
 }
 
 void xs_timer_schedule(xsMachine *the)
@@ -108,7 +122,7 @@ void xs_timer_schedule(xsMachine *the)
 	ModTimerRemove(self);
 	self->interval = xsToInteger(xsArg(1));
 	self->repeat = (argc > 2) ? xsToInteger(xsArg(2)) : 0;
-	self->g_timer = g_timeout_add(self->interval, ModTimerCallback, self);
+	ModTimerStart(self);
 }
 
 void xs_timer_clear(xsMachine *the)
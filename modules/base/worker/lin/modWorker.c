@@ -0,0 +1,464 @@
+/*
+ * Copyright (c) 2016-2018  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK Runtime.
+ *
+ *   The Moddable SDK Runtime is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   The Moddable SDK Runtime is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with the Moddable SDK Runtime.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "xsAll.h"
+#include "xs.h"
+#include "mc.xs.h"			// for xsID_ values
+
+#include <glib-unix.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/eventfd.h>
+
+/*
+	Each worker runs its own machine on its own thread, with its own GMainContext.
+	Messages are marshalled and pushed onto a lock-free LIFO by any thread; the
+	receiving thread takes the whole list at once and reverses it. The eventfd
+	is only written when a message lands on an empty list.
+	ArrayBuffers in the transfer list move to the receiving machine without copy.
+*/
+
+typedef struct modWorkerMessageRecord modWorkerMessageRecord;
+typedef modWorkerMessageRecord *modWorkerMessage;
+
+struct modWorkerMessageRecord {
+	modWorkerMessage	next;
+	void				*data;		// marshalled, NULL to close
+};
+
+typedef struct {
+	modWorkerMessage	first;
+	GSource				*source;
+	int					fd;
+} modWorkerQueueRecord, *modWorkerQueue;
+
+struct modWorkerRecord {
+	xsMachine		*the;
+	xsMachine		*parent;
+	xsSlot			owner;
+	uint32_t		stackCount;
+	uint32_t		slotCount;
+	xsBooleanValue	closing;		// instantiator side
+	xsBooleanValue	closed;			// worker side
+	int				useCount;
+	pthread_t		thread;
+	sem_t			started;
+	GMainContext	*context;
+	GMainLoop		*loop;
+	modWorkerQueueRecord	toParent;
+	modWorkerQueueRecord	toWorker;
+	char			module[1];
+};
+
+typedef struct modWorkerRecord modWorkerRecord;
+typedef modWorkerRecord *modWorker;
+
+extern txPreparation* xsPreparation();
+
+static void xs_worker_postfromworker(xsMachine *the);
+static void xs_worker_close(xsMachine *the);
+
+static void workerDeliver(xsMachine *the, modWorker worker, void *data);
+static gboolean workerDeliverToParent(gint fd, GIOCondition condition, gpointer it);
+static gboolean workerDeliverToWorker(gint fd, GIOCondition condition, gpointer it);
+
+static void workerDetach(modWorker worker);
+static void *workerLoop(void *it);
+static void workerPost(xsMachine *the, modWorkerQueue queue);
+static int workerQueue(modWorkerQueue queue, void *data);
+static void workerQueueFree(modWorkerQueue queue);
+static modWorkerMessage workerQueueReceive(modWorkerQueue queue);
+static int workerQueueStart(modWorkerQueue queue, modWorker worker, GSourceFunc callback);
+static void workerRelease(modWorker worker);
+static int workerStart(modWorker worker);
+static void workerTerminate(xsMachine *the, modWorker worker);
+
+void xs_worker_destructor(void *data)
+{
+	modWorker worker = data;
+
+	if (worker)
+		workerDetach(worker);
+}
+
+void xs_worker(xsMachine *the)
+{
+	modWorker worker;
+	char *module = xsToString(xsArg(0));
+
+	xsVars(1);
+
+	worker = c_calloc(sizeof(modWorkerRecord) + c_strlen(module), 1);
+	if (!worker)
+		xsUnknownError("no memory");
+
+	worker->parent = the;
+	worker->owner = xsThis;
+	worker->useCount = 1;
+	worker->toParent.fd = -1;
+	worker->toWorker.fd = -1;
+	c_strcpy(worker->module, module);
+
+	if (xsToInteger(xsArgc) > 1) {
+		if (xsHas(xsArg(1), xsID("stackCount"))) {
+			xsVar(0) = xsGet(xsArg(1), xsID("stackCount"));
+			worker->stackCount = xsToInteger(xsVar(0));
+		}
+		if (xsHas(xsArg(1), xsID("slotCount"))) {
+			xsVar(0) = xsGet(xsArg(1), xsID("slotCount"));
+			worker->slotCount = xsToInteger(xsVar(0));
+		}
+	}
+
+	if (workerQueueStart(&worker->toParent, worker, G_SOURCE_FUNC(workerDeliverToParent))) {
+		workerQueueFree(&worker->toParent);
+		c_free(worker);
+		xsUnknownError("unable to instantiate worker");
+	}
+	g_source_attach(worker->toParent.source, g_main_context_get_thread_default());
+
+	sem_init(&worker->started, 0, 0);
+	worker->useCount = 2;
+	if (pthread_create(&worker->thread, NULL, workerLoop, worker)) {
+		worker->useCount = 1;
+		worker->the = NULL;
+	}
+	else {
+		pthread_detach(worker->thread);
+		sem_wait(&worker->started);
+	}
+	sem_destroy(&worker->started);
+
+	if (NULL == worker->the) {
+		workerDetach(worker);
+		xsUnknownError("unable to instantiate worker");
+	}
+
+	xsSetHostData(xsThis, worker);
+	xsRemember(worker->owner);
+}
+
+void xs_worker_terminate(xsMachine *the)
+{
+	modWorker worker = xsGetHostData(xsThis);
+
+	if (NULL == worker)
+		return;
+
+	workerTerminate(the, worker);
+}
+
+void xs_worker_postfrominstantiator(xsMachine *the)
+{
+	modWorker worker = xsGetHostData(xsThis);
+
+	if (NULL == worker)
+		xsUnknownError("worker terminated");
+
+	if (worker->closing)
+		xsUnknownError("worker closing");
+
+	workerPost(the, &worker->toWorker);
+}
+
+void xs_worker_postfromworker(xsMachine *the)
+{
+	modWorker worker = the->context;
+
+	if (worker->closed)
+		xsUnknownError("worker closing");
+
+	workerPost(the, &worker->toParent);
+}
+
+void xs_worker_close(xsMachine *the)
+{
+	modWorker worker = the->context;
+	worker->closed = 1;
+	workerQueue(&worker->toParent, NULL);
+	g_main_loop_quit(worker->loop);
+}
+
+void workerDeliver(xsMachine *the, modWorker worker, void *data)
+{
+	xsBeginHost(the);
+
+	xsVars(2);
+
+	xsVar(0) = xsDemarshallAlien(data);
+
+	if (the == worker->parent)
+		xsCall1(worker->owner, xsID_onmessage, xsVar(0));	// calling instantiator - through instance
+	else {
+		xsVar(1) = xsGet(xsGlobal, xsID_self);
+		xsCall1(xsVar(1), xsID_onmessage, xsVar(0));	// calling worker - through self
+	}
+
+	xsEndHost(the);
+}
+
+gboolean workerDeliverToParent(gint fd, GIOCondition condition, gpointer it)
+{
+	modWorker worker = it;
+	xsMachine *the = worker->parent;
+	modWorkerMessage message = workerQueueReceive(&worker->toParent);
+
+	__atomic_add_fetch(&worker->useCount, 1, __ATOMIC_RELAXED);
+	while (message) {
+		modWorkerMessage next = message->next;
+		if (!worker->closing) {
+			if (message->data)
+				workerDeliver(the, worker, message->data);
+			else
+				workerTerminate(the, worker);
+		}
+		xsFreeMarshall(message->data);
+		c_free(message);
+		message = next;
+	}
+	workerRelease(worker);
+	return G_SOURCE_CONTINUE;
+}
+
+gboolean workerDeliverToWorker(gint fd, GIOCondition condition, gpointer it)
+{
+	modWorker worker = it;
+	xsMachine *the = worker->the;
+	modWorkerMessage message = workerQueueReceive(&worker->toWorker);
+
+	while (message) {
+		modWorkerMessage next = message->next;
+		if (message->data) {
+			if (!worker->closed)
+				workerDeliver(the, worker, message->data);
+		}
+		else {
+			worker->closed = 1;
+			g_main_loop_quit(worker->loop);
+		}
+		xsFreeMarshall(message->data);
+		c_free(message);
+		message = next;
+	}
+	return G_SOURCE_CONTINUE;
+}
+
+void workerDetach(modWorker worker)
+{
+	workerQueue(&worker->toWorker, NULL);
+	if (worker->toParent.source) {
+		g_source_destroy(worker->toParent.source);
+		g_source_unref(worker->toParent.source);
+		worker->toParent.source = NULL;
+	}
+	workerRelease(worker);
+}
+
+void *workerLoop(void *it)
+{
+	modWorker worker = it;
+
+	worker->context = g_main_context_new();
+	g_main_context_push_thread_default(worker->context);
+	worker->loop = g_main_loop_new(worker->context, FALSE);
+
+	if (workerQueueStart(&worker->toWorker, worker, G_SOURCE_FUNC(workerDeliverToWorker)) || workerStart(worker)) {
+		sem_post(&worker->started);
+		goto bail;
+	}
+	g_source_attach(worker->toWorker.source, worker->context);
+	sem_post(&worker->started);
+
+	g_main_loop_run(worker->loop);
+
+	xsDeleteMachine(worker->the);
+bail:
+	if (worker->toWorker.source) {
+		g_source_destroy(worker->toWorker.source);
+		g_source_unref(worker->toWorker.source);
+		worker->toWorker.source = NULL;
+	}
+	g_main_loop_unref(worker->loop);
+	g_main_context_pop_thread_default(worker->context);
+	g_main_context_unref(worker->context);
+	workerRelease(worker);
+	return NULL;
+}
+
+void workerPost(xsMachine *the, modWorkerQueue queue)
+{
+	xsIntegerValue copied = 0;
+	void *data;
+
+	data = xsMarshallAlienTransfer(xsArg(0), (xsToInteger(xsArgc) > 1) ? xsArg(1) : xsUndefined, &copied);
+	if (workerQueue(queue, data))
+		xsUnknownError("no memory");
+	xsResult = xsInteger(copied);
+}
+
+int workerQueue(modWorkerQueue queue, void *data)
+{
+	modWorkerMessage message = c_malloc(sizeof(modWorkerMessageRecord)), first;
+	if (NULL == message) {
+		xsFreeMarshall(data);
+		return -1;
+	}
+	message->data = data;
+	first = __atomic_load_n(&queue->first, __ATOMIC_RELAXED);
+	do {
+		message->next = first;
+	} while (!__atomic_compare_exchange_n(&queue->first, &first, message, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+	if (NULL == first) {
+		uint64_t count = 1;
+		(void)write(queue->fd, &count, sizeof(count));
+	}
+	return 0;
+}
+
+void workerQueueFree(modWorkerQueue queue)
+{
+	modWorkerMessage message = __atomic_exchange_n(&queue->first, NULL, __ATOMIC_ACQUIRE);
+	while (message) {
+		modWorkerMessage next = message->next;
+		xsFreeMarshall(message->data);
+		c_free(message);
+		message = next;
+	}
+	if (queue->fd >= 0) {
+		close(queue->fd);
+		queue->fd = -1;
+	}
+}
+
+modWorkerMessage workerQueueReceive(modWorkerQueue queue)
+{
+	modWorkerMessage message, result = NULL;
+	uint64_t count;
+	(void)read(queue->fd, &count, sizeof(count));
+	message = __atomic_exchange_n(&queue->first, NULL, __ATOMIC_ACQUIRE);
+	while (message) {
+		modWorkerMessage next = message->next;
+		message->next = result;
+		result = message;
+		message = next;
+	}
+	return result;
+}
+
+int workerQueueStart(modWorkerQueue queue, modWorker worker, GSourceFunc callback)
+{
+	queue->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (queue->fd < 0)
+		return -1;
+	queue->source = g_unix_fd_source_new(queue->fd, G_IO_IN);
+	g_source_set_callback(queue->source, callback, worker, NULL);
+	g_source_set_priority(queue->source, G_PRIORITY_DEFAULT);
+	return 0;
+}
+
+void workerRelease(modWorker worker)
+{
+	if (__atomic_sub_fetch(&worker->useCount, 1, __ATOMIC_ACQ_REL))
+		return;
+	workerQueueFree(&worker->toParent);
+	workerQueueFree(&worker->toWorker);
+	c_free(worker);
+}
+
+int workerStart(modWorker worker)
+{
+	txPreparation* preparation = xsPreparation();
+	txMachine _root;
+	txMachine* root = &_root;
+	txCreation creation = preparation->creation;
+	xsMachine *the;
+	int result = 0;
+
+	root->preparation = preparation;
+	root->archive = ((txMachine*)worker->parent)->archive;
+	root->keyArray = preparation->keys;
+	root->keyCount = (txID)preparation->keyCount + (txID)preparation->creation.keyCount;
+	root->keyIndex = (txID)preparation->keyCount;
+	root->nameModulo = preparation->nameModulo;
+	root->nameTable = preparation->names;
+	root->symbolModulo = preparation->symbolModulo;
+	root->symbolTable = preparation->symbols;
+
+	root->stack = &preparation->stack[0];
+	root->stackBottom = &preparation->stack[0];
+	root->stackTop = &preparation->stack[preparation->stackCount];
+
+	root->firstHeap = &preparation->heap[0];
+	root->freeHeap = &preparation->heap[preparation->heapCount - 1];
+	root->aliasCount = (txID)preparation->aliasCount;
+
+	if (worker->stackCount)
+		creation.stackCount = worker->stackCount;
+	if (worker->slotCount)
+		creation.initialHeapCount = worker->slotCount;
+
+	the = fxCloneMachine(&creation, root, worker->module, worker);
+	if (!the)
+		return -1;
+	((txMachine*)the)->host = ((txMachine*)worker->parent)->host;
+
+	xsBeginHost(the);
+
+	xsVars(2);
+
+	xsTry {
+		xsVar(0) = xsNewObject();
+		xsSet(xsGlobal, xsID_self, xsVar(0));
+
+		xsVar(1) = xsNewHostFunction(xs_worker_postfromworker, 1);
+		xsSet(xsVar(0), xsID_postMessage, xsVar(1));
+
+		xsVar(1) = xsNewHostFunction(xs_worker_close, 0);
+		xsSet(xsVar(0), xsID("close"), xsVar(1));
+
+		xsVar(0) = xsGet(xsGlobal, xsID_require);
+		xsVar(0) = xsCall1(xsVar(0), xsID_weak, xsString(worker->module));
+		if (xsTest(xsVar(0)) && xsIsInstanceOf(xsVar(0), xsFunctionPrototype))
+			xsCallFunction0(xsVar(0), xsGlobal);
+	}
+	xsCatch {
+		result = -1;
+	}
+	xsEndHost(the);
+
+	if (result) {
+		xsDeleteMachine(the);
+		the = NULL;
+	}
+
+	worker->the = the;
+
+	return result;
+}
+
+void workerTerminate(xsMachine *the, modWorker worker)
+{
+	worker->closing = 1;
+
+	xsForget(worker->owner);
+	xsSetHostData(worker->owner, NULL);
+
+	workerDetach(worker);
+}
@@ -51,11 +51,11 @@ typedef modWorkerRecord *modWorker;
 static void xs_worker_postfromworker(xsMachine *the);
 static void xs_worker_close(xsMachine *the);
 
-static void workerDeliverArrayBuffer(xsMachine *the, modWorker worker, uint8_t *message, uint16_t messageLength);
-static void workerDeliverJSON(xsMachine *the, modWorker worker, uint8_t *message, uint16_t messageLength);
+static void workerDeliver(xsMachine *the, modWorker worker, uint8_t *message, uint32_t messageLength);
+static void workerPost(xsMachine *the, modWorker worker, xsMachine *target);
 
 static int workerStart(modWorker worker);
-static void workerTerminate(xsMachine *the, modWorker worker, uint8_t *message, uint16_t messageLength);
+static void workerTerminate(xsMachine *the, modWorker worker, uint8_t *message, uint32_t messageLength);
 
 void xs_worker_destructor(void *data)
 {
@@ -134,9 +134,6 @@ void xs_worker_terminate(xsMachine *the)
 void xs_worker_postfrominstantiator(xsMachine *the)
 {
 	modWorker worker = xsmcGetHostData(xsThis);
-	char *message;
-	uint32_t messageLength;
-	uint8_t kind;
 
 	if (NULL == worker->the)
 		xsUnknownError("worker terminated");
@@ -144,52 +141,17 @@ void xs_worker_postfrominstantiator(xsMachine *the)
 	if (worker->closing)
 		xsUnknownError("worker closing");
 
-	xsmcVars(2);
-
-	if (xsmcIsInstanceOf(xsArg(0), xsArrayBufferPrototype)) {
-		message = xsmcToArrayBuffer(xsArg(0));
-		messageLength = xsGetArrayBufferLength(xsArg(0));
-		kind = 1;
-	}
-	else {
-		xsmcGet(xsVar(0), xsGlobal, xsID_JSON);
-		xsVar(1) = xsCall1(xsVar(0), xsID_stringify, xsArg(0));
-		message = xsmcToString(xsVar(1));
-		messageLength = c_strlen(message) + 1;
-		kind = 0;
-	}
-
-	if (modMessagePostToMachine(worker->the, message, messageLength, (modMessageDeliver)(kind ? workerDeliverArrayBuffer : workerDeliverJSON), worker))
-		xsUnknownError("post from instantiator failed");
+	workerPost(the, worker, worker->the);
 }
 
 void xs_worker_postfromworker(xsMachine *the)
 {
 	modWorker worker = the->context;
-	char *message;
-	uint32_t messageLength;
-	uint8_t kind;
 
 	if (worker->closing)
 		xsUnknownError("worker closing");
 
-	xsmcVars(2);
-
-	if (xsmcIsInstanceOf(xsArg(0), xsArrayBufferPrototype)) {
-		message = xsmcToArrayBuffer(xsArg(0));
-		messageLength = xsGetArrayBufferLength(xsArg(0));
-		kind = 1;
-	}
-	else {
-		xsmcGet(xsVar(0), xsGlobal, xsID_JSON);
-		xsVar(1) = xsCall1(xsVar(0), xsID_stringify, xsArg(0));
-		message = xsmcToString(xsVar(1));
-		messageLength = c_strlen(message) + 1;
-		kind = 0;
-	}
-
-	if (modMessagePostToMachine(worker->parent, message, messageLength, (modMessageDeliver)(kind ? workerDeliverArrayBuffer : workerDeliverJSON), worker))
-		xsUnknownError("post from worker failed");
+	workerPost(the, worker, worker->parent);
 }
 
 void xs_worker_close(xsMachine *the)
@@ -198,16 +160,22 @@ void xs_worker_close(xsMachine *the)
 	modMessagePostToMachine(worker->parent, NULL, 0, (modMessageDeliver)workerTerminate, worker);
 }
 
-void workerDeliverArrayBuffer(xsMachine *the, modWorker worker, uint8_t *message, uint16_t messageLength)
+void workerDeliver(xsMachine *the, modWorker worker, uint8_t *message, uint32_t messageLength)
 {
-	if (worker->closing)
+	void *data;
+
+	c_memcpy(&data, message, sizeof(data));		// message may be unaligned
+	if (worker->closing) {
+		xsFreeMarshall(data);
 		return;
+	}
 
 	xsBeginHost(the);
 
 	xsmcVars(2);
 
-	xsVar(0) = xsArrayBuffer(message, messageLength);
+	xsVar(0) = xsDemarshallAlien(data);
+	xsFreeMarshall(data);
 
 	if (the == worker->parent)
 		xsCall1(worker->owner, xsID_onmessage, xsVar(0));	// calling instantiator - through instance
@@ -219,27 +187,19 @@ void workerDeliverArrayBuffer(xsMachine *the, modWorker worker, uint8_t *message
 	xsEndHost(the);
 }
 
-void workerDeliverJSON(xsMachine *the, modWorker worker, uint8_t *message, uint16_t messageLength)
+void workerPost(xsMachine *the, modWorker worker, xsMachine *target)
 {
-	if (worker->closing)
-		return;
+	xsIntegerValue copied = 0;
+	void *data;
 
-	xsBeginHost(the);
+	data = xsMarshallAlienTransfer(xsArg(0), (xsmcArgc > 1) ? xsArg(1) : xsUndefined, &copied);
 
-	xsmcVars(3);
-
-	xsVar(0) = xsString(message);
-	xsmcGet(xsVar(1), xsGlobal, xsID_JSON);
-	xsVar(2) = xsCall1(xsVar(1), xsID_parse, xsVar(0));
-
-	if (the == worker->parent)
-		xsCall1(worker->owner, xsID_onmessage, xsVar(2));	// calling instantiator - through instance
-	else {
-		xsmcGet(xsVar(0), xsGlobal, xsID_self);
-		xsCall1(xsVar(0), xsID_onmessage, xsVar(2));		// calling worker - through self
+	if (modMessagePostMarshallToMachine(target, data, (modMessageDeliver)workerDeliver, worker)) {
+		xsFreeMarshall(data);
+		xsUnknownError("post failed");
 	}
 
-	xsEndHost(the);
+	xsmcSetInteger(xsResult, copied);
 }
 
 int workerStart(modWorker worker)
@@ -287,7 +247,7 @@ int workerStart(modWorker worker)
 	return result;
 }
 
-void workerTerminate(xsMachine *the, modWorker worker, uint8_t *message, uint16_t messageLength)
+void workerTerminate(xsMachine *the, modWorker worker, uint8_t *message, uint32_t messageLength)
 {
 	worker->closing = true;
 
@@ -25,7 +25,7 @@
 
 class Worker @ "xs_worker_destructor" {
 	constructor(module) @ "xs_worker";
-	postMessage(message) @ "xs_worker_postfrominstantiator";
+	postMessage(message, transfer) @ "xs_worker_postfrominstantiator";
 	terminate() @ "xs_worker_terminate";
 };
 
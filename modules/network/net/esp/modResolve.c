@@ -35,7 +35,7 @@ typedef struct {
 } xsNetResolveRecord, *xsNetResolve;
 
 static void didResolve(const char *name, ip_addr_t *ipaddr, void *arg);
-static void resolvedImmediate(void *the, void *refcon, uint8_t *message, uint16_t messageLength);
+static void resolvedImmediate(void *the, void *refcon, uint8_t *message, uint32_t messageLength);
 
 void xs_net_resolve(xsMachine *the)
 {
@@ -78,7 +78,7 @@ void didResolve(const char *name, ip_addr_t *ipaddr, void *arg)
 	modMessagePostToMachine(nr->the, NULL, 0, resolvedImmediate, nr);
 }
 
-void resolvedImmediate(void *the, void *refcon, uint8_t *message, uint16_t messageLength)
+void resolvedImmediate(void *the, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	xsNetResolve nr = refcon;
 
@@ -0,0 +1,945 @@
+/*
+ * Copyright (c) 2016-2017  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK Runtime.
+ *
+ *   The Moddable SDK Runtime is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   The Moddable SDK Runtime is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with the Moddable SDK Runtime.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "xsPlatform.h"
+#include "xsmc.h"
+#include "modInstrumentation.h"
+
+#include "mc.xs.h"			// for xsID_ values
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#include "../socket/modSocket.h"
+
+/*
+	All sockets and listeners of a thread share one epoll instance. The epoll
+	descriptor is the only descriptor polled by the GLib main loop, so the cost
+	of a main loop iteration does not grow with the number of connections.
+*/
+
+#define kTCP (0)
+#define kUDP (1)
+#define kTCPListener (2)
+
+#define kEventCount (64)
+#define kReadBufferSize (8192)
+#define kWriteBufferSize (8192)
+
+typedef struct xsSocketRecord xsSocketRecord;
+typedef xsSocketRecord *xsSocket;
+
+struct xsSocketRecord {
+	xsMachine					*the;
+	xsSlot						obj;
+
+	int							skt;
+	uint32_t					events;		// epoll events watched, 0 when not registered
+
+	int8_t						useCount;
+	uint8_t						done;
+	uint8_t						kind;		// kTCP, kUDP or kTCPListener
+
+	// above here same as xsListenerRecord
+
+	uint8_t						connecting;
+	int							port;
+	GCancellable				*cancellable;		// pending host name resolution
+
+	uint8_t						*readBuffer;
+	int32_t						readBytes;
+
+	int32_t						writeBytes;
+	int32_t						unreportedSent;		// bytes sent to the socket but not yet reported to object as sent
+
+	uint8_t						writeBuf[kWriteBufferSize];
+};
+
+typedef struct xsListenerRecord xsListenerRecord;
+typedef xsListenerRecord *xsListener;
+
+struct xsListenerRecord {
+	xsMachine					*the;
+	xsSlot						obj;
+
+	int							skt;
+	uint32_t					events;
+
+	int8_t						useCount;
+	uint8_t						done;
+	uint8_t						kind;
+
+	// above here same as xsSocketRecord
+
+	xsSocket					pending;
+};
+
+typedef struct {
+	GSource						source;
+	gpointer					tag;
+	int							epfd;
+	int							count;		// registered sockets and listeners
+	struct epoll_event			*events;	// batch being dispatched
+	int							eventCount;
+	int							eventIndex;
+} xsSocketSourceRecord, *xsSocketSource;
+
+static gboolean socketSourcePrepare(GSource *source, gint *timeout);
+static gboolean socketSourceCheck(GSource *source);
+static gboolean socketSourceDispatch(GSource *source, GSourceFunc callback, gpointer data);
+static void socketSourceFinalize(GSource *source);
+
+static GSourceFuncs gSocketSourceFuncs = {
+	socketSourcePrepare,
+	socketSourceCheck,
+	socketSourceDispatch,
+	socketSourceFinalize
+};
+
+static GPrivate gSocketSource = G_PRIVATE_INIT(NULL);
+
+static int socketWatch(xsSocket xss, uint32_t events);
+static void socketUnwatch(xsSocket xss);
+static void socketEvents(xsSocket xss, uint32_t events);
+static void listenerEvents(xsListener xsl, uint32_t events);
+
+static void socketMsg(xsSocket xss, int message);
+static void socketDisconnect(xsSocket xss);
+static int doConnect(xsSocket xss, struct in_addr *address);
+static int doFlushWrite(xsSocket xss);
+static void doRead(xsSocket xss);
+static void doReadUDP(xsSocket xss);
+static void resolved(GObject *source, GAsyncResult *result, gpointer data);
+
+#define socketUpUseCount(the, xss) (xss->useCount += 1)
+
+static void socketDownUseCount(xsMachine *the, xsSocket xss)
+{
+	xss->useCount -= 1;
+	if (xss->useCount <= 0) {
+		xsDestructor destructor = xsGetHostDestructor(xss->obj);
+		xsmcSetHostData(xss->obj, NULL);
+		xsForget(xss->obj);
+		(*destructor)(xss);
+	}
+}
+
+gboolean socketSourcePrepare(GSource *source, gint *timeout)
+{
+	*timeout = -1;
+	return FALSE;
+}
+
+gboolean socketSourceCheck(GSource *source)
+{
+	xsSocketSource xsss = (xsSocketSource)source;
+	return (g_source_query_unix_fd(source, xsss->tag) & G_IO_IN) ? TRUE : FALSE;
+}
+
+gboolean socketSourceDispatch(GSource *source, GSourceFunc callback, gpointer data)
+{
+	xsSocketSource xsss = (xsSocketSource)source;
+	struct epoll_event events[kEventCount];
+	int count;
+
+	count = epoll_wait(xsss->epfd, events, kEventCount, 0);
+	if (count <= 0)
+		return G_SOURCE_CONTINUE;
+
+	// a callback may close the last socket, which destroys the source
+	g_source_ref(source);
+	xsss->events = events;
+	xsss->eventCount = count;
+	for (xsss->eventIndex = 0; xsss->eventIndex < xsss->eventCount; xsss->eventIndex++) {
+		xsSocket xss = events[xsss->eventIndex].data.ptr;
+		if (!xss)
+			continue;		// unregistered by an earlier callback of this batch
+		if (kTCPListener == xss->kind)
+			listenerEvents((xsListener)xss, events[xsss->eventIndex].events);
+		else
+			socketEvents(xss, events[xsss->eventIndex].events);
+	}
+	xsss->events = NULL;
+	xsss->eventCount = 0;
+	g_source_unref(source);
+
+	return G_SOURCE_CONTINUE;
+}
+
+void socketSourceFinalize(GSource *source)
+{
+	xsSocketSource xsss = (xsSocketSource)source;
+	if (xsss->epfd >= 0)
+		close(xsss->epfd);
+}
+
+int socketWatch(xsSocket xss, uint32_t events)
+{
+	xsSocketSource xsss = g_private_get(&gSocketSource);
+	struct epoll_event event;
+
+	if (xss->skt < 0)
+		return -1;
+	if (xss->events == events)
+		return 0;
+
+	if (!xsss) {
+		int epfd = epoll_create1(EPOLL_CLOEXEC);
+		if (epfd < 0)
+			return -1;
+		xsss = (xsSocketSource)g_source_new(&gSocketSourceFuncs, sizeof(xsSocketSourceRecord));
+		xsss->epfd = epfd;
+		xsss->count = 0;
+		xsss->events = NULL;
+		xsss->eventCount = 0;
+		xsss->tag = g_source_add_unix_fd(&xsss->source, epfd, G_IO_IN);
+		g_source_set_priority(&xsss->source, G_PRIORITY_DEFAULT);
+		g_source_attach(&xsss->source, g_main_context_get_thread_default());
+		g_private_set(&gSocketSource, xsss);
+	}
+
+	event.events = events;
+	event.data.ptr = xss;
+	if (epoll_ctl(xsss->epfd, xss->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, xss->skt, &event) < 0)
+		return -1;
+
+	if (!xss->events)
+		xsss->count += 1;
+	xss->events = events;
+
+	return 0;
+}
+
+void socketUnwatch(xsSocket xss)
+{
+	xsSocketSource xsss = g_private_get(&gSocketSource);
+	int i;
+
+	if (!xss->events || !xsss)
+		return;
+
+	epoll_ctl(xsss->epfd, EPOLL_CTL_DEL, xss->skt, NULL);
+	xss->events = 0;
+
+	for (i = xsss->eventIndex + 1; i < xsss->eventCount; i++) {
+		if (xsss->events[i].data.ptr == xss)
+			xsss->events[i].data.ptr = NULL;
+	}
+
+	xsss->count -= 1;
+	if (0 == xsss->count) {
+		g_private_set(&gSocketSource, NULL);
+		g_source_destroy(&xsss->source);
+		g_source_unref(&xsss->source);
+	}
+}
+
+void xs_socket(xsMachine *the)
+{
+	xsSocket xss;
+	struct in_addr address;
+	char temp[256];
+	int set;
+
+	xsmcVars(1);
+	if (xsmcHas(xsArg(0), xsID_listener)) {
+		xsListener xsl;
+		xsmcGet(xsVar(0), xsArg(0), xsID_listener);
+		xsl = xsmcGetHostData(xsVar(0));
+		if ((NULL == xsl) || (NULL == xsl->pending))
+			xsUnknownError("no socket avaiable from listener");
+		xss = xsl->pending;
+		xsl->pending = NULL;
+
+		xss->obj = xsThis;
+		xsmcSetHostData(xsThis, xss);
+		xsRemember(xss->obj);
+
+		if (socketWatch(xss, EPOLLIN))
+			xsUnknownError("epoll failed");
+
+		return;
+	}
+
+	xss = c_calloc(sizeof(xsSocketRecord), 1);
+	if (!xss)
+		xsUnknownError("no memory");
+
+	xss->skt = -1;
+	xss->obj = xsThis;
+	xss->the = the;
+	xss->useCount = 1;
+	xsmcSetHostData(xsThis, xss);
+	xsRemember(xss->obj);
+
+	xss->kind = kTCP;
+	if (xsmcHas(xsArg(0), xsID_kind)) {
+		char *kind;
+
+		xsmcGet(xsVar(0), xsArg(0), xsID_kind);
+		kind = xsmcToString(xsVar(0));
+		if (0 == c_strcmp(kind, "TCP"))
+			;
+		else if (0 == c_strcmp(kind, "UDP"))
+			xss->kind = kUDP;
+		else
+			xsUnknownError("invalid socket kind");
+	}
+
+	if (xsmcHas(xsArg(0), xsID_port)) {
+		xsmcGet(xsVar(0), xsArg(0), xsID_port);
+		xss->port = xsmcToInteger(xsVar(0));
+	}
+	else if (kTCP == xss->kind)
+		xsUnknownError("port required in dictionary");
+
+	xss->skt = socket(AF_INET, ((kTCP == xss->kind) ? SOCK_STREAM : SOCK_DGRAM) | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (xss->skt < 0)
+		xsUnknownError("create socket failed");
+
+	modInstrumentationAdjust(NetworkSockets, 1);
+
+	if (kUDP == xss->kind) {
+		struct sockaddr_in addr;
+
+		c_memset(&addr, 0, sizeof(addr));
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(xss->port);
+		addr.sin_addr.s_addr = INADDR_ANY;
+		if (bind(xss->skt, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+			xsUnknownError("socket bind failed");
+
+		if (socketWatch(xss, EPOLLIN))
+			xsUnknownError("epoll failed");
+		return;
+	}
+
+	set = 1;
+	setsockopt(xss->skt, IPPROTO_TCP, TCP_NODELAY, (void *)&set, sizeof(set));
+
+	if (xsmcHas(xsArg(0), xsID_address)) {
+		xsmcGet(xsVar(0), xsArg(0), xsID_address);
+		xsmcToStringBuffer(xsVar(0), temp, sizeof(temp));
+		if (1 != inet_pton(AF_INET, temp, &address))
+			xsUnknownError("invalid IP address");
+	}
+	else if (xsmcHas(xsArg(0), xsID_host)) {
+		xsmcGet(xsVar(0), xsArg(0), xsID_host);
+		xsmcToStringBuffer(xsVar(0), temp, sizeof(temp));
+		if (1 != inet_pton(AF_INET, temp, &address)) {
+			GResolver *resolver = g_resolver_get_default();
+			xss->cancellable = g_cancellable_new();
+			g_resolver_lookup_by_name_async(resolver, temp, xss->cancellable, resolved, xss);
+			g_object_unref(resolver);
+			return;
+		}
+	}
+	else
+		xsUnknownError("host required in dictionary");
+
+	if (doConnect(xss, &address))
+		xsUnknownError("socket connect failed");
+}
+
+void resolved(GObject *source, GAsyncResult *result, gpointer data)
+{
+	GError *error = NULL;
+	GList *addresses = g_resolver_lookup_by_name_finish(G_RESOLVER(source), result, &error);
+	GList *walker;
+	struct in_addr addr;
+	gboolean found = FALSE;
+	xsSocket xss;
+
+	if (error) {
+		gboolean cancelled = g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+		g_error_free(error);
+		if (cancelled)
+			return;		// the socket record is gone
+	}
+
+	xss = data;
+	g_clear_object(&xss->cancellable);
+
+	for (walker = addresses; walker; walker = walker->next) {
+		GInetAddress *address = walker->data;
+		if (G_SOCKET_FAMILY_IPV4 == g_inet_address_get_family(address)) {
+			c_memcpy(&addr, g_inet_address_to_bytes(address), sizeof(addr));
+			found = TRUE;
+			break;
+		}
+	}
+	if (addresses)
+		g_resolver_free_addresses(addresses);
+
+	if (found && !doConnect(xss, &addr))
+		return;
+
+	socketUpUseCount(xss->the, xss);
+	socketMsg(xss, kSocketMsgError);
+	socketDisconnect(xss);
+	socketDownUseCount(xss->the, xss);
+}
+
+int doConnect(xsSocket xss, struct in_addr *address)
+{
+	struct sockaddr_in addr;
+
+	c_memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(xss->port);
+	addr.sin_addr = *address;
+
+	if ((connect(xss->skt, (struct sockaddr *)&addr, sizeof(addr)) < 0) && (EINPROGRESS != errno))
+		return -1;
+
+	// completion, successful or not, is reported by epoll as writable
+	xss->connecting = 1;
+	return socketWatch(xss, EPOLLOUT);
+}
+
+void socketDisconnect(xsSocket xss)
+{
+	if (xss->skt < 0)
+		return;
+
+	socketUnwatch(xss);
+	close(xss->skt);
+	xss->skt = -1;
+	xss->connecting = 0;
+	xss->writeBytes = 0;
+	xss->unreportedSent = 0;
+
+	modInstrumentationAdjust(NetworkSockets, -1);
+}
+
+void xs_socket_destructor(void *data)
+{
+	xsSocket xss = data;
+
+	if (xss) {
+		if (xss->cancellable) {
+			g_cancellable_cancel(xss->cancellable);
+			g_clear_object(&xss->cancellable);
+		}
+		socketDisconnect(xss);
+		c_free(xss);
+	}
+}
+
+void xs_socket_close(xsMachine *the)
+{
+	xsSocket xss = xsmcGetHostData(xsThis);
+
+	if ((NULL == xss) || xss->done)
+		xsUnknownError("close on closed socket");
+
+	xss->done = 1;
+	socketDownUseCount(the, xss);
+}
+
+void xs_socket_read(xsMachine *the)
+{
+	xsSocket xss = xsmcGetHostData(xsThis);
+	xsType dstType;
+	int argc = xsmcArgc;
+	uint16_t srcBytes;
+	unsigned char *srcData;
+
+	if ((NULL == xss) || xss->done)
+		xsUnknownError("read on closed socket");
+
+	if (!xss->readBuffer || !xss->readBytes) {
+		if (0 == argc)
+			xsResult = xsInteger(0);
+		return;
+	}
+
+	srcData = xss->readBuffer;
+	srcBytes = xss->readBytes;
+
+	if (0 == argc) {
+		xsResult = xsInteger(srcBytes);
+		return;
+	}
+
+	// address limiter argument (count or terminator)
+	if (argc > 1) {
+		xsType limiterType = xsmcTypeOf(xsArg(1));
+		if ((xsNumberType == limiterType) || (xsIntegerType == limiterType)) {
+			uint16_t count = xsmcToInteger(xsArg(1));
+			if (count < srcBytes)
+				srcBytes = count;
+		}
+		else
+		if (xsStringType == limiterType) {
+			char *str = xsmcToString(xsArg(1));
+			char terminator = c_read8(str);
+			if (terminator) {
+				unsigned char *t = (unsigned char *)c_strchr((char *)srcData, terminator);
+				if (t) {
+					uint16_t count = (t - srcData) + 1;		// terminator included in result
+					if (count < srcBytes)
+						srcBytes = count;
+				}
+			}
+		}
+		else if (xsUndefinedType == limiterType)
+			;
+	}
+
+	// generate output
+	dstType = xsmcTypeOf(xsArg(0));
+
+	if (xsNullType == dstType)
+		xsResult = xsInteger(srcBytes);
+	else if (xsReferenceType == dstType) {
+		xsSlot *s1, *s2;
+
+		s1 = &xsArg(0);
+
+		xsmcVars(1);
+		xsmcGet(xsVar(0), xsGlobal, xsID_String);
+		s2 = &xsVar(0);
+		if (s1->data[2] == s2->data[2])		//@@
+			xsResult = xsStringBuffer((char *)srcData, srcBytes);
+		else {
+			xsmcGet(xsVar(0), xsGlobal, xsID_Number);
+			s2 = &xsVar(0);
+			if (s1->data[2] == s2->data[2]) {		//@@
+				xsResult = xsInteger(*srcData);
+				srcBytes = 1;
+			}
+			else {
+				xsmcGet(xsVar(0), xsGlobal, xsID_ArrayBuffer);
+				s2 = &xsVar(0);
+				if (s1->data[2] == s2->data[2])		//@@
+					xsResult = xsArrayBuffer(srcData, srcBytes);
+				else
+					xsUnknownError("unsupported output type");
+			}
+		}
+	}
+
+	xss->readBuffer += srcBytes;
+	xss->readBytes -= srcBytes;
+}
+
+void xs_socket_write(xsMachine *the)
+{
+	xsSocket xss = xsmcGetHostData(xsThis);
+	int argc = xsmcArgc;
+	uint8_t *dst;
+	int available, needed = 0;
+	unsigned char pass, arg;
+
+	if ((NULL == xss) || xss->done || (xss->skt < 0)) {
+		if (0 == argc) {
+			xsResult = xsInteger(0);
+			return;
+		}
+		xsUnknownError("write on closed socket");
+	}
+
+	if (kUDP == xss->kind) {
+		char temp[64];
+		struct sockaddr_in dest_addr;
+		int len, result;
+		uint8_t *buf;
+
+		xsmcToStringBuffer(xsArg(0), temp, sizeof(temp));
+
+		len = xsGetArrayBufferLength(xsArg(2));
+		buf = xsmcToArrayBuffer(xsArg(2));
+
+		c_memset(&dest_addr, 0, sizeof(dest_addr));
+		dest_addr.sin_family = AF_INET;
+		dest_addr.sin_port = htons(xsmcToInteger(xsArg(1)));
+		if (1 != inet_pton(AF_INET, temp, &dest_addr.sin_addr))
+			xsUnknownError("invalid IP address");
+
+		result = sendto(xss->skt, buf, len, 0, (const struct sockaddr *)&dest_addr, sizeof(dest_addr));
+		if (result < 0)
+			xsUnknownError("sendto failed");
+
+		modInstrumentationAdjust(NetworkBytesWritten, result);
+		return;
+	}
+
+	available = sizeof(xss->writeBuf) - xss->writeBytes;
+	if (0 == argc) {
+		xsResult = xsInteger(available);
+		return;
+	}
+
+	dst = xss->writeBuf + xss->writeBytes;
+	for (pass = 0; pass < 2; pass++ ) {
+		for (arg = 0; arg < argc; arg++) {
+			xsType t = xsmcTypeOf(xsArg(arg));
+
+			if (xsStringType == t) {
+				char *msg = xsmcToString(xsArg(arg));
+				int msgLen = c_strlen(msg);
+				if (0 == pass)
+					needed += msgLen;
+				else {
+					c_memcpy(dst, msg, msgLen);
+					dst += msgLen;
+				}
+			}
+			else if ((xsNumberType == t) || (xsIntegerType == t)) {
+				if (0 == pass)
+					needed += 1;
+				else
+					*dst++ = (unsigned char)xsmcToInteger(xsArg(arg));
+			}
+			else if (xsReferenceType == t) {
+				if (xsmcIsInstanceOf(xsArg(arg), xsArrayBufferPrototype)) {
+					int msgLen = xsGetArrayBufferLength(xsArg(arg));
+					if (0 == pass)
+						needed += msgLen;
+					else {
+						char *msg = xsmcToArrayBuffer(xsArg(arg));
+						c_memcpy(dst, msg, msgLen);
+						dst += msgLen;
+					}
+				}
+				else if (xsmcIsInstanceOf(xsArg(arg), xsTypedArrayPrototype)) {
+					int msgLen, byteOffset;
+
+					xsmcGet(xsResult, xsArg(arg), xsID_byteLength);
+					msgLen = xsmcToInteger(xsResult);
+					if (0 == pass)
+						needed += msgLen;
+					else {
+						xsSlot tmp;
+						char *msg;
+
+						xsmcGet(tmp, xsArg(arg), xsID_byteOffset);
+						byteOffset = xsmcToInteger(tmp);
+
+						xsmcGet(tmp, xsArg(arg), xsID_buffer);
+						msg = byteOffset + xsmcToArrayBuffer(tmp);
+						c_memcpy(dst, msg, msgLen);
+						dst += msgLen;
+					}
+				}
+			}
+			else
+				xsUnknownError("unsupported type for write");
+		}
+
+		if ((0 == pass) && (needed > available))
+			xsUnknownError("can't write all data");
+	}
+
+	xss->writeBytes = dst - xss->writeBuf;
+
+	if (doFlushWrite(xss))
+		xsUnknownError("write failed");
+}
+
+int doFlushWrite(xsSocket xss)
+{
+	int ret;
+
+	if (xss->connecting || !xss->writeBytes)
+		return 0;
+
+	ret = send(xss->skt, xss->writeBuf, xss->writeBytes, MSG_NOSIGNAL);
+	if (ret < 0) {
+		if ((EAGAIN != errno) && (EWOULDBLOCK != errno))
+			return -1;
+		ret = 0;
+	}
+
+	modInstrumentationAdjust(NetworkBytesWritten, ret);
+
+	if (ret > 0) {
+		if (ret < xss->writeBytes)
+			c_memmove(xss->writeBuf, xss->writeBuf + ret, xss->writeBytes - ret);
+		xss->writeBytes -= ret;
+		xss->unreportedSent += ret;
+	}
+
+	// writable event flushes the rest and reports what was sent
+	return socketWatch(xss, EPOLLIN | EPOLLOUT);
+}
+
+void socketMsg(xsSocket xss, int message)
+{
+	xsMachine *the = xss->the;
+
+	xsBeginHost(the);
+		xsCall1(xss->obj, xsID_callback, xsInteger(message));
+	xsEndHost(the);
+}
+
+void doRead(xsSocket xss)
+{
+	xsMachine *the = xss->the;
+	unsigned char buffer[kReadBufferSize + 1];
+	int count = recv(xss->skt, buffer, kReadBufferSize, 0);
+
+	if (count < 0) {
+		if ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno))
+			return;
+		socketMsg(xss, kSocketMsgError);
+		socketDisconnect(xss);
+		return;
+	}
+
+	if (0 == count) {
+		socketMsg(xss, kSocketMsgDisconnect);
+		socketDisconnect(xss);
+		return;
+	}
+
+	modInstrumentationAdjust(NetworkBytesRead, count);
+
+	buffer[count] = 0;		// for terminator search in read
+	xss->readBuffer = buffer;
+	xss->readBytes = count;
+
+	xsBeginHost(the);
+		xsCall2(xss->obj, xsID_callback, xsInteger(kSocketMsgDataReceived), xsInteger(count));
+	xsEndHost(the);
+
+	xss->readBuffer = NULL;
+	xss->readBytes = 0;
+}
+
+void doReadUDP(xsSocket xss)
+{
+	xsMachine *the = xss->the;
+	unsigned char buffer[kReadBufferSize + 1];
+	struct sockaddr_in addr;
+	socklen_t addrLength = sizeof(addr);
+	char temp[INET_ADDRSTRLEN];
+	int count = recvfrom(xss->skt, buffer, kReadBufferSize, 0, (struct sockaddr *)&addr, &addrLength);
+
+	if (count < 0)
+		return;
+
+	modInstrumentationAdjust(NetworkBytesRead, count);
+
+	buffer[count] = 0;
+	xss->readBuffer = buffer;
+	xss->readBytes = count;
+
+	inet_ntop(AF_INET, &addr.sin_addr, temp, sizeof(temp));
+
+	xsBeginHost(the);
+		xsCall4(xss->obj, xsID_callback, xsInteger(kSocketMsgDataReceived), xsInteger(count), xsString(temp), xsInteger(ntohs(addr.sin_port)));
+	xsEndHost(the);
+
+	xss->readBuffer = NULL;
+	xss->readBytes = 0;
+}
+
+void socketEvents(xsSocket xss, uint32_t events)
+{
+	xsMachine *the = xss->the;
+
+	socketUpUseCount(the, xss);
+
+	if (xss->connecting) {
+		int error = 0;
+		socklen_t length = sizeof(error);
+
+		xss->connecting = 0;
+		if (getsockopt(xss->skt, SOL_SOCKET, SO_ERROR, &error, &length) < 0)
+			error = errno;
+		if (error || socketWatch(xss, EPOLLIN | (xss->writeBytes ? EPOLLOUT : 0))) {
+			socketMsg(xss, kSocketMsgError);
+			socketDisconnect(xss);
+		}
+		else {
+			socketMsg(xss, kSocketMsgConnect);
+			if (!xss->done && doFlushWrite(xss)) {
+				socketMsg(xss, kSocketMsgError);
+				socketDisconnect(xss);
+			}
+		}
+		goto done;
+	}
+
+	if (events & EPOLLIN) {
+		if (kUDP == xss->kind)
+			doReadUDP(xss);
+		else
+			doRead(xss);
+	}
+	else if (events & (EPOLLERR | EPOLLHUP)) {
+		socketMsg(xss, kSocketMsgError);
+		socketDisconnect(xss);
+	}
+
+	if (xss->done || (xss->skt < 0) || !(events & EPOLLOUT))
+		goto done;
+
+	if (xss->writeBytes) {
+		if (doFlushWrite(xss)) {
+			socketMsg(xss, kSocketMsgError);
+			socketDisconnect(xss);
+			goto done;
+		}
+	}
+
+	if (!xss->writeBytes) {
+		if (xss->unreportedSent) {
+			xss->unreportedSent = 0;
+			xsBeginHost(the);
+				xsCall2(xss->obj, xsID_callback, xsInteger(kSocketMsgDataSent), xsInteger(sizeof(xss->writeBuf)));
+			xsEndHost(the);
+		}
+		if (!xss->done && !xss->writeBytes && !xss->unreportedSent)
+			socketWatch(xss, EPOLLIN);
+	}
+
+done:
+	socketDownUseCount(the, xss);
+}
+
+void listenerEvents(xsListener xsl, uint32_t events)
+{
+	xsMachine *the = xsl->the;
+
+	socketUpUseCount(the, xsl);
+
+	while (!xsl->done) {
+		xsSocket xss;
+		int set = 1;
+		int skt = accept(xsl->skt, NULL, NULL);
+		if (skt < 0)
+			break;		// EAGAIN when the backlog is drained
+
+		fcntl(skt, F_SETFL, O_NONBLOCK | fcntl(skt, F_GETFL, 0));
+		fcntl(skt, F_SETFD, FD_CLOEXEC);
+
+		xss = c_calloc(sizeof(xsSocketRecord), 1);
+		if (!xss) {
+			close(skt);
+			break;
+		}
+
+		setsockopt(skt, IPPROTO_TCP, TCP_NODELAY, (void *)&set, sizeof(set));
+
+		xss->the = the;
+		xss->skt = skt;
+		xss->useCount = 1;
+		xss->kind = kTCP;
+
+		modInstrumentationAdjust(NetworkSockets, 1);
+
+		xsl->pending = xss;
+
+		xsBeginHost(the);
+			xsCall1(xsl->obj, xsID_callback, xsInteger(kListenerMsgConnect));
+		xsEndHost(the);
+
+		if (xsl->pending) {		// not accepted by new Socket({listener})
+			xs_socket_destructor(xsl->pending);
+			xsl->pending = NULL;
+		}
+	}
+
+	socketDownUseCount(the, (xsSocket)xsl);
+}
+
+// to accept an incoming connection: let incoming = new Socket({listener});
+void xs_listener(xsMachine *the)
+{
+	xsListener xsl;
+	struct sockaddr_in address;
+	uint16_t port = 0;
+	int yes = 1;
+
+	if (xsmcHas(xsArg(0), xsID_port)) {
+		xsmcVars(1);
+		xsmcGet(xsVar(0), xsArg(0), xsID_port);
+		port = (uint16_t)xsmcToInteger(xsVar(0));
+	}
+
+	xsl = c_calloc(sizeof(xsListenerRecord), 1);
+	if (!xsl)
+		xsUnknownError("out of memory");
+
+	xsl->the = the;
+	xsl->obj = xsThis;
+	xsl->useCount = 1;
+	xsl->kind = kTCPListener;
+	xsmcSetHostData(xsThis, xsl);
+	xsRemember(xsl->obj);
+
+	xsl->skt = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (xsl->skt < 0)
+		xsUnknownError("can't create socket");
+
+	modInstrumentationAdjust(NetworkSockets, 1);
+
+	setsockopt(xsl->skt, SOL_SOCKET, SO_REUSEADDR, (void *)&yes, sizeof(yes));
+
+	c_memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = INADDR_ANY;
+	if (bind(xsl->skt, (struct sockaddr *)&address, sizeof(address)) < 0)
+		xsUnknownError("bind failed");
+
+	if (listen(xsl->skt, SOMAXCONN) < 0)
+		xsUnknownError("listen failed");
+
+	if (socketWatch((xsSocket)xsl, EPOLLIN))
+		xsUnknownError("epoll failed");
+}
+
+void xs_listener_destructor(void *data)
+{
+	xsListener xsl = data;
+
+	if (xsl) {
+		if (xsl->skt >= 0) {
+			socketUnwatch((xsSocket)xsl);
+			close(xsl->skt);
+			xsl->skt = -1;
+
+			modInstrumentationAdjust(NetworkSockets, -1);
+		}
+		if (xsl->pending)
+			xs_socket_destructor(xsl->pending);
+		c_free(xsl);
+	}
+}
+
+void xs_listener_close(xsMachine *the)
+{
+	xsListener xsl = xsmcGetHostData(xsThis);
+
+	if ((NULL == xsl) || xsl->done)
+		xsUnknownError("close on closed listener");
+
+	xsl->done = 1;
+	socketDownUseCount(the, (xsSocket)xsl);
+}
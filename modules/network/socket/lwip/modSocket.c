@@ -121,7 +121,7 @@ static xsSocket gSockets;		// N.B. this list contains both sockets and listeners
 void xs_socket_destructor(void *data);
 
 static void socketSetPending(xsSocket xss, uint8_t pending);
-static void socketClearPending(void *the, void *refcon, uint8_t *message, uint16_t messageLength);
+static void socketClearPending(void *the, void *refcon, uint8_t *message, uint32_t messageLength);
 static void socketsClearPending(modTimer timer, void *refcon, uint32_t refconSize);
 
 static void socketMsgConnect(xsSocket xss);
@@ -1041,7 +1041,7 @@ void socketSetPending(xsSocket xss, uint8_t pending)
 	}
 }
 
-void socketClearPending(void *the, void *refcon, uint8_t *message, uint16_t messageLength)
+void socketClearPending(void *the, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	xsSocket xss = refcon;
 	uint8_t pending;
@@ -0,0 +1,753 @@
+/*
+ * Copyright (c) 2016-2017  Moddable Tech, Inc.
+ *
+ *   This file is part of the Moddable SDK Runtime.
+ *
+ *   The Moddable SDK Runtime is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU Lesser General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   The Moddable SDK Runtime is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU Lesser General Public License for more details.
+ *
+ *   You should have received a copy of the GNU Lesser General Public License
+ *   along with the Moddable SDK Runtime.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "xsmc.h"
+#include "mc.xs.h"			// for xsID_ values
+
+/*
+	websocket frame codec
+
+	receive parses frames from the buffers returned by socket.read(ArrayBuffer), across calls,
+	unmasking payloads into a native buffer and reassembling fragmented messages.
+	frame returns only the header of an unmasked frame so the payload can be written by the socket as is.
+
+	deflate enables permessage-deflate (RFC 7692) once negotiated, with miniz from commodetto.
+	the inflater decompresses into a ring of 2^windowBits bytes, so the window the peer may use sets its memory.
+	the deflater always has a 32 KB window. to stay within a smaller negotiated window, it compresses a quarter window
+	at a time and trims its dictionary before each piece. an 8 bit window is too small for that, so it compresses
+	each message on its own and only messages that fit in the window.
+*/
+
+#ifndef mxWebSocketVector
+	#if defined(__GNUC__) && (defined(__SSE2__) || defined(__ARM_NEON))
+		#define mxWebSocketVector 1
+	#else
+		#define mxWebSocketVector 0
+	#endif
+#endif
+
+#ifndef mxWebSocketDeflate
+	#if defined(__ets__) && !ESP32
+		#define mxWebSocketDeflate 0
+	#else
+		#define mxWebSocketDeflate 1
+	#endif
+#endif
+
+#if mxWebSocketDeflate
+	#define MINIZ_NO_STDIO
+	#define MINIZ_NO_TIME
+	#define MINIZ_NO_ARCHIVE_APIS
+	#define MINIZ_NO_ZLIB_APIS
+	#define MINIZ_NO_MALLOC
+	#ifdef __ets__
+		#define TDEFL_LESS_MEMORY 1
+	#endif
+	#include "../../commodetto/miniz.c"
+#endif
+
+#define kWebSocketMaxMessage (65536)
+#define kWebSocketKeepBytes (1024)
+
+enum {
+	kWebSocketContinuation = 0,
+	kWebSocketText = 1,
+	kWebSocketBinary = 2,
+	kWebSocketClose = 8,
+	kWebSocketPing = 9,
+	kWebSocketPong = 10,
+};
+
+typedef struct {
+	uint8_t		doMask;			// mask frames sent
+	uint8_t		opcode;			// opcode of completed message or control frame, 0 if none
+	uint8_t		message;		// opcode of message being reassembled, 0 if none
+	uint8_t		tag;			// first header byte of frame being received
+	uint8_t		headerBytes;
+	uint8_t		headerSize;		// 0 while in payload
+	uint8_t		header[14];
+	uint8_t		key[4];			// key of frame being received
+	uint8_t		controlBytes;
+	uint8_t		control[125];
+	uint32_t	phase;			// payload bytes of frame received
+	uint32_t	remaining;		// payload bytes of frame to receive
+	uint32_t	maxMessage;
+	uint32_t	dataBytes;
+	uint32_t	dataAllocated;
+	uint8_t		*data;
+#if mxWebSocketDeflate
+	uint8_t		compressed;		// message being reassembled has RSV1 set
+	uint8_t		deflateReset;	// compress each message without the previous ones
+	uint32_t	deflateLimit;	// largest message compressed
+	uint32_t	deflateWindow;	// negotiated window when less than the deflater's, otherwise 0
+	uint32_t	deflatedAllocated;
+	uint8_t		*deflated;
+	tdefl_compressor	*deflater;	// NULL to send uncompressed
+	tinfl_decompressor	*inflater;	// NULL until negotiated
+	uint8_t		*window;
+	uint32_t	windowMask;
+	uint32_t	windowOffset;
+#endif
+} xsWebSocketCodecRecord, *xsWebSocketCodec;
+
+static void websocketMask(uint8_t *dst, const uint8_t *src, uint32_t size, const uint8_t *key, uint32_t phase);
+static void websocketMaskString(uint8_t *dst, const char *src, uint32_t size, const uint8_t *key);
+static void websocketFrameDone(xsMachine *the, xsWebSocketCodec wsc);
+static void websocketHeaderDone(xsMachine *the, xsWebSocketCodec wsc);
+static int websocketIsType(xsMachine *the, xsSlot *slot, xsIndex id);
+#if mxWebSocketDeflate
+static uint32_t websocketDeflate(xsMachine *the, xsWebSocketCodec wsc, const uint8_t *src, uint32_t size);
+static void websocketInflate(xsMachine *the, xsWebSocketCodec wsc);
+#endif
+
+void websocketMask(uint8_t *dst, const uint8_t *src, uint32_t size, const uint8_t *key, uint32_t phase)
+{
+	uint8_t pattern[16];
+	uint64_t word, mask;
+	uint32_t i;
+
+	while (size && ((uintptr_t)dst & 7)) {
+		*dst++ = *src++ ^ key[phase++ & 3];
+		size--;
+	}
+	if (size < 8) {
+		while (size--)
+			*dst++ = *src++ ^ key[phase++ & 3];
+		return;
+	}
+
+	for (i = 0; i < sizeof(pattern); i++)
+		pattern[i] = key[(phase + i) & 3];
+
+#if mxWebSocketVector
+	{
+		typedef uint8_t websocketVector __attribute__((vector_size(16)));
+		websocketVector vector, pad;
+
+		c_memcpy(&pad, pattern, sizeof(pad));
+		while (size >= sizeof(vector)) {
+			c_memcpy(&vector, src, sizeof(vector));
+			vector ^= pad;
+			c_memcpy(dst, &vector, sizeof(vector));
+			src += sizeof(vector);
+			dst += sizeof(vector);
+			size -= sizeof(vector);
+		}
+	}
+#endif
+
+	c_memcpy(&mask, pattern, sizeof(mask));
+	while (size >= sizeof(word)) {
+		c_memcpy(&word, src, sizeof(word));
+		word ^= mask;
+		c_memcpy(dst, &word, sizeof(word));
+		src += sizeof(word);
+		dst += sizeof(word);
+		size -= sizeof(word);
+	}
+
+	for (i = 0; i < size; i++)
+		dst[i] = src[i] ^ pattern[i];
+}
+
+void websocketMaskString(uint8_t *dst, const char *src, uint32_t size, const uint8_t *key)
+{
+#if defined(__ets__) && !ESP32
+	uint32_t i;
+
+	for (i = 0; i < size; i++)		// string may be in flash
+		dst[i] = c_read8(src + i) ^ key[i & 3];
+#else
+	websocketMask(dst, (const uint8_t *)src, size, key, 0);
+#endif
+}
+
+int websocketIsType(xsMachine *the, xsSlot *slot, xsIndex id)
+{
+	xsSlot *s2;
+
+	xsmcGet(xsVar(0), xsGlobal, id);
+	s2 = &xsVar(0);
+	return slot->data[2] == s2->data[2];		//@@
+}
+
+void xs_websocket_mask(xsMachine *the)
+{
+	uint8_t *mask = xsmcToArrayBuffer(xsArg(1));
+	uint8_t key[4];
+	uint8_t *dst;
+	uint32_t srcSize;
+	xsType srcType, dstType;
+
+	c_memcpy(key, mask, sizeof(key));
+
+	srcType = xsmcTypeOf(xsArg(0));
+	if (xsStringType == srcType)
+		srcSize = c_strlen(xsmcToString(xsArg(0)));
+	else
+		srcSize = xsGetArrayBufferLength(xsArg(0));
+
+	if (xsmcArgc <= 2)
+		dstType = srcType;
+	else {
+		xsmcVars(1);
+		dstType = websocketIsType(the, &xsArg(2), xsID_String) ? xsStringType : xsReferenceType;
+	}
+
+	if (xsStringType == dstType) {
+		xsmcSetStringBuffer(xsResult, NULL, srcSize);
+		dst = (uint8_t *)xsmcToString(xsResult);
+	}
+	else {
+		xsmcSetArrayBuffer(xsResult, NULL, srcSize);
+		dst = xsmcToArrayBuffer(xsResult);
+	}
+
+	// source fetched after allocating the result, which may move it
+	if (xsStringType == srcType)
+		websocketMaskString(dst, xsmcToString(xsArg(0)), srcSize, key);
+	else
+		websocketMask(dst, xsmcToArrayBuffer(xsArg(0)), srcSize, key, 0);
+}
+
+void xs_websocket_codec_destructor(void *data)
+{
+	xsWebSocketCodec wsc = data;
+
+	if (wsc) {
+		if (wsc->data)
+			c_free(wsc->data);
+#if mxWebSocketDeflate
+		if (wsc->deflated)
+			c_free(wsc->deflated);
+		if (wsc->deflater)
+			c_free(wsc->deflater);
+		if (wsc->inflater)
+			c_free(wsc->inflater);
+		if (wsc->window)
+			c_free(wsc->window);
+#endif
+		c_free(wsc);
+	}
+}
+
+void xs_websocket_codec(xsMachine *the)
+{
+	xsWebSocketCodec wsc;
+
+	wsc = c_calloc(sizeof(xsWebSocketCodecRecord), 1);
+	if (!wsc)
+		xsUnknownError("no memory");
+	xsmcSetHostData(xsThis, wsc);
+
+	wsc->doMask = 1;
+	wsc->maxMessage = kWebSocketMaxMessage;
+	wsc->headerSize = 2;
+
+	if (xsmcArgc > 0) {
+		xsmcVars(1);
+		if (xsmcHas(xsArg(0), xsID_mask)) {
+			xsmcGet(xsVar(0), xsArg(0), xsID_mask);
+			wsc->doMask = xsmcTest(xsVar(0));
+		}
+		if (xsmcHas(xsArg(0), xsID_maxMessage)) {
+			xsmcGet(xsVar(0), xsArg(0), xsID_maxMessage);
+			if (xsUndefinedType != xsmcTypeOf(xsVar(0)))
+				wsc->maxMessage = xsmcToInteger(xsVar(0));
+		}
+	}
+}
+
+void xs_websocket_codec_deflate(xsMachine *the)
+{
+#if mxWebSocketDeflate
+	static const uint16_t probes[10] = { 0, 1, 6, 32, 16, 32, 128, 256, 512, 768 };		// tdefl_create_comp_flags_from_zip_params
+	xsWebSocketCodec wsc = xsmcGetHostData(xsThis);
+	int inflateBits = xsmcToInteger(xsArg(0));
+	int deflateBits = xsmcToInteger(xsArg(1));
+	int level = xsmcToInteger(xsArg(2));
+	int reset = xsmcTest(xsArg(3));
+
+	if (NULL == wsc)
+		xsUnknownError("closed");
+	if (wsc->inflater)
+		xsUnknownError("deflate already enabled");
+	if ((inflateBits < 8) || (inflateBits > 15) || (deflateBits < 8) || (deflateBits > 15) || (level < 0) || (level > 9))
+		xsRangeError("invalid deflate parameters");
+
+	wsc->inflater = c_malloc(sizeof(tinfl_decompressor));
+	wsc->window = c_calloc(1 << inflateBits, 1);
+	if (level)
+		wsc->deflater = c_malloc(sizeof(tdefl_compressor));
+	if (!wsc->inflater || !wsc->window || (level && !wsc->deflater)) {
+		if (wsc->inflater) c_free(wsc->inflater);
+		if (wsc->window) c_free(wsc->window);
+		if (wsc->deflater) c_free(wsc->deflater);
+		wsc->inflater = NULL;
+		wsc->window = NULL;
+		wsc->deflater = NULL;
+		xsUnknownError("no memory");
+	}
+
+	tinfl_init(wsc->inflater);
+	wsc->windowMask = (1 << inflateBits) - 1;
+	wsc->windowOffset = 0;
+
+	if (wsc->deflater) {
+		int flags = probes[level] | ((level <= 3) ? TDEFL_GREEDY_PARSING_FLAG : 0);
+		wsc->deflateReset = reset || (deflateBits < 9);
+		wsc->deflateLimit = (deflateBits < 9) ? ((uint32_t)1 << deflateBits) : 0xFFFFFFFF;
+		wsc->deflateWindow = ((deflateBits < 9) || (deflateBits == 15)) ? 0 : ((uint32_t)1 << deflateBits);
+		if (wsc->deflateWindow && (1 == level))
+			flags = 2 | TDEFL_GREEDY_PARSING_FLAG;		// the single probe path holds 4 KB of lookahead
+		tdefl_init(wsc->deflater, NULL, NULL, flags);
+	}
+#else
+	xsUnknownError("deflate unsupported");
+#endif
+}
+
+void xs_websocket_codec_close(xsMachine *the)
+{
+	xsWebSocketCodec wsc = xsmcGetHostData(xsThis);
+	xs_websocket_codec_destructor(wsc);
+	xsmcSetHostData(xsThis, NULL);
+}
+
+void xs_websocket_codec_receive(xsMachine *the)
+{
+	xsWebSocketCodec wsc = xsmcGetHostData(xsThis);
+	uint8_t *buffer;
+	uint32_t length, offset;
+
+	if (NULL == wsc)
+		xsUnknownError("closed");
+
+	length = xsGetArrayBufferLength(xsArg(0));
+	offset = (xsmcArgc > 1) ? xsmcToInteger(xsArg(1)) : 0;
+	if (offset > length)
+		xsUnknownError("invalid offset");
+	buffer = xsmcToArrayBuffer(xsArg(0));
+
+	// discard event from previous call
+	if (wsc->opcode) {
+		if (wsc->opcode & 8)
+			wsc->controlBytes = 0;
+		else
+			wsc->dataBytes = 0;
+		wsc->opcode = 0;
+	}
+
+	while ((offset < length) && !wsc->opcode) {
+		if (wsc->headerSize) {
+			while ((offset < length) && (wsc->headerBytes < wsc->headerSize)) {
+				wsc->header[wsc->headerBytes++] = buffer[offset++];
+				if (2 == wsc->headerBytes) {
+					uint8_t size = wsc->header[1] & 0x7F;
+					wsc->headerSize = 2 + ((126 == size) ? 2 : (127 == size) ? 8 : 0) + ((wsc->header[1] & 0x80) ? 4 : 0);
+				}
+			}
+			if (wsc->headerBytes == wsc->headerSize)
+				websocketHeaderDone(the, wsc);
+		}
+		else {
+			uint32_t use = length - offset;
+			uint8_t *dst;
+
+			if (use > wsc->remaining)
+				use = wsc->remaining;
+
+			if (wsc->tag & 8)
+				dst = wsc->control + wsc->controlBytes;
+			else
+				dst = wsc->data + wsc->dataBytes;
+
+			if (wsc->header[1] & 0x80)
+				websocketMask(dst, buffer + offset, use, wsc->key, wsc->phase);
+			else
+				c_memcpy(dst, buffer + offset, use);
+
+			if (wsc->tag & 8)
+				wsc->controlBytes += use;
+			else
+				wsc->dataBytes += use;
+			offset += use;
+			wsc->phase += use;
+			wsc->remaining -= use;
+
+			if (0 == wsc->remaining)
+				websocketFrameDone(the, wsc);
+		}
+	}
+
+	xsmcSetInteger(xsResult, offset);
+}
+
+void websocketHeaderDone(xsMachine *the, xsWebSocketCodec wsc)
+{
+	uint8_t *header = wsc->header, *key;
+	uint8_t tag = header[0];
+	uint8_t opcode = tag & 0x0F;
+	uint32_t size = header[1] & 0x7F;
+
+#if mxWebSocketDeflate
+	if ((tag & 0x30) || ((tag & 0x40) && (!wsc->inflater || (opcode & 8) || (kWebSocketContinuation == opcode))))
+#else
+	if (tag & 0x70)
+#endif
+		xsUnknownError("unsupported extension");
+
+	if (126 == size) {
+		size = (header[2] << 8) | header[3];
+		key = header + 4;
+	}
+	else if (127 == size) {
+		if (header[2] | header[3] | header[4] | header[5])
+			xsUnknownError("message too long");
+		size = ((uint32_t)header[6] << 24) | (header[7] << 16) | (header[8] << 8) | header[9];
+		key = header + 10;
+	}
+	else
+		key = header + 2;
+
+	if (opcode & 8) {
+		if ((opcode > kWebSocketPong) || !(tag & 0x80) || (size > sizeof(wsc->control)))
+			xsUnknownError("invalid control frame");
+	}
+	else if (kWebSocketContinuation == opcode) {
+		if (!wsc->message)
+			xsUnknownError("unexpected continuation frame");
+	}
+	else if (opcode > kWebSocketBinary)
+		xsUnknownError("unknown opcode");
+	else if (wsc->message)
+		xsUnknownError("expected continuation frame");
+
+	if (!(opcode & 8)) {
+		uint32_t needed;
+
+		if ((size > wsc->maxMessage) || ((wsc->maxMessage - size) < wsc->dataBytes))
+			xsUnknownError("message too long");
+		needed = wsc->dataBytes + size;
+		if (needed > wsc->dataAllocated) {
+			uint8_t *data = c_realloc(wsc->data, needed);
+			if (!data)
+				xsUnknownError("no memory");
+			wsc->data = data;
+			wsc->dataAllocated = needed;
+		}
+		if (kWebSocketContinuation != opcode) {
+			wsc->message = opcode;
+#if mxWebSocketDeflate
+			wsc->compressed = (tag & 0x40) ? 1 : 0;
+#endif
+		}
+	}
+
+	if (header[1] & 0x80)
+		c_memcpy(wsc->key, key, sizeof(wsc->key));
+
+	wsc->tag = tag;
+	wsc->phase = 0;
+	wsc->remaining = size;
+	wsc->headerSize = 0;
+	wsc->headerBytes = 0;
+
+	if (0 == size)
+		websocketFrameDone(the, wsc);
+}
+
+void websocketFrameDone(xsMachine *the, xsWebSocketCodec wsc)
+{
+	if (wsc->tag & 8)
+		wsc->opcode = wsc->tag & 0x0F;
+	else if (wsc->tag & 0x80) {
+#if mxWebSocketDeflate
+		if (wsc->compressed) {
+			wsc->compressed = 0;
+			websocketInflate(the, wsc);
+		}
+#endif
+		wsc->opcode = wsc->message;
+		wsc->message = 0;
+	}
+	wsc->headerSize = 2;
+}
+
+#if mxWebSocketDeflate
+void websocketInflate(xsMachine *the, xsWebSocketCodec wsc)
+{
+	static const uint8_t tail[4] = {0x00, 0x00, 0xFF, 0xFF};
+	const uint8_t *src = wsc->data;
+	size_t srcSize = wsc->dataBytes;
+	uint8_t *data = NULL;
+	uint32_t dataBytes = 0, dataAllocated = 0;
+	int last = 0;
+
+	while (1) {
+		size_t use = srcSize, produced = wsc->windowMask + 1 - wsc->windowOffset;
+		tinfl_status status = tinfl_decompress(wsc->inflater, src, &use, wsc->window, wsc->window + wsc->windowOffset, &produced, TINFL_FLAG_HAS_MORE_INPUT);
+
+		src += use;
+		srcSize -= use;
+		if (produced) {
+			if (produced > (wsc->maxMessage - dataBytes)) {
+				c_free(data);
+				xsUnknownError("message too long");
+			}
+			if ((dataBytes + produced) > dataAllocated) {
+				uint8_t *more;
+				dataAllocated = (dataAllocated < (wsc->maxMessage >> 1)) ? (dataAllocated << 1) : wsc->maxMessage;
+				if (dataAllocated < (dataBytes + produced))
+					dataAllocated = dataBytes + produced;
+				more = c_realloc(data, dataAllocated);
+				if (!more) {
+					c_free(data);
+					xsUnknownError("no memory");
+				}
+				data = more;
+			}
+			c_memcpy(data + dataBytes, wsc->window + wsc->windowOffset, produced);
+			dataBytes += produced;
+			wsc->windowOffset = (wsc->windowOffset + produced) & wsc->windowMask;
+		}
+
+		if (status < TINFL_STATUS_DONE) {
+			c_free(data);
+			xsUnknownError("invalid compressed message");
+		}
+		if (TINFL_STATUS_DONE == status) {		// final block, the next message starts a new stream
+			tinfl_init(wsc->inflater);
+			break;
+		}
+		if ((TINFL_STATUS_NEEDS_MORE_INPUT == status) && !srcSize) {
+			if (last)
+				break;
+			src = tail;		// removed by the sender
+			srcSize = sizeof(tail);
+			last = 1;
+		}
+	}
+
+	if (wsc->data)
+		c_free(wsc->data);
+	wsc->data = data;
+	wsc->dataBytes = dataBytes;
+	wsc->dataAllocated = dataAllocated;
+}
+
+uint32_t websocketDeflate(xsMachine *the, xsWebSocketCodec wsc, const uint8_t *src, uint32_t size)
+{
+	tdefl_compressor *deflater = wsc->deflater;
+	uint32_t consumed = 0, bytes = 0;
+
+	do {
+		uint32_t needed = bytes + (size - consumed) + ((size - consumed) >> 8) + 64;
+		size_t use, produced;
+		tdefl_flush flush;
+
+		if (needed > wsc->deflatedAllocated) {
+			uint8_t *deflated = c_realloc(wsc->deflated, needed);
+			if (!deflated)
+				xsUnknownError("no memory");
+			wsc->deflated = deflated;
+			wsc->deflatedAllocated = needed;
+		}
+
+		use = size - consumed;
+		if (wsc->deflateWindow) {
+			// the dictionary grows by at most the pending lookahead and the piece
+			uint32_t history;
+			if (use > (wsc->deflateWindow >> 2))
+				use = wsc->deflateWindow >> 2;
+			history = wsc->deflateWindow - (uint32_t)use - deflater->m_lookahead_size;
+			if (deflater->m_dict_size > history)
+				deflater->m_dict_size = history;
+		}
+		if (use < (size - consumed))
+			flush = TDEFL_NO_FLUSH;
+		else
+			flush = wsc->deflateReset ? TDEFL_FULL_FLUSH : TDEFL_SYNC_FLUSH;
+
+		produced = wsc->deflatedAllocated - bytes;
+		if (tdefl_compress(deflater, src ? src + consumed : NULL, &use, wsc->deflated + bytes, &produced, flush) < TDEFL_STATUS_OKAY)
+			xsUnknownError("deflate failed");
+		consumed += use;
+		bytes += produced;
+	} while ((consumed < size) || deflater->m_output_flush_remaining || deflater->m_lookahead_size);
+
+	return bytes - 4;		// 0x00 0x00 0xFF 0xFF of the flush
+}
+#endif
+
+void xs_websocket_codec_get_opcode(xsMachine *the)
+{
+	xsWebSocketCodec wsc = xsmcGetHostData(xsThis);
+	xsmcSetInteger(xsResult, wsc ? wsc->opcode : 0);
+}
+
+void xs_websocket_codec_read(xsMachine *the)
+{
+	xsWebSocketCodec wsc = xsmcGetHostData(xsThis);
+	uint8_t *data;
+	uint32_t size;
+
+	if ((NULL == wsc) || !wsc->opcode)
+		return;
+
+	if (wsc->opcode & 8) {
+		data = wsc->control;
+		size = wsc->controlBytes;
+	}
+	else {
+		data = wsc->data;
+		size = wsc->dataBytes;
+	}
+
+	if ((xsmcArgc > 0) && (xsReferenceType == xsmcTypeOf(xsArg(0)))) {
+		xsmcVars(1);
+		if (websocketIsType(the, &xsArg(0), xsID_String))
+			xsmcSetStringBuffer(xsResult, (char *)data, size);
+		else if (websocketIsType(the, &xsArg(0), xsID_ArrayBuffer))
+			xsmcSetArrayBuffer(xsResult, data, size);
+		else
+			xsUnknownError("unsupported output type");
+	}
+
+	if (wsc->opcode & 8)
+		wsc->controlBytes = 0;
+	else {
+		wsc->dataBytes = 0;
+		if (wsc->dataAllocated > kWebSocketKeepBytes) {
+			c_free(wsc->data);
+			wsc->data = NULL;
+			wsc->dataAllocated = 0;
+		}
+	}
+	wsc->opcode = 0;
+}
+
+void xs_websocket_codec_frame(xsMachine *the)
+{
+	xsWebSocketCodec wsc = xsmcGetHostData(xsThis);
+	uint8_t header[14], key[4], *dst;
+	uint8_t opcode = (uint8_t)xsmcToInteger(xsArg(0));
+	uint32_t size = 0, headerSize;
+	xsType type = xsUndefinedType;
+	int whole;
+
+	if (NULL == wsc)
+		xsUnknownError("closed");
+
+	if (xsmcArgc > 1) {
+		type = xsmcTypeOf(xsArg(1));
+		if (xsStringType == type)
+			size = c_strlen(xsmcToString(xsArg(1)));
+		else if (xsReferenceType == type)
+			size = xsGetArrayBufferLength(xsArg(1));
+		else
+			type = xsUndefinedType;
+	}
+
+	header[0] = 0x80 | opcode;
+	whole = wsc->doMask;
+
+#if mxWebSocketDeflate
+	if (wsc->deflater) {
+		whole = 1;
+		if (!(opcode & 8) && (size <= wsc->deflateLimit)) {
+			if (xsStringType == type)
+				size = websocketDeflate(the, wsc, (const uint8_t *)xsmcToString(xsArg(1)), size);
+			else if (xsReferenceType == type)
+				size = websocketDeflate(the, wsc, xsmcToArrayBuffer(xsArg(1)), size);
+			else
+				size = websocketDeflate(the, wsc, NULL, 0);
+			type = xsUndefinedType;		// payload is in wsc->deflated
+			header[0] |= 0x40;
+		}
+	}
+#endif
+
+	if (size < 126) {
+		header[1] = (uint8_t)size;
+		headerSize = 2;
+	}
+	else if (size < 65536) {
+		header[1] = 126;
+		header[2] = (uint8_t)(size >> 8);
+		header[3] = (uint8_t)size;
+		headerSize = 4;
+	}
+	else {
+		header[1] = 127;
+		header[2] = header[3] = header[4] = header[5] = 0;
+		header[6] = (uint8_t)(size >> 24);
+		header[7] = (uint8_t)(size >> 16);
+		header[8] = (uint8_t)(size >> 8);
+		header[9] = (uint8_t)size;
+		headerSize = 10;
+	}
+
+	if (!whole) {
+		xsmcSetArrayBuffer(xsResult, header, headerSize);
+		return;
+	}
+
+	// masked and compressed frames carry their payload
+	if (wsc->doMask) {
+		key[0] = (uint8_t)c_rand();
+		key[1] = (uint8_t)c_rand();
+		key[2] = (uint8_t)c_rand();
+		key[3] = (uint8_t)c_rand();
+		header[1] |= 0x80;
+		c_memcpy(header + headerSize, key, sizeof(key));
+		headerSize += sizeof(key);
+	}
+
+	xsmcSetArrayBuffer(xsResult, NULL, headerSize + size);
+	dst = xsmcToArrayBuffer(xsResult);
+	c_memcpy(dst, header, headerSize);
+	dst += headerSize;
+	if (xsStringType == type) {
+		if (wsc->doMask)
+			websocketMaskString(dst, xsmcToString(xsArg(1)), size, key);
+		else
+			c_memcpy(dst, xsmcToString(xsArg(1)), size);
+	}
+	else if (xsReferenceType == type) {
+		if (wsc->doMask)
+			websocketMask(dst, xsmcToArrayBuffer(xsArg(1)), size, key, 0);
+		else
+			c_memcpy(dst, xsmcToArrayBuffer(xsArg(1)), size);
+	}
+#if mxWebSocketDeflate
+	else if (header[0] & 0x40) {
+		if (wsc->doMask)
+			websocketMask(dst, wsc->deflated, size, key, 0);
+		else
+			c_memcpy(dst, wsc->deflated, size);
+		if (wsc->deflatedAllocated > kWebSocketKeepBytes) {
+			c_free(wsc->deflated);
+			wsc->deflated = NULL;
+			wsc->deflatedAllocated = 0;
+		}
+	}
+#endif
+}
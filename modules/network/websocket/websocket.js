@@ -22,7 +22,10 @@
 	websocket client and server
 
 	- validate Sec-WebSocket-Accept in client
-	- messages with characters with ascii values above 255 will fail
+	- permessage-deflate (RFC 7692) when dictionary.deflate is true or {windowBits, level, contextTakeover}
+		windowBits (8 to 15, default 15) limits the window the peer compresses with, which is the memory used to inflate
+		level (0 to 9, default 1) of compression. 0 inflates messages received but sends uncompressed, without a compressor
+		contextTakeover (default true) false compresses each message on its own, in both directions
 */
 
 import {Socket, Listener} from "socket";
@@ -65,46 +68,94 @@ export class Client {
 				this.socket = new Socket(dictionary);
 		}
 		this.socket.callback = callback.bind(this);
-		this.doMask = true;
+		this.doMask = (undefined === dictionary.mask) ? true : dictionary.mask;
+		this.codec = new Codec({mask: this.doMask, maxMessage: dictionary.maxMessage});
+		this.pending = [];
+		this.offset = 0;
+		if (dictionary.deflate)
+			this.deflate = Object.assign({windowBits: 15, level: 1, contextTakeover: true}, dictionary.deflate);
 	}
 
 	write(message) {
-	//@@ implement masking
-		let string = !(message instanceof ArrayBuffer);
-		if (string)
-			message = message.toString();
-
-		let length = string ? message.length : message.byteLength;
-		// Note: WS spec requires XOR masking for clients, but w/ strongly random mask. We
-		// can't achieve that on this device for now, so just punt and use 0x00000000 for
-		// a no-op mask.
-		if (length < 126) {
-			if (this.doMask)
-				this.socket.write(string ? 0x81 : 0x82, length | 0x80, 0, 0, 0, 0, message);
-			else
-				this.socket.write(string ? 0x81 : 0x82, length, message);
-		}
-		else if (length < 65536) {
-			if (this.doMask)
-				this.socket.write(string ? 0x81 : 0x82, 126 | 0x80, length >> 8, length & 0x0ff, 0, 0, 0, 0, message);
-			else
-				this.socket.write(string ? 0x81 : 0x82, 126, length >> 8, length & 0x0ff, message);
-		}
+		if (message instanceof ArrayBuffer)
+			send.call(this, 2, message);
 		else
-			throw new Error("message too long");
+			send.call(this, 1, message.toString());
 	}
 
 	close() {
 		this.socket.close();
 		delete this.socket;
+		this.codec.close();
 	}
 
 	mask() @ "xs_websocket_mask";
 };
 
+/*
+	frames are written directly when the socket has room for them, otherwise queued and written as a scatter list as the socket drains.
+	masked frames include their payload, which is the only case where the payload is copied.
+*/
+
+function send(opcode, payload) {
+	let socket = this.socket, pending = this.pending;
+	let frame = this.codec.frame(opcode, payload);
+
+	if (this.doMask || this.doDeflate)
+		payload = undefined;
+
+	if (!pending.length) {
+		let length = frame.byteLength;
+		if ("string" === typeof payload)
+			length += payload.length * 3;		// upper bound
+		else if (undefined !== payload)
+			length += payload.byteLength;
+		if (length <= socket.write()) {
+			if (undefined === payload)
+				socket.write(frame);
+			else
+				socket.write(frame, payload);
+			return;
+		}
+	}
+
+	if ("string" === typeof payload)
+		payload = ArrayBuffer.fromString(payload);		// queued strings are split by byte
+	pending.push(frame);
+	if (undefined !== payload)
+		pending.push(payload);
+	flush.call(this);
+}
+
+function flush() {
+	let socket = this.socket, pending = this.pending;
+	let available = socket.write(), items = [];
+
+	while (pending.length && available) {
+		let item = pending[0], offset = this.offset;
+		let count = item.byteLength - offset;
+
+		if (count > available) {
+			items.push(new Uint8Array(item, offset, available));
+			this.offset = offset + available;
+			break;
+		}
+
+		items.push(offset ? new Uint8Array(item, offset, count) : item);
+		pending.shift();
+		this.offset = 0;
+		available -= count;
+	}
+
+	if (items.length)
+		socket.write.apply(socket, items);
+}
+
 function callback(message, value) {
 	let socket = this.socket;
 
+	if (!socket) return;
+
 	if (1 == message) {	// connected
 		if (0 != this.state)
 			throw new Error("socket connected but ws not in connecting state");
@@ -127,6 +178,16 @@ function callback(message, value) {
 		if (this.protocol)
 			response.push(`Sec-WebSocket-Protocol: ${this.protocol}\r\n`);
 
+		let deflate = this.deflate;
+		if (deflate) {		// second offer lets the server limit the window we compress with
+			let offer = "permessage-deflate";
+			if (deflate.windowBits < 15)
+				offer += `; server_max_window_bits=${deflate.windowBits}`;
+			if (!deflate.contextTakeover)
+				offer += "; client_no_context_takeover; server_no_context_takeover";
+			response.push(`Sec-WebSocket-Extensions: ${offer}, ${offer}; client_max_window_bits\r\n`);
+		}
+
 		let hdr = undefined;
 		if (this.headers) for (let w of this.headers) {
 			if (hdr === undefined) {
@@ -178,6 +239,10 @@ trace("partial header!!\n");		//@@ untested
 
 				if ("\r\n" == line) {		// empty line is end of headers
 					if (7 == this.flags) {
+						if (this.deflated)
+							enable.call(this, this.deflated);
+						delete this.deflate;
+						delete this.deflated;
 						this.callback(2);		// websocket handshake complete
 						this.state = 3;			// ready to receive
 						value = socket.read();
@@ -209,53 +274,56 @@ trace("partial header!!\n");		//@@ untested
 					if ("websocket" == data.toLowerCase())
 						this.flags |= 4;
 				}
+				else if ("sec-websocket-extensions" == name) {
+					this.deflated = this.deflated ? undefined : accept(this.deflate, data);
+					if (!this.deflated)
+						this.flags |= 8;		// fail: not offered or not valid
+				}
 			}
 		}
-		if (3 == this.state) {		// receive message
-			let tag = socket.read(Number);
-			let length = socket.read(Number);
-			let mask = 0 != (length & 0x80);
-			length &= 0x7f;
-			if (126 == length) {
-				length = socket.read(Number) << 8;
-				length |= socket.read(Number);
-			}
-			else if (127 == length)
-				; //@@ crazy unsupported 8 byte length
-
-			switch (tag & 0x0f) {
-				case 1:
-				case 2:
-					let data;
-					if (mask) {
-						mask = socket.read(ArrayBuffer, 4);
-						data = this.mask(socket.read(ArrayBuffer, length), mask, (1 === (tag & 0x0f)) ? String : ArrayBuffer);
-					}
-					else
-						data = socket.read((1 === (tag & 0x0f)) ? String : ArrayBuffer, length);
-					this.callback(3, data);
-					break;
-				case 8:
+		if (3 == this.state) {		// receive messages
+			let codec = this.codec;
+			let buffer = socket.read(ArrayBuffer);
+			let offset = 0, length = buffer ? buffer.byteLength : 0;
+
+			while (offset < length) {
+				try {
+					offset = codec.receive(buffer, offset);
+				}
+				catch (e) {
+					trace(`websocket ${e}\n`);
 					this.state = 4;
-					this.callback(4);		// close
+					this.callback(4);		// protocol error
 					this.close();
 					return;
-				case 9:		// ping
-					if (length)
-						socket.write(0x8a, length, socket.read(ArrayBuffer, length));		//@@ assumes length is 125 or less
-					else
-						socket.write(0x8a, 0);
-					break;
-				case 10:		// pong
-					socket.read(null, length);
-					break;
-				default:
-					trace("unrecognized frame type\n");
-					break;
+				}
+
+				switch (codec.opcode) {
+					case 1:
+						this.callback(3, codec.read(String));
+						break;
+					case 2:
+						this.callback(3, codec.read(ArrayBuffer));
+						break;
+					case 8:
+						this.state = 4;
+						this.callback(4);		// close
+						this.close();
+						return;
+					case 9:		// ping
+						send.call(this, 10, codec.read(ArrayBuffer));
+						break;
+				}
+
+				if (!this.socket)
+					return;		// closed by callback
 			}
 		}
 	}
 
+	if (3 == message)		// data sent
+		flush.call(this);
+
 	if (-1 == message) {
 		if (4 !== this.state) {
 			this.callback(4);
@@ -270,8 +338,7 @@ export class Server {
 		this.listener = new Listener({port: dictionary.port ? dictionary.port : 80});
 		this.listener.callback = listener => {
 			let socket = new Socket({listener: this.listener});
-			let request = new Client({socket});
-			request.doMask = false;
+			let request = new Client({socket, mask: false, maxMessage: dictionary.maxMessage, deflate: dictionary.deflate});
 			socket.callback = server.bind(request);
 			request.state = 1;		// already connected socket
 			request.callback = this.callback;		// transfer server.callback to request.callback
@@ -326,11 +393,18 @@ trace("partial header!!\n");		//@@ untested
 					delete this.key;
 					sha1.write("258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
 
+					let deflated = (this.deflate && this.extensions) ? negotiate(this.deflate, this.extensions) : undefined;
+					delete this.deflate;
+					delete this.extensions;
+
 					socket.write("HTTP/1.1 101 Web Socket Protocol Handshake\r\n",
 								"Connection: Upgrade\r\n",
 								"Upgrade: websocket\r\n",
 								"Sec-WebSocket-Accept: ", Base64.encode(sha1.close()), "\r\n",
+								deflated ? `Sec-WebSocket-Extensions: ${deflated.response}\r\n` : "",
 								"\r\n");
+					if (deflated)
+						enable.call(this, deflated);
 
 					this.callback(2);		// websocket handshake complete
 
@@ -373,6 +447,8 @@ trace("partial header!!\n");		//@@ untested
 						this.flags |= 8;
 						this.key = data;
 					}
+					else if ("sec-websocket-extensions" === name)
+						this.extensions = this.extensions ? `${this.extensions}, ${data}` : data;
 				}
 			}
 		}
@@ -384,6 +460,135 @@ trace("partial header!!\n");		//@@ untested
 	}
 }
 
+/*
+	permessage-deflate negotiation. window bits and context takeover are named from the side that compresses:
+	server_max_window_bits and server_no_context_takeover apply to what the server sends.
+*/
+
+function extensions(data) {
+	return data.split(",").map(offer => {
+		let params = offer.split(";");
+		let extension = {name: params.shift().trim().toLowerCase(), params: {}};
+		params.forEach(param => {
+			let position = param.indexOf("="), value = true;
+			if (position >= 0) {
+				value = param.substring(position + 1).trim();
+				if ((value.length > 1) && ('"' == value[0]) && ('"' == value[value.length - 1]))
+					value = value.substring(1, value.length - 1);
+				param = param.substring(0, position);
+			}
+			param = param.trim().toLowerCase();
+			if (param in extension.params)
+				extension.invalid = true;
+			extension.params[param] = value;
+		});
+		return extension;
+	});
+}
+
+function windowBits(value) {
+	let bits = /^(8|9|1[0-5])$/.test(value) ? parseInt(value) : 0;
+	return bits ? bits : undefined;
+}
+
+function accept(deflate, data) {		// client: validate the server response to our offer
+	let response = extensions(data);
+	if (!deflate || (1 != response.length) || ("permessage-deflate" != response[0].name) || response[0].invalid)
+		return;
+
+	let params = response[0].params, result = {inflateBits: 15, deflateBits: 15, level: deflate.level, reset: !deflate.contextTakeover};
+	for (let name in params) {
+		let value = params[name];
+		if ("server_no_context_takeover" == name) {
+			if (true !== value) return;
+		}
+		else if ("client_no_context_takeover" == name) {
+			if (true !== value) return;
+			result.reset = true;
+		}
+		else if ("server_max_window_bits" == name) {
+			result.inflateBits = windowBits(value);
+			if (!result.inflateBits || (result.inflateBits > deflate.windowBits)) return;
+		}
+		else if ("client_max_window_bits" == name) {
+			result.deflateBits = windowBits(value);
+			if (!result.deflateBits) return;
+		}
+		else
+			return;
+	}
+	if ((deflate.windowBits < 15) && !("server_max_window_bits" in params))
+		return;
+	return result;
+}
+
+function negotiate(deflate, data) {		// server: accept the first offer that fits
+	let offers = extensions(data);
+	for (let i = 0; i < offers.length; i++) {
+		let offer = offers[i], params = offer.params, valid = !offer.invalid && ("permessage-deflate" == offer.name);
+		let result = {inflateBits: 15, deflateBits: 15, level: deflate.level, reset: !deflate.contextTakeover};
+		let response = "permessage-deflate", clientBits;
+
+		for (let name in params) {
+			let value = params[name];
+			if (("server_no_context_takeover" == name) || ("client_no_context_takeover" == name))
+				valid = valid && (true === value);
+			else if ("server_max_window_bits" == name) {
+				result.deflateBits = windowBits(value);
+				valid = valid && (undefined !== result.deflateBits);
+				response += `; server_max_window_bits=${result.deflateBits}`;
+			}
+			else if ("client_max_window_bits" == name) {
+				clientBits = (true === value) ? 15 : windowBits(value);
+				valid = valid && (undefined !== clientBits);
+			}
+			else
+				valid = false;
+		}
+		if (!valid)
+			continue;
+
+		if (undefined === clientBits) {
+			if (deflate.windowBits < 15)
+				continue;		// client compresses with 32 KB windows
+		}
+		else if (deflate.windowBits < clientBits) {
+			result.inflateBits = deflate.windowBits;
+			response += `; client_max_window_bits=${deflate.windowBits}`;
+		}
+		else
+			result.inflateBits = clientBits;
+
+		if ("server_no_context_takeover" in params)
+			result.reset = true;
+		if (result.reset)
+			response += "; server_no_context_takeover";
+		if (!deflate.contextTakeover)
+			response += "; client_no_context_takeover";
+
+		result.response = response;
+		return result;
+	}
+}
+
+function enable(deflated) {
+	this.codec.deflate(deflated.inflateBits, deflated.deflateBits, deflated.level, deflated.reset);
+	this.doDeflate = deflated.level > 0;
+}
+
+class Codec @ "xs_websocket_codec_destructor" {
+	constructor(dictionary) @ "xs_websocket_codec";
+
+	receive(buffer, offset) @ "xs_websocket_codec_receive";
+	read(type) @ "xs_websocket_codec_read";
+	get opcode() @ "xs_websocket_codec_get_opcode";
+
+	frame(opcode, payload) @ "xs_websocket_codec_frame";
+	deflate(inflateBits, deflateBits, level, reset) @ "xs_websocket_codec_deflate";
+
+	close() @ "xs_websocket_codec_close";
+};
+
 Object.freeze(Server.prototype);
 Object.freeze(Client.prototype);
 
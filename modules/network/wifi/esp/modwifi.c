@@ -26,7 +26,7 @@
 #include "user_interface.h"
 
 static void wifiScanComplete(void *arg, STATUS status);
-static void deliverScanResults(void *the, void *refcon, uint8_t *message, uint16_t messageLength);
+static void deliverScanResults(void *the, void *refcon, uint8_t *message, uint32_t messageLength);
 
 struct aWiFiResultRecord {
 	uint8 length;
@@ -188,7 +188,7 @@ void wifiScanComplete(void *arg, STATUS status)
 	modMessagePostToMachine(gScan->the, NULL, 0, deliverScanResults, NULL);
 }
 
-void deliverScanResults(void *the, void *refcon, uint8_t *message, uint16_t messageLength)
+void deliverScanResults(void *the, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	xsBeginHost(the);
 
@@ -263,7 +263,7 @@ struct xsWiFiRecord {
 
 static xsWiFi gWiFi;
 
-static void wifiEventPending(void *the, void *refcon, uint8_t *message, uint16_t messageLength)
+static void wifiEventPending(void *the, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	xsWiFi wifi = refcon;
 
@@ -193,7 +193,7 @@ void xs_wifi_connect(xsMachine *the)
 		xsUnknownError("esp_wifi_connect failed");
 }
 
-static void reportScan(void *the, void *refcon, uint8_t *message, uint16_t messageLength)
+static void reportScan(void *the, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	uint16_t count, i;
 	wifi_ap_record_t *aps;
@@ -271,7 +271,7 @@ struct xsWiFiRecord {
 
 static xsWiFi gWiFi;
 
-static void wifiEventPending(void *the, void *refcon, uint8_t *message, uint16_t messageLength)
+static void wifiEventPending(void *the, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	xsWiFi wifi = refcon;
 	system_event_id_t event_id = *(system_event_id_t *)message;
@@ -527,7 +527,7 @@ void audioOutLoop(void *pvParameter)
 	vTaskDelete(NULL);	// "If it is necessary for a task to exit then have the task call vTaskDelete( NULL ) to ensure its exit is clean."
 }
 
-static void deliverCallbacks(void *the, void *refcon, uint8_t *message, uint16_t messageLength)
+static void deliverCallbacks(void *the, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	modAudioOut out = refcon;
 
@@ -0,0 +1,37 @@
+/*---
+description: ++ and -- past the int32 limits give numbers, with or without the peephole optimizer (mxOptimizeCode, xsc -O)
+---*/
+
+let max = 2147483647, min = -2147483648;
+
+let x = max; x++;
+assert.sameValue(x, 2147483648, "local postfix ++");
+x = max; ++x;
+assert.sameValue(x, 2147483648, "local prefix ++");
+x = max;
+assert.sameValue(x++, max, "local postfix ++ value");
+assert.sameValue(++x, 2147483649, "local prefix ++ value");
+
+let y = min; y--;
+assert.sameValue(y, -2147483649, "local postfix --");
+y = min; --y;
+assert.sameValue(y, -2147483649, "local prefix --");
+y = min;
+assert.sameValue(y--, min, "local postfix -- value");
+assert.sameValue(--y, -2147483650, "local prefix -- value");
+
+let o = { p: max, q: min };
+o.p++;
+o.q--;
+assert.sameValue(o.p, 2147483648, "property ++");
+assert.sameValue(o.q, -2147483649, "property --");
+
+let f = () => { x = max; x++; y = min; y--; };
+f();
+assert.sameValue(x, 2147483648, "closure ++");
+assert.sameValue(y, -2147483649, "closure --");
+
+let a = [max, min];
+for (let i = 0; i < 2; i++) { a[0]++; a[1]--; }
+assert.sameValue(a[0], 2147483649, "element ++");
+assert.sameValue(a[1], -2147483650, "element --");
@@ -0,0 +1,37 @@
+/*---
+description: quantified groups iterate and capture like the specification, whether the backtracker or the automaton finishes the match
+---*/
+
+function check(regexp, subject, expected, message) {
+	let result = regexp.exec(subject);
+	assert.sameValue(JSON.stringify(result && Array.from(result)), JSON.stringify(expected), message);
+}
+
+// short subjects: the backtracker finishes the match
+check(/((a)|a|b)+c/, "adabc", ["abc", "b", undefined], "last capture of a capturing group");
+check(/(?:(a)|b)*/, "ab", ["ab", undefined], "only capture of a non-capturing group");
+check(/(?:(a)|(b))+/, "ab", ["ab", undefined, "b"], "captures of other alternatives");
+check(/(z)((a+)?(b+)?(c))*/, "zaacbbbcac", ["zaacbbbcac", "z", "ac", "a", undefined, "c"], "nested optional captures");
+check(/(?:(a)|b){2}/, "ab", ["ab", undefined], "counted quantifier");
+check(/(?:(a)|b)*?c/, "abc", ["abc", undefined], "lazy quantifier");
+check(/(?:a{2,3}){2}/, "aaab", null, "nested counted quantifiers");
+check(/(?:a{2,3}){2}/, "aaaab", ["aaaa"], "nested counted quantifiers backtrack into the outer iteration");
+check(/(a?)+?b/, "ab", ["ab", "a"], "lazy quantifier keeps the captures of its last iteration");
+check(/(a|b)*?c/, "abc", ["abc", "b"], "lazy quantifier keeps the captures of its last iteration");
+check(/(a*)*b/, "b", ["b", undefined], "empty optional iteration fails");
+check(/(a*?)*b/, "aab", ["aab", "a"], "empty optional iteration fails at every iteration");
+check(/(a*)+b/, "b", ["b", ""], "empty mandatory iteration succeeds");
+
+// long subjects: the backtracker runs out of steps and the automaton finishes the match
+let prefix = "a".repeat(28);
+check(/((a)|a|b)+c/, prefix + "dabc", ["abc", "b", undefined], "last capture of a capturing group, automaton");
+check(/(?:(a)|a|b)+c/, prefix + "dabc", ["abc", undefined], "only capture of a non-capturing group, automaton");
+check(/(?:(a)|a|(b))+c/, prefix + "dabc", ["abc", undefined, "b"], "captures of other alternatives, automaton");
+check(/(d+)+e|(?:a{2,3}){2}/, "aaab", null, "nested counted quantifiers, backtracker");
+check(/(d+)+e|(?:a{2,3}){2}/, "d".repeat(28) + "aaab", null, "nested counted quantifiers, automaton");
+
+// optional iterations that can be empty are kept off the automaton
+check(/(d+)+e|(a?)+?b/, "ab", ["ab", undefined, "a"], "lazy quantifier over an optional capture");
+check(/(d+)+e|(a?)+?b/, "d".repeat(12) + "ab", ["ab", undefined, "a"], "lazy quantifier over an optional capture, long subject");
+check(/(d+)+e|(a*)*b/, "b", ["b", undefined, undefined], "quantifier over a capture that can be empty");
+check(/(d+)+e|(a*)*b/, "d".repeat(12) + "b", ["b", undefined, undefined], "quantifier over a capture that can be empty, long subject");
@@ -171,6 +171,7 @@ typedef struct xsMachineRecord xsMachine;
 typedef struct xsSlotRecord xsSlot;
 typedef struct xsHostBuilderRecord xsHostBuilder;
 typedef struct xsHostHooksStruct xsHostHooks;
+typedef struct xsSnapshotRecord xsSnapshot;
 #else
 typedef struct sxCreation xsCreation;
 typedef struct sxJump xsJump;
@@ -178,6 +179,7 @@ typedef struct sxMachine xsMachine;
 typedef struct sxSlot xsSlot;
 typedef struct sxHostFunctionBuilder xsHostBuilder;
 typedef struct sxHostHooks xsHostHooks;
+typedef struct sxSnapshot xsSnapshot;
 #endif
 
 /* Slot */
@@ -949,6 +951,8 @@ struct xsHostHooksStruct {
 
 #define xsCollectGarbage() \
 	fxCollectGarbage(the)
+#define xsCollectGarbageIfDue(_PAUSE_LIMIT) \
+	fxCollectGarbageIfDue(the, _PAUSE_LIMIT)
 #define xsEnableGarbageCollection(_ENABLE) \
 	fxEnableGarbageCollection(the, _ENABLE)
 #define xsRemember(_SLOT) \
@@ -1121,6 +1125,15 @@ struct xsCreationRecord {
 	
 #define xsShareMachine(_THE) \
 	fxShareMachine(_THE)
+	
+#define xsSnapshotMachine(_THE) \
+	fxSnapshotMachine(_THE)
+	
+#define xsRestoreMachine(_CREATION,_SNAPSHOT,_NAME,_CONTEXT) \
+	fxRestoreMachine(_CREATION, _SNAPSHOT, _NAME, _CONTEXT)
+	
+#define xsDeleteSnapshot(_SNAPSHOT) \
+	fxDeleteSnapshot(_SNAPSHOT)
 
 /* Context */	
 	
@@ -1215,6 +1228,18 @@ typedef unsigned char xsAttribute;
 	(xsOverflow(-1), \
 	fxPush(_SLOT), \
 	fxMarshall(the, 1))
+#define xsMarshallTransfer(_SLOT,_TRANSFER,_COPIED) \
+	(xsOverflow(-2), \
+	fxPush(_TRANSFER), \
+	fxPush(_SLOT), \
+	fxMarshallTransfer(the, 0, _COPIED))
+#define xsMarshallAlienTransfer(_SLOT,_TRANSFER,_COPIED) \
+	(xsOverflow(-2), \
+	fxPush(_TRANSFER), \
+	fxPush(_SLOT), \
+	fxMarshallTransfer(the, 1, _COPIED))
+#define xsFreeMarshall(_DATA) \
+	fxFreeMarshall(_DATA)
 
 #define xsIsProfiling() \
 	fxIsProfiling(the)
@@ -1324,11 +1349,15 @@ mxImport xsMachine* fxCreateMachine(xsCreation*, xsStringValue, void*);
 mxImport void fxDeleteMachine(xsMachine*);
 mxImport xsMachine* fxCloneMachine(xsCreation*, xsMachine*, xsStringValue, void*);
 mxImport void fxShareMachine(xsMachine*);
+mxImport xsSnapshot* fxSnapshotMachine(xsMachine*);
+mxImport xsMachine* fxRestoreMachine(xsCreation*, xsSnapshot*, xsStringValue, void*);
+mxImport void fxDeleteSnapshot(xsSnapshot*);
 
 mxImport xsMachine* fxBeginHost(xsMachine*);
 mxImport void fxEndHost(xsMachine*);
 
 mxImport void fxCollectGarbage(xsMachine*);
+mxImport xsBooleanValue fxCollectGarbageIfDue(xsMachine*, xsIntegerValue);
 mxImport void fxEnableGarbageCollection(xsMachine* the, xsBooleanValue enableIt);
 
 mxImport xsSlot* fxDuplicateSlot(xsMachine*, xsSlot*);
@@ -1354,7 +1383,9 @@ mxImport xsStringValue fxNumberToString(xsMachine*, xsNumberValue, xsStringValue
 mxImport xsNumberValue fxStringToNumber(xsMachine*, xsStringValue theString, unsigned char whole);
 
 mxImport void fxDemarshall(xsMachine*, void*, xsBooleanValue);
+mxImport void fxFreeMarshall(void*);
 mxImport void* fxMarshall(xsMachine*, xsBooleanValue);
+mxImport void* fxMarshallTransfer(xsMachine*, xsBooleanValue, xsIntegerValue*);
 mxImport void fxModulePaths(xsMachine*);
 
 mxImport xsBooleanValue fxIsProfiling(xsMachine*);
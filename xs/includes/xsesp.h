@@ -267,10 +267,11 @@ void fxReceiveLoop(void);
 	messages
 */
 
-typedef void (*modMessageDeliver)(void *the, void *refcon, uint8_t *message, uint16_t messageLength);
+typedef void (*modMessageDeliver)(void *the, void *refcon, uint8_t *message, uint32_t messageLength);
 
 #if defined(__XS__)
-	int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint16_t messageLength, modMessageDeliver callback, void *refcon);
+	int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint32_t messageLength, modMessageDeliver callback, void *refcon);
+	int modMessagePostMarshallToMachine(xsMachine *the, void *data, modMessageDeliver callback, void *refcon);
 	#if ESP32
 		int modMessagePostToMachineFromISR(xsMachine *the, modMessageDeliver callback, void *refcon);
 		void modMessageService(xsMachine *the, int maxDelayMS);
@@ -1197,10 +1197,23 @@ struct modMessageRecord {
 	char				*message;
 	modMessageDeliver	callback;
 	void				*refcon;
-	uint16_t			length;
+	uint32_t			length;
+	uint8_t				marshalled;		// message is the address of a marshall buffer, freed if the message is not delivered
 };
 
-int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint16_t messageLength, modMessageDeliver callback, void *refcon)
+static int postMessage(xsMachine *the, uint8_t *message, uint32_t messageLength, modMessageDeliver callback, void *refcon, uint8_t marshalled);
+
+int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint32_t messageLength, modMessageDeliver callback, void *refcon)
+{
+	return postMessage(the, message, messageLength, callback, refcon, 0);
+}
+
+int modMessagePostMarshallToMachine(xsMachine *the, void *data, modMessageDeliver callback, void *refcon)
+{
+	return postMessage(the, (uint8_t *)&data, sizeof(data), callback, refcon, 1);
+}
+
+int postMessage(xsMachine *the, uint8_t *message, uint32_t messageLength, modMessageDeliver callback, void *refcon, uint8_t marshalled)
 {
 	modMessageRecord msg;
 
@@ -1215,6 +1228,7 @@ int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint16_t messageLe
 	msg.length = messageLength;
 	msg.callback = callback;
 	msg.refcon = refcon;
+	msg.marshalled = marshalled;
 
 	xQueueSend(the->msgQueue, &msg, portMAX_DELAY);
 
@@ -1230,6 +1244,7 @@ int modMessagePostToMachineFromISR(xsMachine *the, modMessageDeliver callback, v
 	msg.length = 0;
 	msg.callback = callback;
 	msg.refcon = refcon;
+	msg.marshalled = 0;
 
 	xQueueSendFromISR(the->msgQueue, &msg, &ignore);
 
@@ -1269,6 +1284,11 @@ void modMachineTaskUninit(xsMachine *the)
 		modMessageRecord msg;
 
 		while (xQueueReceive(the->msgQueue, &msg, 0)) {
+			if (msg.marshalled) {
+				void *data;
+				c_memcpy(&data, msg.message, sizeof(data));
+				xsFreeMarshall(data);
+			}
 			if (msg.message)
 				c_free(msg.message);
 		}
@@ -1297,9 +1317,10 @@ struct modMessageRecord {
 	xsMachine			*the;
 	modMessageDeliver	callback;
 	void				*refcon;
-	uint16_t			length;
+	uint32_t			length;
 	uint8_t				marked;
 	uint8_t				isStatic;		// this doubles as a flag to indicate entry is use gMessagePool
+	uint8_t				marshalled;		// message is the address of a marshall buffer, freed if the message is not delivered
 	char				message[1];
 };
 
@@ -1327,7 +1348,19 @@ static void appendMessage(modMessage msg)
 	modCriticalSectionEnd();
 }
 
-int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint16_t messageLength, modMessageDeliver callback, void *refcon)
+static int postMessage(xsMachine *the, uint8_t *message, uint32_t messageLength, modMessageDeliver callback, void *refcon, uint8_t marshalled);
+
+int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint32_t messageLength, modMessageDeliver callback, void *refcon)
+{
+	return postMessage(the, message, messageLength, callback, refcon, 0);
+}
+
+int modMessagePostMarshallToMachine(xsMachine *the, void *data, modMessageDeliver callback, void *refcon)
+{
+	return postMessage(the, (uint8_t *)&data, sizeof(data), callback, refcon, 1);
+}
+
+int postMessage(xsMachine *the, uint8_t *message, uint32_t messageLength, modMessageDeliver callback, void *refcon, uint8_t marshalled)
 {
 	modMessage msg = c_malloc(sizeof(modMessageRecord) + messageLength);
 	if (!msg) return -1;
@@ -1336,6 +1369,7 @@ int modMessagePostToMachine(xsMachine *the, uint8_t *message, uint16_t messageLe
 	msg->callback = callback;
 	msg->refcon = refcon;
 	msg->isStatic = 0;
+	msg->marshalled = marshalled;
 
 	if (message && messageLength)
 		c_memmove(msg->message, message, messageLength);
@@ -1374,6 +1408,7 @@ int modMessagePostToMachineFromPool(xsMachine *the, modMessageDeliver callback,
 	msg->callback = callback;
 	msg->refcon = refcon;
 	msg->length = 0;
+	msg->marshalled = 0;
 
 	appendMessage(msg);
 
@@ -1416,8 +1451,14 @@ void modMachineTaskUninit(xsMachine *the)
 	modMessage msg = gMessageQueue;
 
 	while (msg) {
-		if (msg->the == the)
+		if (msg->the == the) {
+			if (msg->marshalled && msg->callback) {
+				void *data;
+				c_memcpy(&data, msg->message, sizeof(data));
+				xsFreeMarshall(data);
+			}
 			msg->callback = NULL;
+		}
 		msg = msg->next;
 	}
 }
@@ -1427,7 +1468,7 @@ void modMachineTaskUninit(xsMachine *the)
 	promises
 */
 
-static void doRunPromiseJobs(void *machine, void *refcon, uint8_t *message, uint16_t messageLength)
+static void doRunPromiseJobs(void *machine, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	fxRunPromiseJobs((txMachine *)machine);
 }
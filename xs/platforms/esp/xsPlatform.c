@@ -413,7 +413,7 @@ bail:
 		xmodLogVar(the->debugBuffer);
 }
 
-static void doDebugCommand(void *machine, void *refcon, uint8_t *message, uint16_t messageLength)
+static void doDebugCommand(void *machine, void *refcon, uint8_t *message, uint32_t messageLength)
 {
 	txMachine* the = machine;
 
@@ -55,6 +55,7 @@
 #include <errno.h>
 #include <gio/gio.h>
 #include <linux/futex.h>
+#include <sys/mman.h>
 #include <sys/syscall.h>
 #include <unistd.h>
 
@@ -70,6 +71,9 @@
 #define mxUseDefaultParseScript 1
 #define mxUseDefaultSharedChunks 1
 
+#define mxProtectSharedMachine 1
+#define mxScriptCache 1
+
 #define mxMachinePlatform \
 	void* host; \
 	GSocket* socket; \
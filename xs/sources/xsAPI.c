@@ -1477,6 +1477,10 @@ void fxDeleteMachine(txMachine* the)
 		}
 	#endif
 	}
+#if mxProtectSharedMachine
+	else
+		fxProtectShare(the, 0);
+#endif
 	fxDeleteMachinePlatform(the);
 	fxFree(the);
 	c_free(the);
@@ -1642,6 +1646,9 @@ void fxShareMachine(txMachine* the)
 	#endif
 		fxShare(the);
 		the->shared = 1;
+	#if mxProtectSharedMachine
+		fxProtectShare(the, 1);
+	#endif
 	#ifdef mxProfile
 		if (the->profileBottom) {
 			c_free(the->profileBottom);
@@ -1653,6 +1660,72 @@ void fxShareMachine(txMachine* the)
 	}
 }
 
+#if mxSnapshot
+txSnapshot* fxSnapshotMachine(txMachine* the)
+{
+	/* only an idle machine, without C roots, can be snapshot */
+	if (the->shared || the->frame || the->cRoot)
+		return C_NULL;
+	return fxSnapshot(the);
+}
+
+txMachine* fxRestoreMachine(txCreation* theCreation, txSnapshot* theSnapshot, txString theName, void* theContext)
+{
+	txMachine* the = (txMachine* )c_calloc(sizeof(txMachine), 1);
+	if (the) {
+		txJump aJump;
+
+		aJump.nextJump = C_NULL;
+		aJump.stack = C_NULL;
+		aJump.scope = C_NULL;
+		aJump.frame = C_NULL;
+		aJump.code = C_NULL;
+		aJump.flag = 0;
+		the->firstJump = &aJump;
+		if (c_setjmp(aJump.buffer) == 0) {
+			the->dtoa = fxNew_dtoa(the);
+			the->preparation = theSnapshot->preparation;
+			the->context = theContext;
+			the->archive = theSnapshot->archive;
+			fxCreateMachinePlatform(the);
+
+		#ifdef mxDebug
+			the->name = theName;
+		#endif
+		#ifdef mxProfile
+			the->profileID = 1;
+			the->profileBottom = c_malloc(XS_PROFILE_COUNT * sizeof(txProfileRecord));
+			if (!the->profileBottom)
+				fxJump(the);
+			the->profileCurrent = the->profileBottom;
+			the->profileTop = the->profileBottom + XS_PROFILE_COUNT;
+		#endif
+
+			fxRestore(the, theCreation, theSnapshot);
+			
+			the->collectFlag = theSnapshot->collectFlag;
+
+		#ifdef mxDebug
+			fxLogin(the);
+		#endif
+
+			the->firstJump = C_NULL;
+		}
+		else {
+			fxFree(the);
+			c_free(the);
+			the = NULL;
+		}
+	}
+	return the;
+}
+
+void fxDeleteSnapshot(txSnapshot* theSnapshot)
+{
+	c_free(theSnapshot);
+}
+#endif
+
 /* Garbage Collector */
 
 void fxCollectGarbage(txMachine* the)
@@ -1660,6 +1733,23 @@ void fxCollectGarbage(txMachine* the)
 	fxCollect(the, 1);
 }
 
+txBoolean fxCollectGarbageIfDue(txMachine* the, txInteger pauseLimit)
+{
+	/* Not incremental: a complete collection runs ahead of the allocator when less than a quarter is free
+	and the last pause of the same kind, in microseconds, was within the limit. The first pause is not bounded. */
+	if ((the->collectFlag & XS_COLLECTING_FLAG) == 0)
+		return 0;
+	if (((the->maximumChunksSize - the->currentChunksSize) < (the->maximumChunksSize >> 2)) && (the->chunkCollectionPause <= pauseLimit)) {
+		fxCollect(the, 1);
+		return 1;
+	}
+	if (((the->maximumHeapCount - the->currentHeapCount) < (the->maximumHeapCount >> 2)) && (the->slotCollectionPause <= pauseLimit)) {
+		fxCollect(the, 0);
+		return 1;
+	}
+	return 0;
+}
+
 void fxEnableGarbageCollection(txMachine* the, txBoolean enableIt)
 {
 	if (enableIt)
@@ -157,7 +157,10 @@ txString fxConcatString(txMachine* the, txSlot* a, txSlot* b)
 {
 	txSize aSize = c_strlen(a->value.string);
 	txSize bSize = c_strlen(b->value.string);
-	txString result = (txString)fxNewChunk(the, aSize + bSize + 1);
+	txString result;
+	if (bSize == 0)
+		return a->value.string;
+	result = (txString)fxNewChunk(the, aSize + bSize + 1);
 	c_memcpy(result, a->value.string, aSize);
 	c_memcpy(result + aSize, b->value.string, bSize + 1);
 	a->value.string = result;
@@ -165,6 +168,40 @@ txString fxConcatString(txMachine* the, txSlot* a, txSlot* b)
 	return result;
 }
 
+#if mxStringAppend
+txString fxAppendString(txMachine* the, txSlot* variable, txSlot* a, txSlot* b)
+{
+	txSize aSize, bSize = c_strlen(b->value.string);
+	txSize capacity;
+	txString result = a->value.string;
+	if ((variable == the->appendSlot) && (variable->kind == XS_STRING_KIND) && (variable->value.string == the->appendString) && (a == the->appendStack) && (a->kind == XS_STRING_KIND) && (result == the->appendString)) {
+		the->appendStack = C_NULL;
+		aSize = the->appendLength;
+		capacity = ((txChunk*)(result - sizeof(txChunk)))->size - sizeof(txChunk);
+		if ((aSize + bSize + 1 <= capacity) || fxRenewChunk(the, result, (aSize + bSize + 1) << 1)) {
+			fxFlushStringIndexCache(the, result);
+			c_memcpy(result + aSize, b->value.string, bSize + 1);
+			the->appendLength = aSize + bSize;
+			return result;
+		}
+	}
+	else
+		aSize = c_strlen(result);
+	capacity = aSize + bSize + 1;
+	capacity += capacity >> 1;
+	result = (txString)fxNewChunk(the, capacity);
+	c_memcpy(result, a->value.string, aSize);
+	c_memcpy(result + aSize, b->value.string, bSize + 1);
+	a->value.string = result;
+	a->kind = XS_STRING_KIND;
+	the->appendSlot = variable;
+	the->appendStack = C_NULL;
+	the->appendString = result;
+	the->appendLength = aSize + bSize;
+	return result;
+}
+#endif
+
 txString fxConcatStringC(txMachine* the, txSlot* a, txString b)
 {
 	txSize aSize = c_strlen(a->value.string);
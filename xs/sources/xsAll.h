@@ -48,6 +48,65 @@ extern "C" {
 #ifndef mxRegExp
 	#define mxRegExp 1
 #endif
+#ifndef mxInlineCache
+	#define mxInlineCache 1
+#endif
+#ifndef mxInlineCacheCount
+	#define mxInlineCacheCount 256
+#endif
+#define mxInlineCacheShadowCount 1024
+#ifndef mxShapes
+	#define mxShapes 1
+#endif
+#ifndef mxShapeCount
+	#define mxShapeCount 4096
+#endif
+#ifndef mxShapeLength
+	#define mxShapeLength 32
+#endif
+#define mxShapeModulo 256
+#ifndef mxStringAppend
+	#define mxStringAppend 1
+#endif
+#ifndef mxStringIndexCache
+	#define mxStringIndexCache 1
+#endif
+#define mxStringIndexCacheCount 4
+#define mxStringIndexCacheMinimum 64
+#ifndef mxRegExpCache
+	#if defined(mxUseDefaultSharedChunks) && mxUseDefaultSharedChunks
+		#define mxRegExpCache 1
+	#else
+		#define mxRegExpCache 0
+	#endif
+#endif
+#ifndef mxRegExpCacheCount
+	#define mxRegExpCacheCount 64
+#endif
+#define mxRegExpCacheSize (256 * 1024)
+#ifndef mxJobPool
+	#define mxJobPool 1
+#endif
+#ifndef mxJobPoolCount
+	#define mxJobPoolCount 256
+#endif
+#ifndef mxTransferChunks
+	#if defined(mxUseDefaultChunkAllocation) && mxUseDefaultChunkAllocation
+		#define mxTransferChunks 1
+	#else
+		#define mxTransferChunks 0
+	#endif
+#endif
+#ifndef mxProtectSharedMachine
+	#define mxProtectSharedMachine 0
+#endif
+#ifndef mxSnapshot
+	#if defined(mxUseDefaultChunkAllocation) && mxUseDefaultChunkAllocation
+		#define mxSnapshot 1
+	#else
+		#define mxSnapshot 0
+	#endif
+#endif
 #ifndef mxMachinePlatform
 	#define mxMachinePlatform \
 		void* host;
@@ -61,10 +120,14 @@ typedef struct sxJump txJump;
 typedef struct sxProfileRecord txProfileRecord;
 typedef struct sxCreation txCreation;
 typedef struct sxPreparation txPreparation;
+typedef struct sxSnapshot txSnapshot;
 typedef struct sxHostFunctionBuilder txHostFunctionBuilder;
 typedef struct sxHostHooks txHostHooks;
 typedef struct sxInspectorNameLink txInspectorNameLink;
 typedef struct sxInspectorNameList txInspectorNameList;
+typedef struct sxInlineCache txInlineCache;
+typedef struct sxShape txShape;
+typedef struct sxStringIndexCache txStringIndexCache;
 
 typedef txBoolean (*txArchiveRead)(void* src, size_t offset, void* buffer, size_t size);
 typedef txBoolean (*txArchiveWrite)(void* dst, size_t offset, void* buffer, size_t size);
@@ -143,6 +206,16 @@ typedef struct {
 #define mxSortThreshold 4
 #define mxSortStackSize 8 * sizeof(txUnsigned)
 
+typedef struct {
+	union {
+		txNumber number;
+		txString string;
+	} key;
+	txIndex index;
+} txSortRecord;
+#define mxSortRunLength 8
+#define mxSortKeySize 32
+
 #define mxTypeArrayCount 9
 
 typedef struct {
@@ -227,6 +300,9 @@ struct sxBlock {
 	txByte* current;
 	txByte* limit;
 	txByte* temporary;
+#if mxTransferChunks
+	txBoolean transferred;
+#endif
 };
 
 struct sxChunk {
@@ -273,6 +349,35 @@ struct sxProfileRecord {
 	txInteger profileID;
 };
 
+struct sxInlineCache {
+	txByte* code;
+	txSlot* instance;
+	txSlot* property;
+	txUnsigned epoch;
+	txBoolean own;
+#if mxShapes
+	txID shape;
+	txU2 offset;
+	txSlot* prototype;
+#endif
+};
+
+struct sxShape {
+	txInteger parent;
+	txInteger link;
+	txU4 filter;
+	txID id;
+	txU2 length;
+};
+
+struct sxStringIndexCache {
+	txString string;
+	txInteger length;
+	txInteger size;
+	txInteger index;
+	txInteger offset;
+};
+
 struct sxMachine {
 	txSlot* stack; /* xs.h */
 	txSlot* scope; /* xs.h */
@@ -328,10 +433,40 @@ struct sxMachine {
 	txSlot* sharedModules;
 
 	txBoolean collectFlag;
+	txInteger slotCollectionPause;
+	txInteger chunkCollectionPause;
+	txSize avoidedCompactionCount;
 	txFlag requireFlag;
 	void* dtoa;
 	void* preparation;
 
+#if mxInlineCache
+	txInlineCache* inlineCaches;
+	txUnsigned inlineCacheEpoch;
+	txU1 inlineCacheShadows[mxInlineCacheShadowCount >> 3];
+#endif
+#if mxShapes
+	txShape* shapes;
+	txInteger* shapeTable;
+	txInteger shapeCount;
+	txInteger shapeSize;
+#endif
+#if mxStringAppend
+	txSlot* appendSlot;
+	txSlot* appendStack;
+	txString appendString;
+	txSize appendLength;
+#endif
+#if mxStringIndexCache
+	txStringIndexCache stringIndexCaches[mxStringIndexCacheCount];
+	txInteger stringIndexCacheVictim;
+#endif
+	txSlot* lastJob;
+#if mxJobPool
+	txSlot* freeJobs;
+	txInteger freeJobCount;
+#endif
+
 	char nameBuffer[256];
 #ifdef mxDebug
 	txString name;
@@ -357,7 +492,15 @@ struct sxMachine {
 #endif
 #ifdef mxInstrument
 	txSize garbageCollectionCount;
+	txSize slotCollectionCount;
+	txSize chunkCollectionCount;
+	txNumber slotCollectionTime;
+	txNumber chunkCollectionTime;
 	txSize loadedModulesCount;
+	txSize inlineCacheHitCount;
+	txSize inlineCacheMissCount;
+	txSize regExpCacheHitCount;
+	txSize regExpCacheMissCount;
 	txSize parserTotal;
 	txSlot* stackPeak;
 	void (*onBreak)(txMachine*, txU1 stop);
@@ -417,6 +560,52 @@ struct sxPreparation {
 	txU1 checksum[16];
 };
 
+#if mxSnapshot
+struct sxSnapshot {
+	txSize size;
+	
+	txSize slotCount;
+	txSlot* slots;
+	txSize stackCount;
+	txSlot* stack;
+	txSize chunksSize;
+	txByte* chunks;
+
+	txID keyCount;
+	txID keyIndex;
+	int keyOffset;
+	txSlot** keys;
+	txSize nameModulo;
+	txSlot** names;
+	txSize symbolModulo;
+	txSlot** symbols;
+	txID aliasCount;
+	txSlot** aliases;
+#if mxShapes
+	txInteger shapeCount;
+	txShape* shapes;
+	txInteger* shapeTable;
+#endif
+
+	txSlot* stackPrototypes;
+	txSlot* lastJob;
+#if mxJobPool
+	txSlot* freeJobs;
+	txInteger freeJobCount;
+#endif
+	txBoolean collectFlag;
+	txFlag requireFlag;
+	txMachine* sharedMachine;
+	txSlot* sharedModules;
+	txSlot** keyArrayHost;
+	void* preparation;
+	void* archive;
+#ifdef mxInstrument
+	txSize loadedModulesCount;
+#endif
+};
+#endif
+
 struct sxHostFunctionBuilder {
 	txCallback callback;
 	txID length;
@@ -533,18 +722,26 @@ mxExport txMachine* fxCreateMachine(txCreation* theCreation, txString theName, v
 mxExport void fxDeleteMachine(txMachine*);
 mxExport txMachine* fxCloneMachine(txCreation* theCreation, txMachine* theMachine, txString theName, void* theContext);
 mxExport void fxShareMachine(txMachine* the);
+#if mxSnapshot
+mxExport txSnapshot* fxSnapshotMachine(txMachine* the);
+mxExport txMachine* fxRestoreMachine(txCreation* theCreation, txSnapshot* theSnapshot, txString theName, void* theContext);
+mxExport void fxDeleteSnapshot(txSnapshot* theSnapshot);
+#endif
 
 mxExport txMachine* fxBeginHost(txMachine*);
 mxExport void fxEndHost(txMachine*);
 
 mxExport void fxCollectGarbage(txMachine*);
+mxExport txBoolean fxCollectGarbageIfDue(txMachine*, txInteger pauseLimit);
 mxExport void fxEnableGarbageCollection(txMachine* the, txBoolean enableIt);
 mxExport void fxRemember(txMachine*, txSlot*);
 mxExport void fxForget(txMachine*, txSlot*);
 mxExport void fxAccess(txMachine*, txSlot*);
 
 mxExport void fxDemarshall(txMachine* the, void* theData, txBoolean alien);
+mxExport void fxFreeMarshall(void* theData);
 mxExport void* fxMarshall(txMachine* the, txBoolean alien);
+mxExport void* fxMarshallTransfer(txMachine* the, txBoolean alien, txSize* copied);
 mxExport void fxModulePaths(txMachine* the);
 
 mxExport void fxBuildArchiveKeys(txMachine* the);
@@ -586,10 +783,12 @@ extern void fxSweepHost(txMachine* the);
 mxExport void fxInitializeSharedCluster();
 mxExport void fxTerminateSharedCluster();
 extern void* fxCreateSharedChunk(txInteger byteLength);
+extern void fxLockSharedCache();
 extern void fxLockSharedChunk(void* data);
 extern txInteger fxMeasureSharedChunk(void* data);
 extern void fxReleaseSharedChunk(void* data);
 extern void* fxRetainSharedChunk(void* data);
+extern void fxUnlockSharedCache();
 extern void fxUnlockSharedChunk(void* data);
 extern txInteger fxWaitSharedChunk(txMachine* the, void* data, txInteger offset, txInteger value, txNumber timeout);
 extern txInteger fxWakeSharedChunk(txMachine* the, void* data, txInteger offset, txInteger count);
@@ -620,6 +819,9 @@ extern void fxBufferFrameName(txMachine* the, txString buffer, txSize size, txSl
 extern void fxBufferFunctionName(txMachine* the, txString buffer, txSize size, txSlot* function, txString suffix);
 extern void fxBufferObjectName(txMachine* the, txString buffer, txSize size, txSlot* object, txString suffix);
 extern txString fxConcatString(txMachine* the, txSlot* a, txSlot* b);
+#if mxStringAppend
+extern txString fxAppendString(txMachine* the, txSlot* variable, txSlot* a, txSlot* b);
+#endif
 extern txString fxConcatStringC(txMachine* the, txSlot* a, txString b);
 extern txString fxCopyString(txMachine* the, txSlot* a, txSlot* b);
 extern txString fxCopyStringC(txMachine* the, txSlot* a, txString b);
@@ -639,13 +841,24 @@ extern txBoolean fxIsSameValue(txMachine* the, txSlot* a, txSlot* b, txBoolean z
 /* xsMemory.c */
 extern void fxCheckStack(txMachine* the, txSlot* slot);
 extern void fxAllocate(txMachine* the, txCreation* theCreation);
+extern void* fxAttachChunk(txMachine* the, txBlock* theBlock);
 extern void fxCollect(txMachine* the, txBoolean theFlag);
+extern txBlock* fxDetachChunk(txMachine* the, void* theData);
 mxExport txSlot* fxDuplicateSlot(txMachine* the, txSlot* theSlot);
 extern void fxFree(txMachine* the);
 mxExport void* fxNewChunk(txMachine* the, txSize theSize);
 extern txSlot* fxNewSlot(txMachine* the);
 mxExport void* fxRenewChunk(txMachine* the, void* theData, txSize theSize);
+#if mxSnapshot
+extern void fxRestore(txMachine* the, txCreation* theCreation, txSnapshot* theSnapshot);
+#endif
 extern void fxShare(txMachine* the);
+#if mxProtectSharedMachine
+extern void fxProtectShare(txMachine* the, txBoolean readOnly);
+#endif
+#if mxSnapshot
+extern txSnapshot* fxSnapshot(txMachine* the);
+#endif
 
 /* xsDebug.c */
 #ifdef mxDebug
@@ -696,6 +909,10 @@ extern txBoolean fxOrdinaryIsExtensible(txMachine* the, txSlot* instance);
 extern void fxOrdinaryOwnKeys(txMachine* the, txSlot* target, txFlag flag, txSlot* keys);
 extern txBoolean fxOrdinaryPreventExtensions(txMachine* the, txSlot* instance);
 extern txBoolean fxOrdinarySetPrototype(txMachine* the, txSlot* instance, txSlot* prototype);
+#if mxInlineCache
+extern txSlot* fxGetCachedProperty(txMachine* the, txInlineCache* cache, txByte* code, txSlot* instance, txID id);
+extern txSlot* fxSetCachedProperty(txMachine* the, txSlot* instance, txID id);
+#endif
 
 /* xsProperty.c */
 extern txSlot* fxNextHostAccessorProperty(txMachine* the, txSlot* property, txCallback get, txCallback set, txID id, txFlag flag);
@@ -715,6 +932,7 @@ extern txSlot* fxNextStringXProperty(txMachine* the, txSlot* property, txString
 extern txSlot* fxNextSymbolProperty(txMachine* the, txSlot* property, txID symbol, txID id, txFlag flag);
 extern txSlot* fxNextTypeDispatchProperty(txMachine* the, txSlot* property, txTypeDispatch* dispatch, txTypeAtomics* atomics, txID id, txFlag flag);
 
+extern txSlot* fxQueueAliasKeys(txMachine* the, txSlot* instance, txSlot* first, txFlag flag, txSlot* keys);
 extern txSlot* fxQueueIDKeys(txMachine* the, txSlot* first, txFlag flag, txSlot* keys);
 extern txSlot* fxQueueIndexKeys(txMachine* the, txSlot* array, txFlag flag, txSlot* keys);
 extern txSlot* fxQueueKey(txMachine* the, txID id, txIndex index, txSlot* keys);
@@ -788,6 +1006,10 @@ mxExport void fx_Object_values(txMachine* the);
 
 extern void fxBuildObject(txMachine* the);
 extern txSlot* fxNewObjectInstance(txMachine* the);
+#if mxShapes
+extern txSlot* fxGetShapeProperty(txMachine* the, txSlot* instance, txInteger offset);
+extern txID fxNextShape(txMachine* the, txID shape, txID id);
+#endif
 extern void fxFreezePropertyStep(txMachine* the, txSlot* context, txID id, txIndex index, txSlot* property);
 extern void fxIsPropertyFrozenStep(txMachine* the, txSlot* context, txID id, txIndex index, txSlot* property);
 
@@ -1009,6 +1231,17 @@ extern void fxBuildString(txMachine* the);
 extern txSlot* fxNewStringInstance(txMachine* the);
 extern txSlot* fxAccessStringProperty(txMachine* the, txSlot* instance, txInteger index);
 extern void fxPushSubstitutionString(txMachine* the, txSlot* string, txInteger size, txInteger offset, txSlot* match, txInteger length, txInteger count, txSlot* captures, txSlot* groups, txSlot* replace);
+#if mxStringIndexCache
+extern void fxFlushStringIndexCache(txMachine* the, txString string);
+extern txInteger fxStringUnicodeLength(txMachine* the, txString string);
+extern txInteger fxStringUnicodeToUTF8Offset(txMachine* the, txString string, txInteger index);
+extern txInteger fxStringUTF8ToUnicodeOffset(txMachine* the, txString string, txInteger offset);
+#else
+#define fxFlushStringIndexCache(THE, STRING)
+#define fxStringUnicodeLength(THE, STRING) fxUnicodeLength(STRING)
+#define fxStringUnicodeToUTF8Offset(THE, STRING, INDEX) fxUnicodeToUTF8Offset(STRING, INDEX)
+#define fxStringUTF8ToUnicodeOffset(THE, STRING, OFFSET) fxUTF8ToUnicodeOffset(STRING, OFFSET)
+#endif
 
 /* xsRegExp.c */
 mxExport void fx_RegExp(txMachine* the);
@@ -1323,10 +1556,15 @@ extern txSlot* fxNewMapInstance(txMachine* the);
 extern txSlot* fxNewSetInstance(txMachine* the);
 extern txSlot* fxNewWeakMapInstance(txMachine* the);
 extern txSlot* fxNewWeakSetInstance(txMachine* the);
+extern void fxRehashEntries(txMachine* the, txSlot* table);
 
 /* xsJSON.c */
 mxExport void fx_JSON_parse(txMachine* the);
 mxExport void fx_JSON_stringify(txMachine* the);
+mxExport void fx_JSONParser(txMachine* the);
+mxExport void fx_JSONParser_destructor(void* it);
+mxExport void fx_JSONParser_prototype_close(txMachine* the);
+mxExport void fx_JSONParser_prototype_push(txMachine* the);
 
 extern void fxBuildJSON(txMachine* the);
 
@@ -1493,6 +1731,7 @@ enum {
 	XS_COLLECTING_FLAG = 1,
 	XS_TRASHING_FLAG = 2,
 	XS_SKIPPED_COLLECT_FLAG = 4,
+	XS_CHUNK_TRASHING_FLAG = 8,
 	XS_HOST_CHUNK_FLAG = 32,
 	XS_HOST_HOOKS_FLAG = 64
 };
@@ -1917,6 +2156,53 @@ enum {
 #define mxBehaviorSetPrototype(THE, INSTANCE, PROTOTYPE) \
 	(*mxBehavior(INSTANCE)->setPrototype)(THE, INSTANCE, PROTOTYPE)
 
+#if mxShapes
+#define mxShapeIndex(ID) (-2 - (txInteger)(ID))
+#define mxShapeID(INDEX) ((txID)(-2 - (INDEX)))
+#define mxShapeBit(ID) (((txU4)1) << (((txU2)(ID)) & 31))
+#define mxShapeHas(THE, SHAPE, ID) \
+	((THE)->shapes[mxShapeIndex(SHAPE)].filter & mxShapeBit(ID))
+#define mxIsShaped(INSTANCE) \
+	((INSTANCE)->ID < XS_NO_ID)
+#define mxShapeForget(INSTANCE) \
+	if (mxIsShaped(INSTANCE)) \
+		(INSTANCE)->ID = XS_NO_ID
+#else
+#define mxIsShaped(INSTANCE) 0
+#define mxShapeForget(INSTANCE)
+#endif
+
+#if mxInlineCache
+#define mxInlineCacheAt(THE, CODE) \
+	((THE)->inlineCaches + ((txUnsigned)(((size_t)(CODE)) ^ (((size_t)(CODE)) >> 8)) & (mxInlineCacheCount - 1)))
+#define mxInlineCacheHit(THE, CACHE, CODE, INSTANCE) \
+	(((CACHE)->code == (CODE)) && ((CACHE)->epoch == (THE)->inlineCacheEpoch) && (((CACHE)->instance == (INSTANCE)) || mxInlineCacheShapeHit(CACHE, INSTANCE)))
+#if mxShapes
+#define mxInlineCacheShapeHit(CACHE, INSTANCE) \
+	(((CACHE)->shape == (INSTANCE)->ID) && ((CACHE)->shape < XS_NO_ID) && ((CACHE)->own || ((CACHE)->prototype == (INSTANCE)->value.instance.prototype)))
+#define mxInlineCacheProperty(THE, CACHE, INSTANCE) \
+	((((CACHE)->instance == (INSTANCE)) || !(CACHE)->own) ? (CACHE)->property : fxGetShapeProperty(THE, INSTANCE, (CACHE)->offset))
+#else
+#define mxInlineCacheShapeHit(CACHE, INSTANCE) 0
+#define mxInlineCacheProperty(THE, CACHE, INSTANCE) \
+	(CACHE)->property
+#endif
+#define mxInlineCacheFlush(THE) { \
+	(THE)->inlineCacheEpoch++; \
+	c_memset((THE)->inlineCacheShadows, 0, sizeof((THE)->inlineCacheShadows)); \
+}
+#define mxInlineCacheShadowBit(ID) \
+	(1 << ((ID) & 7))
+#define mxInlineCacheShadowByte(THE, ID) \
+	(THE)->inlineCacheShadows[((ID) & (mxInlineCacheShadowCount - 1)) >> 3]
+#define mxInlineCacheShadow(THE, ID) \
+	if (mxInlineCacheShadowByte(THE, ID) & mxInlineCacheShadowBit(ID)) \
+		mxInlineCacheFlush(THE)
+#else
+#define mxInlineCacheFlush(THE)
+#define mxInlineCacheShadow(THE, ID)
+#endif
+
 #define mxCall(_FUNCTION,_THIS,_COUNT) \
 	mxPushInteger(_COUNT); \
 	mxPushSlot(_THIS); \
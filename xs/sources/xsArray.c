@@ -43,7 +43,7 @@
 static txIndex fxCheckArrayLength(txMachine* the, txSlot* slot);
 static txBoolean fxCallThisItem(txMachine* the, txSlot* function, txIndex index, txSlot* item);
 static txSlot* fxCheckArray(txMachine* the, txSlot* slot);
-static int fxCompareArrayItem(txMachine* the, txSlot* function, txSlot* array, txInteger i);
+static int fxCompareArrayItem(txMachine* the, txSlot* function, txSlot* a, txSlot* b);
 static txSlot* fxCreateArray(txMachine* the, txFlag flag, txIndex length);
 static txSlot* fxCreateArraySpecies(txMachine* the, txNumber length);
 static void fxFindThisItem(txMachine* the, txSlot* function, txIndex index, txSlot* item);
@@ -52,6 +52,10 @@ static txIndex fxGetArrayLimit(txMachine* the, txSlot* reference);
 static void fxMoveThisItem(txMachine* the, txNumber from, txNumber to);
 static void fxReduceThisItem(txMachine* the, txSlot* function, txIndex index);
 static txBoolean fxSetArrayLength(txMachine* the, txSlot* array, txIndex target);
+static txInteger fxSortArrayComparator(txMachine* the, txSlot* function, txID* id);
+static void fxSortArrayItems(txMachine* the, txSlot* function, txSlot* array);
+static txBoolean fxSortArrayKeys(txMachine* the, txSlot* function, txSlot* array);
+static txSortRecord* fxSortArrayRecords(txSortRecord* from, txSortRecord* to, txIndex length, txInteger mode);
 static void fx_Array_from_aux(txMachine* the, txSlot* function, txIndex index);
 
 static txBoolean fxArrayDefineOwnProperty(txMachine* the, txSlot* instance, txID id, txIndex index, txSlot* slot, txFlag mask);
@@ -352,11 +356,8 @@ again:
 	return 0;
 }
 
-int fxCompareArrayItem(txMachine* the, txSlot* function, txSlot* array, txInteger i)
+int fxCompareArrayItem(txMachine* the, txSlot* function, txSlot* a, txSlot* b)
 {
-	txSlot* address = array->value.array.address;
-	txSlot* a = address + i;
-	txSlot* b = the->stack;
 	int result;
 	
 	if (!(a->ID))
@@ -667,6 +668,268 @@ txBoolean fxSetArrayLength(txMachine* the, txSlot* array, txIndex length)
 }
 
 
+txInteger fxSortArrayComparator(txMachine* the, txSlot* function, txID* id)
+{
+	/* recognize (a, b) => a - b and (a, b) => a.k - b.k, in both orders */
+	txSlot* code = mxFunctionInstanceCode(function);
+	txByte* p;
+	txU1 byte, locals[2], operands[2];
+	txID ids[2];
+	txInteger i;
+	if ((code->kind != XS_CODE_KIND) && (code->kind != XS_CODE_X_KIND))
+		return 0;
+	p = code->value.code.address;
+	for (;;) {
+		byte = c_read8(p);
+		if ((byte == XS_CODE_BEGIN_SLOPPY) || (byte == XS_CODE_BEGIN_STRICT) || (byte == XS_CODE_FILE) || (byte == XS_CODE_LINE) || (byte == XS_CODE_NEW_LOCAL)
+				|| (byte == XS_CODE_RESERVE_1) || (byte == XS_CODE_RETRIEVE_1) || (byte == XS_CODE_RETRIEVE_TARGET) || (byte == XS_CODE_RETRIEVE_THIS)) {
+			i = gxCodeSizes[byte];
+			p += (i == 0) ? 1 + (txInteger)sizeof(txID) : i;
+		}
+		else
+			break;
+	}
+	for (i = 0; i < 2; i++) {
+		if ((c_read8(p) != XS_CODE_ARGUMENT) || (c_read8(p + 1) != i) || (c_read8(p + 2) != XS_CODE_VAR_LOCAL_1) || (c_read8(p + 4) != XS_CODE_POP))
+			return 0;
+		locals[i] = c_read8(p + 3);
+		p += 5;
+		while (c_read8(p) == XS_CODE_LINE)
+			p += gxCodeSizes[XS_CODE_LINE];
+	}
+	for (i = 0; i < 2; i++) {
+		if (c_read8(p) != XS_CODE_GET_LOCAL_1)
+			return 0;
+		operands[i] = c_read8(p + 1);
+		p += 2;
+		if (c_read8(p) == XS_CODE_GET_PROPERTY) {
+			p++;
+			mxDecode2(p, ids[i]);
+		}
+		else
+			ids[i] = XS_NO_ID;
+	}
+	if ((c_read8(p) != XS_CODE_SUBTRACT) || (c_read8(p + 1) != XS_CODE_RESULT) || (ids[0] != ids[1]))
+		return 0;
+	*id = ids[0];
+	if ((operands[0] == locals[0]) && (operands[1] == locals[1]))
+		return 1;
+	if ((operands[0] == locals[1]) && (operands[1] == locals[0]))
+		return -1;
+	return 0;
+}
+
+void fxSortArrayItems(txMachine* the, txSlot* function, txSlot* array)
+{
+	/* bottom-up merge sort, the comparator can collect garbage so addresses are reloaded after each comparison */
+	txIndex length = array->value.array.length;
+	txSlot* buffer;
+	txSlot* source;
+	txSlot* target;
+	txSlot* swap;
+	txSlot* from;
+	txSlot* to;
+	txIndex width, lo, mid, hi, i, j, k;
+	mxPush(mxArrayPrototype);
+	buffer = fxNewArrayInstance(the)->next;
+	fxSetIndexSize(the, buffer, length);
+	#define COPY \
+		to->ID = from->ID; \
+		to->kind = from->kind; \
+		to->value = from->value
+	for (lo = 0; lo < length; lo += mxSortRunLength) {
+		hi = (length - lo > mxSortRunLength) ? lo + mxSortRunLength : length;
+		for (i = lo + 1; i < hi; i++) {
+			from = array->value.array.address + i;
+			mxPushUndefined();
+			to = the->stack;
+			COPY;
+			for (j = i; (j > lo) && (fxCompareArrayItem(the, function, array->value.array.address + j - 1, the->stack) > 0); j--) {
+				from = array->value.array.address + j - 1;
+				to = from + 1;
+				COPY;
+			}
+			from = the->stack++;
+			to = array->value.array.address + j;
+			COPY;
+		}
+	}
+	source = array;
+	target = buffer;
+	for (width = mxSortRunLength; width < length; width <<= 1) {
+		for (lo = 0; lo < length; lo += width << 1) {
+			mid = (length - lo > width) ? lo + width : length;
+			hi = (length - mid > width) ? mid + width : length;
+			i = lo;
+			j = mid;
+			k = lo;
+			while ((i < mid) && (j < hi)) {
+				if (fxCompareArrayItem(the, function, source->value.array.address + i, source->value.array.address + j) > 0)
+					from = source->value.array.address + j++;
+				else
+					from = source->value.array.address + i++;
+				to = target->value.array.address + k++;
+				COPY;
+			}
+			while (i < mid) {
+				from = source->value.array.address + i++;
+				to = target->value.array.address + k++;
+				COPY;
+			}
+			while (j < hi) {
+				from = source->value.array.address + j++;
+				to = target->value.array.address + k++;
+				COPY;
+			}
+		}
+		swap = source;
+		source = target;
+		target = swap;
+	}
+	if (source != array) {
+		from = source->value.array.address;
+		to = array->value.array.address;
+		for (i = 0; i < length; i++, from++, to++) {
+			COPY;
+		}
+	}
+	#undef COPY
+	mxPop();
+}
+
+txBoolean fxSortArrayKeys(txMachine* the, txSlot* function, txSlot* array)
+{
+	/* sort without calling JavaScript: strings or numbers without comparator, number keys with a recognized comparator */
+	txIndex length = array->value.array.length, i;
+	txSlot* address = array->value.array.address;
+	txSlot* slot;
+	txInteger mode = 0;
+	txIndex strings = 0, numbers = 0;
+	txID id = XS_NO_ID;
+	txSortRecord* records;
+	txSortRecord* result;
+	txSlot* items;
+	txString keys = C_NULL;
+	txBoolean success = 0;
+	if (function) {
+		mode = fxSortArrayComparator(the, function, &id);
+		if (!mode)
+			return 0;
+	}
+	for (i = 0, slot = address; i < length; i++, slot++) {
+		if (!slot->ID || (slot->flag & XS_DONT_SET_FLAG))
+			return 0;
+		if (id != XS_NO_ID) {
+			if (slot->kind != XS_REFERENCE_KIND)
+				return 0;
+			numbers++;
+		}
+		else if ((slot->kind == XS_STRING_KIND) || (slot->kind == XS_STRING_X_KIND))
+			strings++;
+		else if ((slot->kind == XS_INTEGER_KIND) || (slot->kind == XS_NUMBER_KIND))
+			numbers++;
+		else
+			return 0;
+	}
+	if (mode ? (numbers != length) : ((strings != length) && (numbers != length)))
+		return 0;
+	records = c_malloc(2 * length * sizeof(txSortRecord));
+	items = c_malloc(length * sizeof(txSlot));
+	if (!mode && numbers)
+		keys = c_malloc(length * mxSortKeySize);
+	if (!records || !items || (!mode && numbers && !keys))
+		goto bail;
+	for (i = 0, slot = address; i < length; i++, slot++) {
+		txSlot* value = slot;
+		records[i].index = i;
+		if (id != XS_NO_ID) {
+			txSlot* instance = slot->value.reference;
+			value = C_NULL;
+			while (instance) {
+				if (instance->flag & XS_EXOTIC_FLAG)
+					break;
+				value = mxBehaviorGetProperty(the, instance, id, XS_NO_ID, XS_OWN);
+				if (value)
+					break;
+				instance = instance->value.instance.prototype;
+			}
+			if (!value || ((value->kind != XS_INTEGER_KIND) && (value->kind != XS_NUMBER_KIND)))
+				goto bail;
+		}
+		if (value->kind == XS_INTEGER_KIND) {
+			if (mode)
+				records[i].key.number = value->value.integer;
+			else
+				records[i].key.string = fxIntegerToString(the->dtoa, value->value.integer, keys + (i * mxSortKeySize), mxSortKeySize);
+		}
+		else if (value->kind == XS_NUMBER_KIND) {
+			if (mode)
+				records[i].key.number = value->value.number;
+			else
+				records[i].key.string = fxNumberToString(the->dtoa, value->value.number, keys + (i * mxSortKeySize), mxSortKeySize, 0, 0);
+		}
+		else
+			records[i].key.string = value->value.string;
+	}
+	result = fxSortArrayRecords(records, records + length, length, mode);
+	c_memcpy(items, address, length * sizeof(txSlot));
+	for (i = 0, slot = address; i < length; i++, slot++) {
+		txSlot* item = items + result[i].index;
+		slot->ID = item->ID;
+		slot->kind = item->kind;
+		slot->value = item->value;
+	}
+	success = 1;
+bail:
+	if (keys)
+		c_free(keys);
+	if (items)
+		c_free(items);
+	if (records)
+		c_free(records);
+	return success;
+}
+
+txSortRecord* fxSortArrayRecords(txSortRecord* from, txSortRecord* to, txIndex length, txInteger mode)
+{
+	/* bottom-up merge sort, stable */
+	#define COMPARE(A, B) \
+		((mode == 0) ? c_strcmp((A)->key.string, (B)->key.string) : \
+		(mode > 0) ? (((A)->key.number - (B)->key.number) > 0) : (((B)->key.number - (A)->key.number) > 0))
+	txSortRecord* swap;
+	txSortRecord record;
+	txIndex width, lo, mid, hi, i, j, k;
+	for (lo = 0; lo < length; lo += mxSortRunLength) {
+		hi = (length - lo > mxSortRunLength) ? lo + mxSortRunLength : length;
+		for (i = lo + 1; i < hi; i++) {
+			record = from[i];
+			for (j = i; (j > lo) && (COMPARE(from + j - 1, &record) > 0); j--)
+				from[j] = from[j - 1];
+			from[j] = record;
+		}
+	}
+	for (width = mxSortRunLength; width < length; width <<= 1) {
+		for (lo = 0; lo < length; lo += width << 1) {
+			mid = (length - lo > width) ? lo + width : length;
+			hi = (length - mid > width) ? mid + width : length;
+			i = lo;
+			j = mid;
+			k = lo;
+			while ((i < mid) && (j < hi))
+				to[k++] = (COMPARE(from + i, from + j) > 0) ? from[j++] : from[i++];
+			while (i < mid)
+				to[k++] = from[i++];
+			while (j < hi)
+				to[k++] = from[j++];
+		}
+		swap = from;
+		from = to;
+		to = swap;
+	}
+	#undef COMPARE
+	return from;
+}
+
 txNumber fxToLength(txMachine* the, txSlot* slot)
 {
 again:
@@ -787,7 +1050,9 @@ void fxArrayOwnKeys(txMachine* the, txSlot* instance, txFlag flag, txSlot* keys)
 	if (flag & XS_EACH_NAME_FLAG)
 		keys = fxQueueKey(the, mxID(_length), XS_NO_ID, keys);
 	property = property->next;
-	fxQueueIDKeys(the, property, flag, keys);
+	keys = fxQueueIDKeys(the, property, flag, keys);
+	if (instance->ID >= 0)
+		fxQueueAliasKeys(the, instance, property, flag, keys);
 }
 
 txSlot* fxArraySetProperty(txMachine* the, txSlot* instance, txID id, txIndex index, txFlag flag)
@@ -1957,108 +2222,43 @@ void fx_Array_prototype_sort(txMachine* the)
 		fxCacheArray(the, instance);
 	}
 	length = array->value.array.length;
-	/* like GCC qsort */
-	#define COMPARE(INDEX) \
-		fxCompareArrayItem(the, function, array, INDEX)
-	#define COPY \
-		to->ID = from->ID; \
-		to->kind = from->kind; \
-		to->value = from->value
-	#define MOVE(FROM,TO) \
-		from = array->value.array.address + (FROM); \
-		to = array->value.array.address + (TO); \
-		COPY
-	#define PUSH(INDEX) \
-		from = array->value.array.address + (INDEX); \
-		mxPushUndefined(); \
-		to = the->stack; \
-		COPY
-	#define PULL(INDEX) \
-		from = the->stack++; \
-		to = array->value.array.address + (INDEX); \
-		COPY
-	if (length > 0) {
-		txIndex i, j;
-		txSlot* from;
-		txSlot* to;
-		if (length > mxSortThreshold) {
-			txIndex lo = 0, hi = length - 1;
-			txSortPartition stack[mxSortStackSize];
-			txSortPartition *top = stack + 1;
-			while (stack < top) {
-				txIndex mid = lo + ((hi - lo) >> 1);
-				PUSH(mid);
-				if (COMPARE(lo) > 0) {
-					MOVE(lo, mid);
-					PULL(lo);
-					PUSH(mid);
-				}
-				if (COMPARE(hi) < 0) {
-					MOVE(hi, mid);
-					PULL(hi);
-					PUSH(mid);
-					if (COMPARE(lo) > 0) {
-						MOVE(lo, mid);
-						PULL(lo);
-						PUSH(mid);
-					}
-				}
-				i = lo + 1;
-				j = hi - 1;
-				do {
-					while (COMPARE(i) < 0) i++;
-					while (COMPARE(j) > 0) j--;
-					if (i < j) {
-						PUSH(i);
-						MOVE(j, i);
-						PULL(j);
-						i++;
-						j--;
-					}
-					else if (i == j) {
-						i++;
-						j--;
-						break;
-					}
-				} while (i <= j);
-				if ((j - lo) <= mxSortThreshold) {
-					if ((hi - i) <= mxSortThreshold) {
-						top--;
-						lo = top->lo; 
-						hi = top->hi;
-					}
-					else {
-						lo = i;
-					}
-				}
-				else if ((hi - i) <= mxSortThreshold) {
-					hi = j;
-				}
-				else if ((j - lo) > (hi - i)) {
-					top->lo = lo;
-					top->hi = j; 
-					top++;
-					lo = i;
-				}
-				else {
-					top->lo = i;
-					top->hi = hi; 
-					top++;
-					hi = j;
-				}
-			}
-		}
-		for (i = 1; i < length; i++) {
-			PUSH(i);
-			for (j = i; (j > 0) && (COMPARE(j - 1) > 0); j--) {
-				MOVE(j - 1, j);
-			}	
-			PULL(j);
+	if ((length > 1) && !fxSortArrayKeys(the, function, array)) {
+		if (!instance) {
+			/* the comparator can modify the array, sort a copy */
+			txSlot* original = array;
+			mxPush(mxArrayPrototype);
+			instance = fxNewArrayInstance(the);
+			array = instance->next;
+			fxSetIndexSize(the, array, length);
+			c_memcpy(array->value.array.address, original->value.array.address, length * sizeof(txSlot));
+			LENGTH = length;
 		}
+		fxSortArrayItems(the, function, array);
 	}
 	if (instance) {
-		item = array->value.array.address;
+		txSlot* target = fxCheckArray(the, mxThis);
 		index = 0;
+		if (target && (target->value.array.length == length)) {
+			item = target->value.array.address;
+			while (index < length) {
+				if ((item->kind == XS_ACCESSOR_KIND) || (item->flag & XS_DONT_SET_FLAG))
+					break;
+				item++;
+				index++;
+			}
+			if (index == length) {
+				txSlot* from = array->value.array.address;
+				item = target->value.array.address;
+				for (index = 0; index < length; index++, from++, item++) {
+					item->ID = from->ID;
+					item->kind = from->kind;
+					item->value = from->value;
+				}
+			}
+			else
+				index = 0;
+		}
+		item = array->value.array.address + index;
 		while (index < length) {
 			mxPushSlot(item);
 			mxPushSlot(mxThis);
@@ -506,6 +506,14 @@ struct sxSharedChunk {
 
 txSharedCluster* gxSharedCluster = C_NULL;
 
+#if defined(mxUseLinuxFutex) && defined(mxUseGCCAtomics)
+static txS4 gxSharedCacheLock = 0;
+#elif defined(mxUsePOSIXThreads)
+static pthread_mutex_t gxSharedCacheLock = PTHREAD_MUTEX_INITIALIZER;
+#elif mxWindows
+static SRWLOCK gxSharedCacheLock = SRWLOCK_INIT;
+#endif
+
 void fxInitializeSharedCluster()
 {
 	gxSharedCluster = c_calloc(sizeof(txSharedCluster), 1);
@@ -590,6 +598,39 @@ void fxUnlockSharedChunk(void* data)
 #endif
 }
 
+void fxLockSharedCache()
+{
+#if defined(mxUseLinuxFutex) && defined(mxUseGCCAtomics)
+	txS4 state = 0;
+	if (!__atomic_compare_exchange_n(&gxSharedCacheLock, &state, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+		if (state != 2)
+			state = __atomic_exchange_n(&gxSharedCacheLock, 2, __ATOMIC_ACQUIRE);
+		while (state != 0) {
+			futex(&gxSharedCacheLock, FUTEX_WAIT, 2, C_NULL, C_NULL, 0);
+			state = __atomic_exchange_n(&gxSharedCacheLock, 2, __ATOMIC_ACQUIRE);
+		}
+	}
+#elif defined(mxUsePOSIXThreads)
+	pthread_mutex_lock(&gxSharedCacheLock);
+#elif mxWindows
+	AcquireSRWLockExclusive(&gxSharedCacheLock);
+#endif
+}
+
+void fxUnlockSharedCache()
+{
+#if defined(mxUseLinuxFutex) && defined(mxUseGCCAtomics)
+	if (__atomic_fetch_sub(&gxSharedCacheLock, 1, __ATOMIC_RELEASE) != 1) {
+		__atomic_store_n(&gxSharedCacheLock, 0, __ATOMIC_RELEASE);
+		futex(&gxSharedCacheLock, FUTEX_WAKE, 1, C_NULL, C_NULL, 0);
+	}
+#elif defined(mxUsePOSIXThreads)
+	pthread_mutex_unlock(&gxSharedCacheLock);
+#elif mxWindows
+	ReleaseSRWLockExclusive(&gxSharedCacheLock);
+#endif
+}
+
 txInteger fxWaitSharedChunk(txMachine* the, void* data, txInteger offset, txInteger value, txNumber timeout)
 {
 	txInteger* address = (txInteger*)((txByte*)data + offset);
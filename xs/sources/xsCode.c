@@ -136,6 +136,9 @@ static txInteger fxCoderCountParameters(txCoder* self, txNode* it);
 static txTargetCode* fxCoderCreateTarget(txCoder* self);
 static txTargetCode* fxCoderFinalizeTargets(txCoder* self, txTargetCode* alias, txInteger selector, txInteger* address, txTargetCode* finallyTarget);
 static void fxCoderJumpTargets(txCoder* self, txTargetCode* target, txInteger selector, txInteger* address);
+static void fxCoderOptimize(txCoder* self);
+static txBoolean fxCoderOptimizeIntegers(txIntegerCode* a, txIntegerCode* b, txInteger id);
+static txTargetCode* fxCoderThreadTarget(txTargetCode* target);
 static txInteger fxCoderUseTemporaryVariable(txCoder* self);
 static void fxCoderUnuseTemporaryVariables(txCoder* self, txInteger count);
 
@@ -186,6 +189,8 @@ txScript* fxParserCode(txParser* parser)
 	coder.parser = parser;
 	if (parser->errorCount == 0)
 		fxNodeDispatchCode(parser->root, &coder);
+	if ((parser->errorCount == 0) && parser->optimizeFlag)
+		fxCoderOptimize(&coder);
 	if (parser->errorCount) {
 		char* buffer = "invalid script";
 		txSize length = c_strlen(buffer);
@@ -280,8 +285,11 @@ txScript* fxParserCode(txParser* parser)
 			
 		case XS_CODE_CONST_CLOSURE_1:
 		case XS_CODE_CONST_LOCAL_1:
+		case XS_CODE_DECREMENT_LOCAL_1:
 		case XS_CODE_GET_CLOSURE_1:
 		case XS_CODE_GET_LOCAL_1:
+		case XS_CODE_GET_LOCAL_APPEND_1:
+		case XS_CODE_INCREMENT_LOCAL_1:
 		case XS_CODE_LET_CLOSURE_1:
 		case XS_CODE_LET_LOCAL_1:
 		case XS_CODE_PULL_CLOSURE_1:
@@ -408,8 +416,11 @@ txScript* fxParserCode(txParser* parser)
 			
 		case XS_CODE_CONST_CLOSURE_1:
 		case XS_CODE_CONST_LOCAL_1:
+		case XS_CODE_DECREMENT_LOCAL_1:
 		case XS_CODE_GET_CLOSURE_1:
 		case XS_CODE_GET_LOCAL_1:
+		case XS_CODE_GET_LOCAL_APPEND_1:
+		case XS_CODE_INCREMENT_LOCAL_1:
 		case XS_CODE_LET_CLOSURE_1:
 		case XS_CODE_LET_LOCAL_1:
 		case XS_CODE_PULL_CLOSURE_1:
@@ -430,8 +441,11 @@ txScript* fxParserCode(txParser* parser)
 			break;
 		case XS_CODE_CONST_CLOSURE_2:
 		case XS_CODE_CONST_LOCAL_2:
+		case XS_CODE_DECREMENT_LOCAL_2:
 		case XS_CODE_GET_CLOSURE_2:
 		case XS_CODE_GET_LOCAL_2:
+		case XS_CODE_GET_LOCAL_APPEND_2:
+		case XS_CODE_INCREMENT_LOCAL_2:
 		case XS_CODE_LET_CLOSURE_2:
 		case XS_CODE_LET_LOCAL_2:
 		case XS_CODE_PULL_CLOSURE_2:
@@ -607,8 +621,11 @@ txScript* fxParserCode(txParser* parser)
 
 		case XS_CODE_CONST_CLOSURE_1:
 		case XS_CODE_CONST_LOCAL_1:
+		case XS_CODE_DECREMENT_LOCAL_1:
 		case XS_CODE_GET_CLOSURE_1:
 		case XS_CODE_GET_LOCAL_1:
+		case XS_CODE_GET_LOCAL_APPEND_1:
+		case XS_CODE_INCREMENT_LOCAL_1:
 		case XS_CODE_LET_CLOSURE_1:
 		case XS_CODE_LET_LOCAL_1:
 		case XS_CODE_PULL_CLOSURE_1:
@@ -628,8 +645,11 @@ txScript* fxParserCode(txParser* parser)
 
 		case XS_CODE_CONST_CLOSURE_2:
 		case XS_CODE_CONST_LOCAL_2:
+		case XS_CODE_DECREMENT_LOCAL_2:
 		case XS_CODE_GET_CLOSURE_2:
 		case XS_CODE_GET_LOCAL_2:
+		case XS_CODE_GET_LOCAL_APPEND_2:
+		case XS_CODE_INCREMENT_LOCAL_2:
 		case XS_CODE_LET_CLOSURE_2:
 		case XS_CODE_LET_LOCAL_2:
 		case XS_CODE_PULL_CLOSURE_2:
@@ -776,10 +796,16 @@ txScript* fxParserCode(txParser* parser)
 		case XS_CODE_CONST_CLOSURE_2:
 		case XS_CODE_CONST_LOCAL_1:
 		case XS_CODE_CONST_LOCAL_2:
+		case XS_CODE_DECREMENT_LOCAL_1:
+		case XS_CODE_DECREMENT_LOCAL_2:
 		case XS_CODE_GET_CLOSURE_1:
 		case XS_CODE_GET_CLOSURE_2:
 		case XS_CODE_GET_LOCAL_1:
 		case XS_CODE_GET_LOCAL_2:
+		case XS_CODE_GET_LOCAL_APPEND_1:
+		case XS_CODE_GET_LOCAL_APPEND_2:
+		case XS_CODE_INCREMENT_LOCAL_1:
+		case XS_CODE_INCREMENT_LOCAL_2:
 		case XS_CODE_LET_CLOSURE_1:
 		case XS_CODE_LET_CLOSURE_2:
 		case XS_CODE_LET_LOCAL_1:
@@ -1135,6 +1161,164 @@ void fxCoderJumpTargets(txCoder* self, txTargetCode* target, txInteger selector,
 	*address = selection;
 }
 
+void fxCoderOptimize(txCoder* self)
+{
+	txByteCode* code;
+	txTargetCode* target;
+	txBoolean changed;
+	txInteger pass = 0;
+	txInteger position, label;
+	do {
+		txByteCode** address = &self->firstCode;
+		changed = 0;
+		code = self->firstCode;
+		position = 0;
+		while (code) {
+			if (code->id == XS_NO_CODE)
+				((txTargetCode*)code)->offset = position;
+			position++;
+			code = code->nextCode;
+		}
+		label = -1;
+		while ((code = *address)) {
+			txByteCode* next = code->nextCode;
+			txByteCode* third = next ? next->nextCode : C_NULL;
+			switch (code->id) {
+			case XS_NO_CODE:
+				label = ((txTargetCode*)code)->offset;
+				break;
+			case XS_CODE_INTEGER_1:
+				if (!next)
+					break;
+				if (next->id == XS_CODE_PLUS) {
+					code->nextCode = third;
+					changed = 1;
+					continue;
+				}
+				if ((next->id == XS_CODE_MINUS) && ((txIntegerCode*)code)->integer && (((txIntegerCode*)code)->integer != (txInteger)0x80000000)) {
+					((txIntegerCode*)code)->integer = 0 - ((txIntegerCode*)code)->integer;
+					code->nextCode = third;
+					changed = 1;
+					continue;
+				}
+				if ((next->id == XS_CODE_INTEGER_1) && third && fxCoderOptimizeIntegers((txIntegerCode*)code, (txIntegerCode*)next, third->id)) {
+					code->nextCode = third->nextCode;
+					changed = 1;
+					continue;
+				}
+				break;
+			case XS_CODE_SET_CLOSURE_1:
+			case XS_CODE_SET_LOCAL_1:
+				if (next && (next->id == XS_CODE_POP)) {
+					code->id = (code->id == XS_CODE_SET_LOCAL_1) ? XS_CODE_PULL_LOCAL_1 : XS_CODE_PULL_CLOSURE_1;
+					code->nextCode = third;
+					changed = 1;
+					continue;
+				}
+				break;
+			case XS_CODE_GET_LOCAL_1:
+				if (next && ((next->id == XS_CODE_INCREMENT) || (next->id == XS_CODE_DECREMENT)) && third && (third->id == XS_CODE_PULL_LOCAL_1) && (((txIndexCode*)third)->index == ((txIndexCode*)code)->index)) {
+					code->id = (next->id == XS_CODE_INCREMENT) ? XS_CODE_INCREMENT_LOCAL_1 : XS_CODE_DECREMENT_LOCAL_1;
+					code->nextCode = third->nextCode;
+					changed = 1;
+					continue;
+				}
+				break;
+			case XS_CODE_BRANCH_1:
+				((txBranchCode*)code)->target = fxCoderThreadTarget(((txBranchCode*)code)->target);
+				while (next && (next->id != XS_NO_CODE)) {
+					if ((next->id == XS_CODE_FILE) || (next->id == XS_CODE_LINE))
+						break;
+					next = code->nextCode = next->nextCode;
+					changed = 1;
+				}
+				while (next && (next->id == XS_NO_CODE)) {
+					if (next == (txByteCode*)((txBranchCode*)code)->target) {
+						*address = code->nextCode;
+						code = C_NULL;
+						changed = 1;
+						break;
+					}
+					next = next->nextCode;
+				}
+				if (!code)
+					continue;
+				break;
+			case XS_CODE_BRANCH_ELSE_1:
+			case XS_CODE_BRANCH_IF_1:
+				// conditional branches only jump forward
+				target = fxCoderThreadTarget(((txBranchCode*)code)->target);
+				if (target->offset > label)
+					((txBranchCode*)code)->target = target;
+				break;
+			}
+			address = &code->nextCode;
+		}
+		pass++;
+	} while (changed && (pass < 4));
+	code = self->firstCode;
+	self->lastCode = C_NULL;
+	while (code) {
+		self->lastCode = code;
+		code = code->nextCode;
+	}
+}
+
+txBoolean fxCoderOptimizeIntegers(txIntegerCode* a, txIntegerCode* b, txInteger id)
+{
+	txInteger x = a->integer, y = b->integer;
+	txNumber z;
+	switch (id) {
+	case XS_CODE_ADD:
+		z = (txNumber)x + (txNumber)y;
+		break;
+	case XS_CODE_SUBTRACT:
+		z = (txNumber)x - (txNumber)y;
+		break;
+	case XS_CODE_MULTIPLY:
+		z = (txNumber)x * (txNumber)y;
+		if ((z == 0) && ((x < 0) || (y < 0)))
+			return 0;
+		break;
+	case XS_CODE_BIT_AND:
+		z = x & y;
+		break;
+	case XS_CODE_BIT_OR:
+		z = x | y;
+		break;
+	case XS_CODE_BIT_XOR:
+		z = x ^ y;
+		break;
+	case XS_CODE_LEFT_SHIFT:
+		z = (txInteger)((txUnsigned)x << (y & 0x1F));
+		break;
+	case XS_CODE_SIGNED_RIGHT_SHIFT:
+		z = x >> (y & 0x1F);
+		break;
+	default:
+		return 0;
+	}
+	if ((z < -2147483648.0) || (z > 2147483647.0))
+		return 0;
+	a->integer = (txInteger)z;
+	return 1;
+}
+
+txTargetCode* fxCoderThreadTarget(txTargetCode* target)
+{
+	txInteger count = 0;
+	while (count < 8) {
+		txByteCode* code = target->nextCode;
+		while (code && (code->id == XS_NO_CODE))
+			code = code->nextCode;
+		if (!code || (code->id != XS_CODE_BRANCH_1))
+			break;
+		target = ((txBranchCode*)code)->target;
+		count++;
+	}
+	return target;
+}
+
 txInteger fxCoderUseTemporaryVariable(txCoder* self)
 {
 	txInteger result = self->scopeLevel++;
@@ -1479,8 +1663,10 @@ void fxAccessNodeCodeCompound(void* it, void* param, txAssignNode* compound)
 		fxCoderAddByte(param, 1, XS_CODE_DUB);
 		fxCoderAddSymbol(param, 0, XS_CODE_GET_VARIABLE, self->symbol);
 	}
+	else if (declaration->flags & mxDeclareNodeClosureFlag)
+		fxCoderAddIndex(param, 1, XS_CODE_GET_CLOSURE_1, declaration->index);
 	else
-		fxCoderAddIndex(param, 1, (declaration->flags & mxDeclareNodeClosureFlag) ? XS_CODE_GET_CLOSURE_1 : XS_CODE_GET_LOCAL_1, declaration->index);
+		fxCoderAddIndex(param, 1, (compound->description->code == XS_CODE_ADD) ? XS_CODE_GET_LOCAL_APPEND_1 : XS_CODE_GET_LOCAL_1, declaration->index);
 	fxNodeDispatchCode(compound->value, param);
 	fxCoderAddByte(param, -1, compound->description->code);
 	if (!declaration)
@@ -89,6 +89,8 @@ const txString gxCodeNames[XS_CODE_COUNT] = {
 	/* XS_CODE_CURRENT */ "current",
 	/* XS_CODE_DEBUGGER */ "debugger",
 	/* XS_CODE_DECREMENT */ "decrement",
+	/* XS_CODE_DECREMENT_LOCAL_1 */ "decrement_local",
+	/* XS_CODE_DECREMENT_LOCAL_2 */ "decrement_local_2",
 	/* XS_CODE_DELETE_PROPERTY */ "delete_property",
 	/* XS_CODE_DELETE_PROPERTY_AT */ "delete_property_at",
 	/* XS_CODE_DELETE_SUPER */ "delete_super",
@@ -118,6 +120,8 @@ const txString gxCodeNames[XS_CODE_COUNT] = {
 	/* XS_CODE_GET_CLOSURE_2 */ "get_closure_2",
 	/* XS_CODE_GET_LOCAL_1 */ "get_local",
 	/* XS_CODE_GET_LOCAL_2 */ "get_local_2",
+	/* XS_CODE_GET_LOCAL_APPEND_1 */ "get_local_append",
+	/* XS_CODE_GET_LOCAL_APPEND_2 */ "get_local_append_2",
 	/* XS_CODE_GET_PROPERTY */ "get_property",
 	/* XS_CODE_GET_PROPERTY_AT */ "get_property_at",
 	/* XS_CODE_GET_SUPER */ "get_super",
@@ -128,6 +132,8 @@ const txString gxCodeNames[XS_CODE_COUNT] = {
 	/* XS_CODE_HOST */ "host",
 	/* XS_CODE_IN */ "in",
 	/* XS_CODE_INCREMENT */ "increment",
+	/* XS_CODE_INCREMENT_LOCAL_1 */ "increment_local",
+	/* XS_CODE_INCREMENT_LOCAL_2 */ "increment_local_2",
 	/* XS_CODE_INSTANCEOF */ "instanceof",
 	/* XS_CODE_INSTANTIATE */ "instantiate",
 	/* XS_CODE_INTEGER_1 */ "integer",
@@ -284,6 +290,8 @@ const txS1 gxCodeSizes[XS_CODE_COUNT] ICACHE_FLASH_ATTR = {
 	1 /* XS_CODE_CURRENT */,
 	1 /* XS_CODE_DEBUGGER */,
 	1 /* XS_CODE_DECREMENT */,
+	2 /* XS_CODE_DECREMENT_LOCAL_1 */,
+	3 /* XS_CODE_DECREMENT_LOCAL_2 */,
 	0 /* XS_CODE_DELETE_PROPERTY */,
 	1 /* XS_CODE_DELETE_PROPERTY_AT */,
 	0 /* XS_CODE_DELETE_SUPER */,
@@ -313,6 +321,8 @@ const txS1 gxCodeSizes[XS_CODE_COUNT] ICACHE_FLASH_ATTR = {
 	3 /* XS_CODE_GET_CLOSURE_2 */,
 	2 /* XS_CODE_GET_LOCAL_1 */,
 	3 /* XS_CODE_GET_LOCAL_2 */,
+	2 /* XS_CODE_GET_LOCAL_APPEND_1 */,
+	3 /* XS_CODE_GET_LOCAL_APPEND_2 */,
 	0 /* XS_CODE_GET_PROPERTY */,
 	1 /* XS_CODE_GET_PROPERTY_AT */,
 	0 /* XS_CODE_GET_SUPER */,
@@ -323,6 +333,8 @@ const txS1 gxCodeSizes[XS_CODE_COUNT] ICACHE_FLASH_ATTR = {
 	3 /* XS_CODE_HOST */,
 	1 /* XS_CODE_IN */,
 	1 /* XS_CODE_INCREMENT */,
+	2 /* XS_CODE_INCREMENT_LOCAL_1 */,
+	3 /* XS_CODE_INCREMENT_LOCAL_2 */,
 	1 /* XS_CODE_INSTANCEOF */,
 	1 /* XS_CODE_INSTANTIATE */,
 	2 /* XS_CODE_INTEGER_1 */,
@@ -84,7 +84,7 @@ typedef int (*txPutter)(txString, void*);
 #define XS_ATOM_VERSION 0x56455253 /* 'VERS' */
 #define XS_MAJOR_VERSION 8
 #define XS_MINOR_VERSION 2
-#define XS_PATCH_VERSION 0
+#define XS_PATCH_VERSION 2
 
 #define XS_DIGEST_SIZE 16
 #define XS_VERSION_SIZE 4
@@ -173,6 +173,8 @@ enum {
 	XS_CODE_CURRENT,
 	XS_CODE_DEBUGGER,
 	XS_CODE_DECREMENT,
+	XS_CODE_DECREMENT_LOCAL_1,
+	XS_CODE_DECREMENT_LOCAL_2,
 	XS_CODE_DELETE_PROPERTY,
 	XS_CODE_DELETE_PROPERTY_AT,
 	XS_CODE_DELETE_SUPER,
@@ -202,6 +204,8 @@ enum {
 	XS_CODE_GET_CLOSURE_2,
 	XS_CODE_GET_LOCAL_1,
 	XS_CODE_GET_LOCAL_2,
+	XS_CODE_GET_LOCAL_APPEND_1,
+	XS_CODE_GET_LOCAL_APPEND_2,
 	XS_CODE_GET_PROPERTY,
 	XS_CODE_GET_PROPERTY_AT,
 	XS_CODE_GET_SUPER,
@@ -212,6 +216,8 @@ enum {
 	XS_CODE_HOST,
 	XS_CODE_IN,
 	XS_CODE_INCREMENT,
+	XS_CODE_INCREMENT_LOCAL_1,
+	XS_CODE_INCREMENT_LOCAL_2,
 	XS_CODE_INSTANCEOF,
 	XS_CODE_INSTANTIATE,
 	XS_CODE_INTEGER_1,
@@ -435,6 +441,7 @@ enum {
 	XS_REGEXP_S = 1 << 4,
 	XS_REGEXP_U = 1 << 5,
 	XS_REGEXP_Y = 1 << 6,
+	XS_REGEXP_AUTOMATON = 1 << 7,
 };
 mxExport txBoolean fxCompileRegExp(void* the, txString pattern, txString modifier, txInteger** code, txInteger** data, txString errorBuffer, txInteger errorSize);
 mxExport void fxDeleteRegExp(void* the, txInteger* code, txInteger* data);
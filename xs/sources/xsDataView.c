@@ -100,9 +100,9 @@ void fxArrayBuffer(txMachine* the, txSlot* slot, void* data, txInteger byteLengt
 	mxPush(mxArrayBufferPrototype);
 	instance = fxNewArrayBufferInstance(the);
 	arrayBuffer = instance->next;
+	arrayBuffer->value.arrayBuffer.address = fxNewChunk(the, byteLength);		// empty but not detached
+	arrayBuffer->value.arrayBuffer.length = byteLength;
 	if (byteLength) {
-		arrayBuffer->value.arrayBuffer.address = fxNewChunk(the, byteLength);
-		arrayBuffer->value.arrayBuffer.length = byteLength;
 		if (data != NULL)
 			c_memcpy(arrayBuffer->value.arrayBuffer.address, data, byteLength);
 		else
@@ -1800,7 +1800,7 @@ void fxVReportWarning(void* console, txString thePath, txInteger theLine, txStri
 }
 
 #ifdef mxInstrument	
-#define xsInstrumentCount 9
+#define xsInstrumentCount 18
 static char* xsInstrumentNames[xsInstrumentCount] ICACHE_XS6STRING_ATTR = {
 	"Chunk used",
 	"Chunk available",
@@ -1809,8 +1809,17 @@ static char* xsInstrumentNames[xsInstrumentCount] ICACHE_XS6STRING_ATTR = {
 	"Stack used",
 	"Stack available",
 	"Garbage collections",
+	"Slot collections",
+	"Chunk collections",
+	"Slot collection pauses",
+	"Chunk collection pauses",
+	"Compactions avoided",
 	"Keys used",
 	"Modules loaded",
+	"Property cache hits",
+	"Property cache misses",
+	"RegExp cache hits",
+	"RegExp cache misses",
 };
 static char* xsInstrumentUnits[xsInstrumentCount] ICACHE_XS6STRING_ATTR = {
 	" / ",
@@ -1820,8 +1829,17 @@ static char* xsInstrumentUnits[xsInstrumentCount] ICACHE_XS6STRING_ATTR = {
 	" / ",
 	" bytes",
 	" times",
+	" times",
+	" times",
+	" ms",
+	" ms",
+	" times",
 	" keys",
 	" modules",
+	" hits",
+	" misses",
+	" hits",
+	" misses",
 };
 
 void fxDescribeInstrumentation(txMachine* the, txInteger count, txString* names, txString* units)
@@ -1873,8 +1891,17 @@ void fxSampleInstrumentation(txMachine* the, txInteger count, txInteger* values)
 	xsInstrumentValues[4] = (the->stackTop - the->stackPeak) * sizeof(txSlot);
 	xsInstrumentValues[5] = (the->stackTop - the->stackBottom) * sizeof(txSlot);
 	xsInstrumentValues[6] = the->garbageCollectionCount;
-	xsInstrumentValues[7] = the->keyIndex - the->keyOffset;
-	xsInstrumentValues[8] = the->loadedModulesCount;
+	xsInstrumentValues[7] = the->slotCollectionCount;
+	xsInstrumentValues[8] = the->chunkCollectionCount;
+	xsInstrumentValues[9] = (txInteger)(the->slotCollectionTime / 1000);
+	xsInstrumentValues[10] = (txInteger)(the->chunkCollectionTime / 1000);
+	xsInstrumentValues[11] = the->avoidedCompactionCount;
+	xsInstrumentValues[12] = the->keyIndex - the->keyOffset;
+	xsInstrumentValues[13] = the->loadedModulesCount;
+	xsInstrumentValues[14] = the->inlineCacheHitCount;
+	xsInstrumentValues[15] = the->inlineCacheMissCount;
+	xsInstrumentValues[16] = the->regExpCacheHitCount;
+	xsInstrumentValues[17] = the->regExpCacheMissCount;
 
 	txInteger i;
 #ifdef mxDebug
@@ -76,6 +76,60 @@ typedef struct {
 	txSlot* stack;
 } txJSONStringifier;
 
+enum {
+	XS_JSON_STREAM_VALUE,
+	XS_JSON_STREAM_VALUE_OR_END,
+	XS_JSON_STREAM_NAME,
+	XS_JSON_STREAM_NAME_OR_END,
+	XS_JSON_STREAM_COLON,
+	XS_JSON_STREAM_COMMA_OR_END,
+	XS_JSON_STREAM_DONE,
+	XS_JSON_STREAM_BROKEN,
+};
+
+enum {
+	XS_JSON_STREAM_SPACE,
+	XS_JSON_STREAM_STRING,
+	XS_JSON_STREAM_ESCAPE,
+	XS_JSON_STREAM_UNICODE,
+	XS_JSON_STREAM_NUMBER,
+	XS_JSON_STREAM_LITERAL,
+};
+
+typedef struct {
+	txSlot container;
+	txSlot* item;
+	txIndex length;
+	txID id;
+	txIndex index;
+	txBoolean array;
+	txBoolean keyed;
+	txBoolean skip;
+} txJSONStreamFrame;
+
+typedef struct {
+	txSlot callback;
+	txSlot keys;
+	txSlot result;
+	txJSONStreamFrame* frames;
+	txInteger frameCount;
+	txInteger frameSize;
+	txInteger depth;
+	txInteger state;
+	txString buffer;
+	txSize bufferOffset;
+	txSize bufferSize;
+	txInteger lexer;
+	txString literal;
+	txInteger count;
+	txInteger character;
+	txInteger surrogate;
+	txBoolean cr;
+	txInteger integer;
+	txNumber number;
+	txInteger line;
+} txJSONStream;
+
 static void fxParseJSON(txMachine* the, txJSONParser* theParser);
 static void fxParseJSONArray(txMachine* the, txJSONParser* theParser);
 static void fxParseJSONObject(txMachine* the, txJSONParser* theParser);
@@ -83,6 +137,23 @@ static void fxParseJSONToken(txMachine* the, txJSONParser* theParser);
 static void fxParseJSONValue(txMachine* the, txJSONParser* theParser);
 static void fxReviveJSON(txMachine* the, txSlot* reviver, txSlot* holder);
 
+static void fxJSONStreamAppend(txMachine* the, txJSONStream* stream, txU1* bytes, txSize size);
+static void fxJSONStreamCharacter(txMachine* the, txJSONStream* stream, txInteger character);
+static void fxJSONStreamMarker(txMachine* the, void* it, txMarkRoot markRoot);
+static void fxJSONStreamName(txMachine* the, txJSONStream* stream, txJSONStreamFrame* frame);
+static txInteger fxJSONStreamNumber(txMachine* the, txJSONStream* stream);
+static void fxJSONStreamPop(txMachine* the, txJSONStream* stream);
+static void fxJSONStreamPush(txMachine* the, txJSONStream* stream, txBoolean array);
+static void fxJSONStreamToken(txMachine* the, txJSONStream* stream, txInteger token);
+static void fxJSONStreamValue(txMachine* the, txJSONStream* stream, txBoolean built);
+static void fxJSONStreamWrite(txMachine* the, txJSONStream* stream, txSlot* data, txSize size);
+
+static txHostHooks gxJSONStreamHooks = {
+	fx_JSONParser_destructor,
+	fxJSONStreamMarker,
+	C_NULL
+};
+
 static void fxStringifyJSON(txMachine* the, txJSONStringifier* theStringifier);
 static void fxStringifyJSONChar(txMachine* the, txJSONStringifier* theStringifier, char c);
 static void fxStringifyJSONChars(txMachine* the, txJSONStringifier* theStringifier, char* s);
@@ -625,6 +696,608 @@ void fxReviveJSON(txMachine* the, txSlot* reviver, txSlot* holder)
 	fxCall(the);
 }
 
+void fx_JSONParser(txMachine* the)
+{
+	txJSONStream* stream = c_calloc(1, sizeof(txJSONStream));
+	if (NULL == stream)
+		mxUnknownError("out of memory");
+	stream->line = 1;
+	fxSetHostData(the, mxThis, stream);
+	fxSetHostHooks(the, mxThis, &gxJSONStreamHooks);
+	if ((mxArgc > 0) && mxIsReference(mxArgv(0))) {
+		mxPushSlot(mxArgv(0));
+		fxGetID(the, mxID(_keys));
+		if (mxIsReference(the->stack) && fxIsArray(the, the->stack->value.reference)) {
+			fxToJSONKeys(the, the->stack);
+			mxPullSlot(&stream->keys);
+		}
+		mxPop();
+		mxPushSlot(mxArgv(0));
+		fxGetID(the, fxID(the, "onValue"));
+		if (mxIsReference(the->stack) && mxIsCallable(the->stack->value.reference))
+			mxPullSlot(&stream->callback);
+		else
+			mxPop();
+		mxPushSlot(mxArgv(0));
+		fxGetID(the, fxID(the, "depth"));
+		if (!mxIsUndefined(the->stack))
+			stream->depth = fxToInteger(the, the->stack);
+		mxPop();
+	}
+}
+
+void fx_JSONParser_destructor(void* it)
+{
+	txJSONStream* stream = it;
+	if (stream) {
+		if (stream->frames)
+			c_free(stream->frames);
+		if (stream->buffer)
+			c_free(stream->buffer);
+		c_free(stream);
+	}
+}
+
+void fx_JSONParser_prototype_close(txMachine* the)
+{
+	txJSONStream* stream = fxGetHostData(the, mxThis);
+	if (!stream)
+		mxTypeError("this is no JSON parser");
+	if (stream->state == XS_JSON_STREAM_BROKEN)
+		mxSyntaxError("%ld: broken JSON", stream->line);
+	mxTry(the) {
+		if (stream->lexer == XS_JSON_STREAM_NUMBER) {
+			fxJSONStreamAppend(the, stream, (txU1*)"", 1);
+			stream->lexer = XS_JSON_STREAM_SPACE;
+			fxJSONStreamToken(the, stream, fxJSONStreamNumber(the, stream));
+		}
+		if (stream->lexer != XS_JSON_STREAM_SPACE)
+			mxSyntaxError("%ld: invalid character", stream->line);
+		if (stream->frameCount > 0) {
+			if (stream->frames[stream->frameCount - 1].array)
+				mxSyntaxError("%ld: missing ]", stream->line);
+			mxSyntaxError("%ld: missing }", stream->line);
+		}
+		if ((stream->state == XS_JSON_STREAM_VALUE) && (stream->callback.kind == XS_UNDEFINED_KIND))
+			mxSyntaxError("%ld: invalid value", stream->line);
+	}
+	mxCatch(the) {
+		stream->state = XS_JSON_STREAM_BROKEN;
+		stream->frameCount = 0;
+		fxJump(the);
+	}
+	mxResult->kind = stream->result.kind;
+	mxResult->value = stream->result.value;
+	stream->result.kind = XS_UNDEFINED_KIND;
+	stream->state = XS_JSON_STREAM_VALUE;
+	stream->line = 1;
+	stream->cr = 0;
+}
+
+void fx_JSONParser_prototype_push(txMachine* the)
+{
+	txJSONStream* stream = fxGetHostData(the, mxThis);
+	txSlot* data;
+	txSize size;
+	if (!stream)
+		mxTypeError("this is no JSON parser");
+	if (stream->state == XS_JSON_STREAM_BROKEN)
+		mxSyntaxError("%ld: broken JSON", stream->line);
+	if (mxArgc < 1)
+		mxSyntaxError("no buffer");
+	data = mxArgv(0);
+	if (mxIsReference(data) && data->value.reference->next && (data->value.reference->next->kind == XS_ARRAY_BUFFER_KIND)) {
+		data = data->value.reference->next;
+		size = data->value.arrayBuffer.length;
+	}
+	else {
+		fxToString(the, data);
+		size = c_strlen(data->value.string);
+	}
+	mxTry(the) {
+		fxJSONStreamWrite(the, stream, data, size);
+	}
+	mxCatch(the) {
+		stream->state = XS_JSON_STREAM_BROKEN;
+		stream->frameCount = 0;
+		fxJump(the);
+	}
+}
+
+void fxJSONStreamAppend(txMachine* the, txJSONStream* stream, txU1* bytes, txSize size)
+{
+	txSize offset = stream->bufferOffset + size;
+	if (offset > stream->bufferSize) {
+		txSize bufferSize = stream->bufferSize ? stream->bufferSize : 256;
+		txString buffer;
+		while (bufferSize < offset)
+			bufferSize *= 2;
+		buffer = c_realloc(stream->buffer, bufferSize);
+		if (NULL == buffer)
+			mxUnknownError("out of memory");
+		stream->buffer = buffer;
+		stream->bufferSize = bufferSize;
+	}
+	c_memcpy(stream->buffer + stream->bufferOffset, bytes, size);
+	stream->bufferOffset = offset;
+}
+
+void fxJSONStreamCharacter(txMachine* the, txJSONStream* stream, txInteger character)
+{
+	char buffer[8];
+	txString p;
+	if (stream->surrogate) {
+		if ((0x0000DC00 <= character) && (character <= 0x0000DFFF)) {
+			character = 0x00010000 + ((stream->surrogate & 0x03FF) << 10) + (character & 0x03FF);
+			stream->surrogate = 0;
+			p = fxUTF8Encode(buffer, character);
+			fxJSONStreamAppend(the, stream, (txU1*)buffer, p - buffer);
+			return;
+		}
+		p = fxUTF8Encode(buffer, stream->surrogate);
+		fxJSONStreamAppend(the, stream, (txU1*)buffer, p - buffer);
+		stream->surrogate = 0;
+	}
+	if ((0x0000D800 <= character) && (character <= 0x0000DBFF))
+		stream->surrogate = character;
+	else if (character >= 0) {
+		p = fxUTF8Encode(buffer, character);
+		fxJSONStreamAppend(the, stream, (txU1*)buffer, p - buffer);
+	}
+}
+
+void fxJSONStreamMarker(txMachine* the, void* it, txMarkRoot markRoot)
+{
+	txJSONStream* stream = it;
+	txInteger index;
+	(*markRoot)(the, &stream->callback);
+	(*markRoot)(the, &stream->keys);
+	(*markRoot)(the, &stream->result);
+	for (index = 0; index < stream->frameCount; index++)
+		(*markRoot)(the, &stream->frames[index].container);
+}
+
+void fxJSONStreamName(txMachine* the, txJSONStream* stream, txJSONStreamFrame* frame)
+{
+	txIndex index = XS_NO_ID;
+	txID id;
+	frame->keyed = 0;
+	if (frame->skip)
+		return;
+	if (fxStringToIndex(the->dtoa, stream->buffer, &index))
+		id = 0;
+	else if (stream->keys.kind == XS_UNDEFINED_KIND)
+		id = fxNewNameC(the, stream->buffer);
+	else {
+		id = fxFindName(the, stream->buffer);
+		if (!id)
+			return;
+	}
+	if (stream->keys.kind != XS_UNDEFINED_KIND) {
+		txSlot* item = stream->keys.value.reference->next;
+		while (item) {
+			if ((item->value.at.id == id) && (item->value.at.index == index))
+				break;
+			item = item->next;
+		}
+		if (!item)
+			return;
+	}
+	frame->id = id;
+	frame->index = index;
+	frame->keyed = 1;
+}
+
+txInteger fxJSONStreamNumber(txMachine* the, txJSONStream* stream)
+{
+	txString p = stream->buffer;
+	txNumber number;
+	if (*p == '-')
+		p++;
+	if (('0' <= *p) && (*p <= '9')) {
+		if (*p == '0') {
+			p++;
+		}
+		else {
+			p++;
+			while (('0' <= *p) && (*p <= '9'))
+				p++;
+		}
+		if (*p == '.') {
+			p++;
+			if (('0' <= *p) && (*p <= '9')) {
+				p++;
+				while (('0' <= *p) && (*p <= '9'))
+					p++;
+			}
+			else
+				goto error;
+		}
+		if ((*p == 'e') || (*p == 'E')) {
+			p++;
+			if ((*p == '+') || (*p == '-'))
+				p++;
+			if (('0' <= *p) && (*p <= '9')) {
+				p++;
+				while (('0' <= *p) && (*p <= '9'))
+					p++;
+			}
+			else
+				goto error;
+		}
+	}
+	if (*p)
+		goto error;
+	stream->number = fxStringToNumber(the->dtoa, stream->buffer, 0);
+	stream->integer = (txInteger)stream->number;
+	number = stream->integer;
+	if (stream->number == number)
+		return XS_JSON_TOKEN_INTEGER;
+	return XS_JSON_TOKEN_NUMBER;
+error:
+	mxSyntaxError("%ld: invalid character", stream->line);
+	return XS_NO_JSON_TOKEN;
+}
+
+void fxJSONStreamPop(txMachine* the, txJSONStream* stream)
+{
+	txJSONStreamFrame* frame = stream->frames + stream->frameCount - 1;
+	txBoolean built = !frame->skip;
+	if (built) {
+		txSlot* instance = frame->container.value.reference;
+		if (frame->array) {
+			instance->next->value.array.length = frame->length;
+			fxCacheArray(the, instance);
+		}
+		mxPushSlot(&frame->container);
+	}
+	stream->frameCount--;
+	fxJSONStreamValue(the, stream, built);
+}
+
+void fxJSONStreamPush(txMachine* the, txJSONStream* stream, txBoolean array)
+{
+	txJSONStreamFrame* frame = (stream->frameCount > 0) ? stream->frames + stream->frameCount - 1 : C_NULL;
+	txBoolean skip = (frame && (frame->skip || (!frame->array && !frame->keyed))) ? 1 : 0;
+	if (stream->frameCount == stream->frameSize) {
+		txInteger frameSize = stream->frameSize ? 2 * stream->frameSize : 8;
+		txJSONStreamFrame* frames = c_realloc(stream->frames, frameSize * sizeof(txJSONStreamFrame));
+		if (NULL == frames)
+			mxUnknownError("out of memory");
+		stream->frames = frames;
+		stream->frameSize = frameSize;
+	}
+	frame = stream->frames + stream->frameCount;
+	c_memset(frame, 0, sizeof(txJSONStreamFrame));
+	frame->array = array;
+	frame->skip = skip;
+	stream->frameCount++;
+	if (!skip) {
+		if (array) {
+			mxPush(mxArrayPrototype);
+			frame->item = fxNewArrayInstance(the)->next;
+		}
+		else {
+			mxPush(mxObjectPrototype);
+			fxNewObjectInstance(the);
+		}
+		mxPullSlot(&frame->container);
+	}
+	stream->state = array ? XS_JSON_STREAM_VALUE_OR_END : XS_JSON_STREAM_NAME_OR_END;
+}
+
+void fxJSONStreamToken(txMachine* the, txJSONStream* stream, txInteger token)
+{
+	txJSONStreamFrame* frame = (stream->frameCount > 0) ? stream->frames + stream->frameCount - 1 : C_NULL;
+	txBoolean skip;
+	switch (stream->state) {
+	case XS_JSON_STREAM_NAME_OR_END:
+	case XS_JSON_STREAM_NAME:
+		if ((stream->state == XS_JSON_STREAM_NAME_OR_END) && (token == XS_JSON_TOKEN_RIGHT_BRACE)) {
+			fxJSONStreamPop(the, stream);
+			break;
+		}
+		if (token != XS_JSON_TOKEN_STRING)
+			mxSyntaxError("%ld: missing name", stream->line);
+		fxJSONStreamName(the, stream, frame);
+		stream->state = XS_JSON_STREAM_COLON;
+		break;
+	case XS_JSON_STREAM_COLON:
+		if (token != XS_JSON_TOKEN_COLON)
+			mxSyntaxError("%ld: missing :", stream->line);
+		stream->state = XS_JSON_STREAM_VALUE;
+		break;
+	case XS_JSON_STREAM_COMMA_OR_END:
+		if (token == XS_JSON_TOKEN_COMMA)
+			stream->state = frame->array ? XS_JSON_STREAM_VALUE : XS_JSON_STREAM_NAME;
+		else if (frame->array) {
+			if (token != XS_JSON_TOKEN_RIGHT_BRACKET)
+				mxSyntaxError("%ld: missing ]", stream->line);
+			fxJSONStreamPop(the, stream);
+		}
+		else {
+			if (token != XS_JSON_TOKEN_RIGHT_BRACE)
+				mxSyntaxError("%ld: missing }", stream->line);
+			fxJSONStreamPop(the, stream);
+		}
+		break;
+	case XS_JSON_STREAM_DONE:
+		mxSyntaxError("%ld: missing EOF", stream->line);
+		break;
+	case XS_JSON_STREAM_VALUE_OR_END:
+	case XS_JSON_STREAM_VALUE:
+		if ((stream->state == XS_JSON_STREAM_VALUE_OR_END) && (token == XS_JSON_TOKEN_RIGHT_BRACKET)) {
+			fxJSONStreamPop(the, stream);
+			break;
+		}
+		skip = (frame && (frame->skip || (!frame->array && !frame->keyed))) ? 1 : 0;
+		switch (token) {
+		case XS_JSON_TOKEN_LEFT_BRACE:
+			fxJSONStreamPush(the, stream, 0);
+			return;
+		case XS_JSON_TOKEN_LEFT_BRACKET:
+			fxJSONStreamPush(the, stream, 1);
+			return;
+		case XS_JSON_TOKEN_FALSE:
+			if (!skip) mxPushBoolean(0);
+			break;
+		case XS_JSON_TOKEN_TRUE:
+			if (!skip) mxPushBoolean(1);
+			break;
+		case XS_JSON_TOKEN_NULL:
+			if (!skip) mxPushNull();
+			break;
+		case XS_JSON_TOKEN_INTEGER:
+			if (!skip) mxPushInteger(stream->integer);
+			break;
+		case XS_JSON_TOKEN_NUMBER:
+			if (!skip) mxPushNumber(stream->number);
+			break;
+		case XS_JSON_TOKEN_STRING:
+			if (!skip) mxPushStringC(stream->buffer);
+			break;
+		default:
+			mxSyntaxError("%ld: invalid value", stream->line);
+			break;
+		}
+		fxJSONStreamValue(the, stream, !skip);
+		break;
+	}
+}
+
+void fxJSONStreamValue(txMachine* the, txJSONStream* stream, txBoolean built)
+{
+	txJSONStreamFrame* frame = (stream->frameCount > 0) ? stream->frames + stream->frameCount - 1 : C_NULL;
+	if (built) {
+		if ((stream->callback.kind != XS_UNDEFINED_KIND) && (stream->frameCount == stream->depth)) {
+			mxPushUndefined();
+			if (frame)
+				fxKeyAt(the, frame->array ? 0 : frame->id, frame->index, the->stack);
+			mxPushInteger(2);
+			mxPushSlot(mxThis);
+			mxPushSlot(&stream->callback);
+			fxCall(the);
+			mxPop();
+			frame = (stream->frameCount > 0) ? stream->frames + stream->frameCount - 1 : C_NULL;
+		}
+		else if (!frame)
+			mxPullSlot(&stream->result);
+		else if (frame->array) {
+			txSlot* item = frame->item->next = fxNewSlot(the);
+			item->kind = the->stack->kind;
+			item->value = the->stack->value;
+			the->stack++;
+			frame->item = item;
+			frame->length++;
+		}
+		else {
+			txSlot* property = mxBehaviorSetProperty(the, frame->container.value.reference, frame->id, frame->index, XS_OWN);
+			property->kind = the->stack->kind;
+			property->value = the->stack->value;
+			the->stack++;
+		}
+	}
+	if (frame) {
+		if (frame->array)
+			frame->index++;
+		stream->state = XS_JSON_STREAM_COMMA_OR_END;
+	}
+	else if (stream->callback.kind == XS_UNDEFINED_KIND)
+		stream->state = XS_JSON_STREAM_DONE;
+	else
+		stream->state = XS_JSON_STREAM_VALUE;
+}
+
+void fxJSONStreamWrite(txMachine* the, txJSONStream* stream, txSlot* data, txSize size)
+{
+	txSize offset = 0;
+	while (offset < size) {
+		txU1* bytes = (data->kind == XS_ARRAY_BUFFER_KIND) ? (txU1*)data->value.arrayBuffer.address : (txU1*)data->value.string;
+		txU1* p = bytes + offset;
+		txU1* q = bytes + size;
+		txU1* s;
+		txU1 c = *p;
+		txBoolean cr;
+		txInteger token = XS_NO_JSON_TOKEN;
+		switch (stream->lexer) {
+		case XS_JSON_STREAM_SPACE:
+			p++;
+			cr = stream->cr;
+			stream->cr = (c == 13) ? 1 : 0;
+			switch (c) {
+			case 10:
+				if (!cr)
+					stream->line++;
+				break;
+			case 13:
+				stream->line++;
+				break;
+			case '\t':
+			case ' ':
+				break;
+			case '-':
+			case '0':
+			case '1':
+			case '2':
+			case '3':
+			case '4':
+			case '5':
+			case '6':
+			case '7':
+			case '8':
+			case '9':
+				p--;
+				stream->bufferOffset = 0;
+				stream->lexer = XS_JSON_STREAM_NUMBER;
+				break;
+			case ',':
+				token = XS_JSON_TOKEN_COMMA;
+				break;
+			case ':':
+				token = XS_JSON_TOKEN_COLON;
+				break;
+			case '[':
+				token = XS_JSON_TOKEN_LEFT_BRACKET;
+				break;
+			case ']':
+				token = XS_JSON_TOKEN_RIGHT_BRACKET;
+				break;
+			case '{':
+				token = XS_JSON_TOKEN_LEFT_BRACE;
+				break;
+			case '}':
+				token = XS_JSON_TOKEN_RIGHT_BRACE;
+				break;
+			case '"':
+				stream->bufferOffset = 0;
+				stream->lexer = XS_JSON_STREAM_STRING;
+				break;
+			case 'f':
+				stream->literal = "false";
+				stream->count = 1;
+				stream->lexer = XS_JSON_STREAM_LITERAL;
+				break;
+			case 'n':
+				stream->literal = "null";
+				stream->count = 1;
+				stream->lexer = XS_JSON_STREAM_LITERAL;
+				break;
+			case 't':
+				stream->literal = "true";
+				stream->count = 1;
+				stream->lexer = XS_JSON_STREAM_LITERAL;
+				break;
+			default:
+				mxSyntaxError("%ld: invalid character", stream->line);
+				break;
+			}
+			break;
+		case XS_JSON_STREAM_STRING:
+			s = p;
+			while ((p < q) && (*p != '"') && (*p != '\\') && (*p >= 32))
+				p++;
+			if (p > s) {
+				fxJSONStreamCharacter(the, stream, -1);
+				fxJSONStreamAppend(the, stream, s, p - s);
+			}
+			if (p == q)
+				break;
+			c = *p++;
+			if (c == '"') {
+				fxJSONStreamCharacter(the, stream, -1);
+				fxJSONStreamAppend(the, stream, (txU1*)"", 1);
+				stream->lexer = XS_JSON_STREAM_SPACE;
+				token = XS_JSON_TOKEN_STRING;
+			}
+			else if (c == '\\')
+				stream->lexer = XS_JSON_STREAM_ESCAPE;
+			else
+				mxSyntaxError("%ld: invalid character", stream->line);
+			break;
+		case XS_JSON_STREAM_ESCAPE:
+			p++;
+			stream->lexer = XS_JSON_STREAM_STRING;
+			switch (c) {
+			case '"':
+			case '/':
+			case '\\':
+				fxJSONStreamCharacter(the, stream, c);
+				break;
+			case 'b':
+				fxJSONStreamCharacter(the, stream, '\b');
+				break;
+			case 'f':
+				fxJSONStreamCharacter(the, stream, '\f');
+				break;
+			case 'n':
+				fxJSONStreamCharacter(the, stream, '\n');
+				break;
+			case 'r':
+				fxJSONStreamCharacter(the, stream, '\r');
+				break;
+			case 't':
+				fxJSONStreamCharacter(the, stream, '\t');
+				break;
+			case 'u':
+				stream->character = 0;
+				stream->count = 0;
+				stream->lexer = XS_JSON_STREAM_UNICODE;
+				break;
+			default:
+				mxSyntaxError("%ld: invalid character", stream->line);
+				break;
+			}
+			break;
+		case XS_JSON_STREAM_UNICODE:
+			p++;
+			if (('0' <= c) && (c <= '9'))
+				stream->character = (stream->character << 4) | (c - '0');
+			else if (('a' <= c) && (c <= 'f'))
+				stream->character = (stream->character << 4) | (c - 'a' + 10);
+			else if (('A' <= c) && (c <= 'F'))
+				stream->character = (stream->character << 4) | (c - 'A' + 10);
+			else
+				mxSyntaxError("%ld: invalid character", stream->line);
+			stream->count++;
+			if (stream->count == 4) {
+				fxJSONStreamCharacter(the, stream, stream->character);
+				stream->lexer = XS_JSON_STREAM_STRING;
+			}
+			break;
+		case XS_JSON_STREAM_NUMBER:
+			s = p;
+			while ((p < q) && ((('0' <= *p) && (*p <= '9')) || (*p == '-') || (*p == '+') || (*p == '.') || (*p == 'e') || (*p == 'E')))
+				p++;
+			if (p > s)
+				fxJSONStreamAppend(the, stream, s, p - s);
+			if (p < q) {
+				fxJSONStreamAppend(the, stream, (txU1*)"", 1);
+				stream->lexer = XS_JSON_STREAM_SPACE;
+				token = fxJSONStreamNumber(the, stream);
+			}
+			break;
+		case XS_JSON_STREAM_LITERAL:
+			p++;
+			if (c != (txU1)stream->literal[stream->count])
+				mxSyntaxError("%ld: invalid character", stream->line);
+			stream->count++;
+			if (stream->literal[stream->count] == 0) {
+				stream->lexer = XS_JSON_STREAM_SPACE;
+				if (stream->literal[0] == 'f')
+					token = XS_JSON_TOKEN_FALSE;
+				else if (stream->literal[0] == 'n')
+					token = XS_JSON_TOKEN_NULL;
+				else
+					token = XS_JSON_TOKEN_TRUE;
+			}
+			break;
+		}
+		offset = p - bytes;
+		if (token != XS_NO_JSON_TOKEN)
+			fxJSONStreamToken(the, stream, token);
+	}
+}
+
 void fx_JSON_stringify(txMachine* the)
 {
 	volatile txJSONStringifier aStringifier;
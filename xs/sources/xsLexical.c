@@ -109,13 +109,18 @@ static txString fxUTF8Buffer(txParser* parser, txInteger character, txString str
 	return fxUTF8Encode(string, character);
 } 
 
+#define mxGetNextByte(PARSER) \
+	(((PARSER)->source) \
+		? (((PARSER)->source->offset < (PARSER)->source->size) ? (txU1)((PARSER)->source->buffer[(PARSER)->source->offset++]) : C_EOF) \
+		: (*((PARSER)->getter))((PARSER)->stream))
+
 void fxGetNextCharacter(txParser* parser)
 {
 	txU4 aResult;
 	txUTF8Sequence const *aSequence = NULL;
 	txInteger aSize;
 
-	aResult = (txU4)(*(parser->getter))(parser->stream);
+	aResult = (txU4)mxGetNextByte(parser);
 	if (aResult & 0x80) {  // According to UTF-8, aResult should be 1xxx xxxx when it is not a ASCII
 		if (aResult != (txU4)C_EOF) {
 			for (aSequence = gxUTF8Sequences; aSequence->size; aSequence++) {
@@ -130,7 +135,7 @@ void fxGetNextCharacter(txParser* parser)
 				aSize = aSequence->size - 1;
 				while (aSize) {
 					aSize--;
-					aResult = (aResult << 6) | ((*(parser->getter))(parser->stream) & 0x3F);
+					aResult = (aResult << 6) | (mxGetNextByte(parser) & 0x3F);
 				}
 				aResult &= aSequence->lmask;
 			}
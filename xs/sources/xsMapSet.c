@@ -40,6 +40,12 @@
 #ifndef mxMapSetLength
 	#define mxMapSetLength (127)
 #endif
+#ifndef mxMapSetGrow
+	#define mxMapSetGrow 1
+#endif
+
+/* Map and Set tables keep the number of entries after the buckets */
+#define mxMapSetCount(TABLE) (*((txSize*)&((TABLE)->value.table.address[(TABLE)->value.table.length])))
 
 static txSlot* fxCheckMapInstance(txMachine* the, txSlot* slot);
 static txSlot* fxCheckMapKey(txMachine* the);
@@ -58,6 +64,9 @@ static txInteger fxCountEntries(txMachine* the, txSlot* list, txBoolean paired);
 static txBoolean fxDeleteEntry(txMachine* the, txSlot* table, txSlot* list, txSlot* slot, txBoolean paired); 
 static txSlot* fxGetEntry(txMachine* the, txSlot* table, txSlot* slot);
 static txSlot* fxNewEntryIteratorInstance(txMachine* the, txSlot* iterable);
+static txSlot** fxNewEntryTable(txMachine* the, txSize length);
+static void fxResizeEntries(txMachine* the, txSlot* table, txSize length);
+static void fxSizeEntries(txMachine* the, txSlot* table, txSlot* iterable);
 //static void fxPurgeEntries(txMachine* the, txSlot* list);
 static void fxSetEntry(txMachine* the, txSlot* table, txSlot* list, txSlot* slot, txSlot* pair); 
 static txU4 fxSumEntry(txMachine* the, txSlot* slot); 
@@ -198,8 +207,7 @@ txSlot* fxNewMapInstance(txMachine* the)
 	the->stack->value.reference = map;
 	table = map->next = fxNewSlot(the);
 	list = table->next = fxNewSlot(the);
-	address = (txSlot**)fxNewChunk(the, mxMapSetLength * sizeof(txSlot*));
-	c_memset(address, 0, mxMapSetLength * sizeof(txSlot*));
+	address = fxNewEntryTable(the, mxMapSetLength);
 	/* TABLE */
 	table->flag = XS_INTERNAL_FLAG | XS_DONT_DELETE_FLAG | XS_DONT_ENUM_FLAG | XS_DONT_SET_FLAG;
 	table->kind = XS_MAP_KIND;
@@ -227,6 +235,7 @@ void fx_Map(txMachine* the)
 	iterable = mxArgv(0);
 	if ((iterable->kind == XS_UNDEFINED_KIND) || (iterable->kind == XS_NULL_KIND))
 		return;
+	fxSizeEntries(the, mxResult->value.reference->next, iterable);
 	mxGetID(mxResult, mxID(_set));	
 	function = the->stack;	
 	if (!fxIsCallable(the, function))	
@@ -500,8 +509,7 @@ txSlot* fxNewSetInstance(txMachine* the)
 	the->stack->value.reference = set;
 	table = set->next = fxNewSlot(the);
 	list = table->next = fxNewSlot(the);
-	address = (txSlot**)fxNewChunk(the, mxMapSetLength * sizeof(txSlot*));
-	c_memset(address, 0, mxMapSetLength * sizeof(txSlot*));
+	address = fxNewEntryTable(the, mxMapSetLength);
 	/* TABLE */
 	table->flag = XS_INTERNAL_FLAG | XS_DONT_DELETE_FLAG | XS_DONT_ENUM_FLAG | XS_DONT_SET_FLAG;
 	table->kind = XS_SET_KIND;
@@ -529,6 +537,7 @@ void fx_Set(txMachine* the)
 	iterable = mxArgv(0);
 	if ((iterable->kind == XS_UNDEFINED_KIND) || (iterable->kind == XS_NULL_KIND))
 		return;
+	fxSizeEntries(the, mxResult->value.reference->next, iterable);
 	mxGetID(mxResult, mxID(_add));	
 	function = the->stack;	
 	if (!fxIsCallable(the, function))	
@@ -971,6 +980,13 @@ void fxClearEntries(txMachine* the, txSlot* table, txSlot* list, txBoolean paire
 		slot = slot->next;
 	}
 	c_memset(table->value.table.address, 0, table->value.table.length * sizeof(txSlot*));
+#if mxMapSetGrow
+	if (list) {
+		mxMapSetCount(table) = 0;
+		if (table->value.table.length > mxMapSetLength)
+			fxResizeEntries(the, table, mxMapSetLength);
+	}
+#endif
 }
 
 txInteger fxCountEntries(txMachine* the, txSlot* list, txBoolean paired) 
@@ -1009,6 +1025,14 @@ txBoolean fxDeleteEntry(txMachine* the, txSlot* table, txSlot* list, txSlot* slo
 				}
 				*address = entry->next;
 				entry->next = C_NULL;
+			#if mxMapSetGrow
+				if (list) {
+					txSize count = --mxMapSetCount(table);
+					txSize length = table->value.table.length;
+					if ((length > mxMapSetLength) && (count < (length >> 2)))
+						fxResizeEntries(the, table, length >> 1);
+				}
+			#endif
 				return 1;
 			}
 		}
@@ -1053,6 +1077,13 @@ txSlot* fxNewEntryIteratorInstance(txMachine* the, txSlot* iterable)
 	return instance;
 }
 
+txSlot** fxNewEntryTable(txMachine* the, txSize length)
+{
+	txSlot** address = (txSlot**)fxNewChunk(the, (length + 1) * sizeof(txSlot*));
+	c_memset(address, 0, (length + 1) * sizeof(txSlot*));
+	return address;
+}
+
 #if 0
 void fxPurgeEntries(txMachine* the, txSlot* list) 
 {
@@ -1072,6 +1103,62 @@ void fxPurgeEntries(txMachine* the, txSlot* list)
 }
 #endif
 
+void fxRehashEntries(txMachine* the, txSlot* table)
+{
+	/* objects are hashed by address, so tables are rehashed when slots move */
+	txSlot** address = table->value.table.address;
+	txSize modulo = table->value.table.length;
+	txSlot* entries = C_NULL;
+	txSlot* entry;
+	while (modulo) {
+		entry = *address;
+		while (entry) {
+			txSlot* next = entry->next;
+			entry->next = entries;
+			entries = entry;
+			entry = next;
+		}
+		*address = C_NULL;
+		address++;
+		modulo--;
+	}
+	address = table->value.table.address;
+	modulo = table->value.table.length;
+	while ((entry = entries)) {
+		txSlot* key = entry->value.entry.slot;
+		txSlot** bucket;
+		entries = entry->next;
+		if (key->kind == XS_REFERENCE_KIND)
+			entry->value.entry.sum = fxSumEntry(the, key);
+		bucket = &(address[entry->value.entry.sum % modulo]);
+		entry->next = *bucket;
+		*bucket = entry;
+	}
+}
+
+void fxResizeEntries(txMachine* the, txSlot* table, txSize length)
+{
+	txSlot** address = fxNewEntryTable(the, length);
+	txSlot** former = table->value.table.address;
+	txSize modulo = table->value.table.length;
+	txSize count = mxMapSetCount(table);
+	while (modulo) {
+		txSlot* entry = *former;
+		while (entry) {
+			txSlot* next = entry->next;
+			txSlot** bucket = &(address[entry->value.entry.sum % length]);
+			entry->next = *bucket;
+			*bucket = entry;
+			entry = next;
+		}
+		former++;
+		modulo--;
+	}
+	table->value.table.address = address;
+	table->value.table.length = length;
+	mxMapSetCount(table) = count;
+}
+
 void fxSetEntry(txMachine* the, txSlot* table, txSlot* list, txSlot* slot, txSlot* pair) 
 {
 	txU4 sum = fxSumEntry(the, slot);
@@ -1120,6 +1207,34 @@ void fxSetEntry(txMachine* the, txSlot* table, txSlot* list, txSlot* slot, txSlo
 	if (pair)
 		mxPop();
 	mxPop();
+#if mxMapSetGrow
+	if (list) {
+		txSize count = ++mxMapSetCount(table);
+		txSize length = table->value.table.length;
+		if ((count > length) && (length < 0x3FFFFFFF))
+			fxResizeEntries(the, table, (length << 1) + 1);
+	}
+#endif
+}
+
+void fxSizeEntries(txMachine* the, txSlot* table, txSlot* iterable)
+{
+#if mxMapSetGrow
+	txSize count = 0;
+	txSize length = table->value.table.length;
+	if (iterable->kind == XS_REFERENCE_KIND) {
+		txSlot* slot = iterable->value.reference->next;
+		if (slot && (slot->kind == XS_ARRAY_KIND) && (slot->ID == XS_ARRAY_BEHAVIOR))
+			count = (txSize)fxGetIndexSize(the, slot);
+		else if (slot && (slot->flag & XS_INTERNAL_FLAG) && ((slot->kind == XS_MAP_KIND) || (slot->kind == XS_SET_KIND)))
+			count = mxMapSetCount(slot);
+	}
+	if (count <= length)
+		return;
+	while ((length < count) && (length < 0x3FFFFFFF))
+		length = (length << 1) + 1;
+	fxResizeEntries(the, table, length);
+#endif
 }
 
 txU4 fxSumEntry(txMachine* the, txSlot* slot) 
@@ -1128,12 +1243,12 @@ txU4 fxSumEntry(txMachine* the, txSlot* slot)
 	txU4 sum, size;
 	
 	kind = slot->kind;
-	sum = 0;
+	sum = 2166136261U;
 	if ((XS_STRING_KIND == kind) || (XS_STRING_X_KIND == kind)) {
 		address = (txU1*)slot->value.string;
 		while ((kind = c_read8(address++)))
-			sum = (sum << 1) + kind;
-		sum = (sum << 1) + XS_STRING_KIND;
+			sum = (sum ^ kind) * 16777619U;
+		sum = (sum ^ XS_STRING_KIND) * 16777619U;
 	}
 	else {
 		if (XS_BOOLEAN_KIND == kind) {
@@ -1165,11 +1280,12 @@ txU4 fxSumEntry(txMachine* the, txSlot* slot)
 			size = 0;
 		}
 		while (size) {
-			sum = (sum << 1) + *address++;
+			sum = (sum ^ *address++) * 16777619U;
 			size--;
 		}
-		sum = (sum << 1) + kind;
+		sum = (sum ^ kind) * 16777619U;
 	}
+	sum ^= sum >> 15;
 	sum &= 0x7FFFFFFF;
 	return sum;
 }
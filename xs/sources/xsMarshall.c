@@ -38,6 +38,8 @@
 #include "xsAll.h"
 
 typedef struct sxMarshallBuffer txMarshallBuffer; 
+typedef struct sxMarshallTransfer txMarshallTransfer; 
+
 struct sxMarshallBuffer {
 	txByte* base;
 	txByte* current;
@@ -47,14 +49,31 @@ struct sxMarshallBuffer {
 	txID symbolCount;
 	txIndex symbolSize;
 	txBoolean shared;
+	txMarshallTransfer* transfer;
+	txSize transferCount;
+	txSize copied;
+};
+
+/*
+	Transferred array buffers are not copied into the buffer but listed after it, up to a null entry.
+	Once the buffer is complete, their marshalled slots refer to blocks that hold their chunks.
+	The receiving machine attaches the blocks, else fxFreeMarshall frees them.
+*/
+
+struct sxMarshallTransfer {
+	txSlot* slot;
+	txByte* data;
 };
 
 static void fxDemarshallChunk(txMachine* the, void* theData, void** theDataAddress);
 static void fxDemarshallSlot(txMachine* the, txSlot* theSlot, txSlot* theResult, txID* theSymbolMap, txBoolean alien);
+static void* fxMarshallBuffer(txMachine* the, txSlot* theTransfer, txBoolean alien, txSize* copied);
 static void fxMarshallChunk(txMachine* the, void* theData, void** theDataAddress, txMarshallBuffer* theBuffer);
 static void fxMarshallSlot(txMachine* the, txSlot* theSlot, txSlot** theSlotAddress, txMarshallBuffer* theBuffer, txBoolean alien);
 static void fxMeasureChunk(txMachine* the, void* theData, txMarshallBuffer* theBuffer);
 static void fxMeasureSlot(txMachine* the, txSlot* theSlot, txMarshallBuffer* theBuffer, txBoolean alien);
+static void fxTransferChunks(txMachine* the, txMarshallBuffer* theBuffer);
+static void fxTransferList(txMachine* the, txSlot* theTransfer, txBoolean mark);
 
 #define mxMarshallAlign(POINTER,SIZE) \
 	if (((SIZE) &= ((sizeof(txNumber) - 1)))) (POINTER) += sizeof(txNumber) - (SIZE)
@@ -102,8 +121,14 @@ void fxDemarshall(txMachine* the, void* theData, txBoolean alien)
 			aSlot = (txSlot*)p;
 			p += sizeof(txSlot);
 			switch (aSlot->kind) {
-			case XS_STRING_KIND:
 			case XS_ARRAY_BUFFER_KIND:
+				if ((aSlot->flag & XS_MARK_FLAG) || !aSlot->value.arrayBuffer.address)
+					break;
+				aChunk = (txChunk*)p;
+				p += aChunk->size;
+				mxMarshallAlign(p, aChunk->size);
+				break;
+			case XS_STRING_KIND:
 				aChunk = (txChunk*)p;
 				p += aChunk->size;
 				mxMarshallAlign(p, aChunk->size);
@@ -145,7 +170,7 @@ void fxDemarshallSlot(txMachine* the, txSlot* theSlot, txSlot* theResult, txID*
 			anID = theSymbolMap[anIndex - the->keyOffset];
 	}
 	theResult->ID = anID;
-	theResult->flag = theSlot->flag;
+	theResult->flag = theSlot->flag & ~XS_MARK_FLAG;
 	switch (theSlot->kind) {
 	case XS_UNDEFINED_KIND:
 	case XS_NULL_KIND:
@@ -164,11 +189,21 @@ void fxDemarshallSlot(txMachine* the, txSlot* theSlot, txSlot* theResult, txID*
 		}
 		break;
 	case XS_ARRAY_BUFFER_KIND: 
-		if (theSlot->value.arrayBuffer.address) {
+		theResult->value.arrayBuffer.address = C_NULL;
+		theResult->value.arrayBuffer.length = 0;
+		theResult->kind = theSlot->kind;
+		if (theSlot->flag & XS_MARK_FLAG) {
+			txBlock* aBlock = (txBlock*)theSlot->value.arrayBuffer.address;
+			if (aBlock) {
+				theResult->value.arrayBuffer.address = (txByte*)fxAttachChunk(the, aBlock);
+				theResult->value.arrayBuffer.length = theSlot->value.arrayBuffer.length;
+				theSlot->value.arrayBuffer.address = C_NULL;
+			}
+		}
+		else if (theSlot->value.arrayBuffer.address) {
 			txByte **s = &theResult->value.arrayBuffer.address;
 			fxDemarshallChunk(the, theSlot->value.arrayBuffer.address, (void **)s);
             theResult->value.arrayBuffer.length = theSlot->value.arrayBuffer.length;
-            theResult->kind = theSlot->kind;
 		}
 		break;
 	case XS_HOST_KIND:
@@ -243,14 +278,40 @@ void fxDemarshallSlot(txMachine* the, txSlot* theSlot, txSlot* theResult, txID*
 	}
 }
 
+void fxFreeMarshall(void* theData)
+{
+	txMarshallTransfer* transfer;
+	if (!theData)
+		return;
+	transfer = (txMarshallTransfer*)(((txByte*)theData) + *((txSize*)theData));
+	while (transfer->slot) {
+		if (transfer->slot->value.arrayBuffer.address)
+			c_free(transfer->slot->value.arrayBuffer.address);
+		transfer++;
+	}
+	c_free(theData);
+}
+
 void* fxMarshall(txMachine* the, txBoolean alien)
 {
-	txMarshallBuffer aBuffer = { C_NULL, C_NULL, C_NULL, C_NULL, 0, 0, 0 };
+	return fxMarshallBuffer(the, C_NULL, alien, C_NULL);
+}
+
+void* fxMarshallBuffer(txMachine* the, txSlot* theTransfer, txBoolean alien, txSize* copied)
+{
+	txMarshallBuffer aBuffer = { C_NULL, C_NULL, C_NULL, C_NULL, 0, 0, 0, 0, C_NULL, 0, 0 };
 	txSlot* aSlot;
 	txSlot* bSlot;
 	txSlot* cSlot;
+	txFlag aFlag;
+	txBoolean failed = 0;
+	txInteger skipped;
 	
+	aFlag = (txFlag)the->collectFlag;
+	the->collectFlag &= ~(XS_COLLECTING_FLAG | XS_SKIPPED_COLLECT_FLAG);
 	mxTry(the) {
+		if (theTransfer)
+			fxTransferList(the, theTransfer, 1);
 		aBuffer.symbolSize = sizeof(txSize) + sizeof(txID);
 		if (alien) {
 			aBuffer.symbolMap = c_calloc(the->keyIndex, sizeof(txID));
@@ -261,7 +322,7 @@ void* fxMarshall(txMachine* the, txBoolean alien)
 		fxMeasureSlot(the, the->stack, &aBuffer, alien);
 		aBuffer.size += aBuffer.symbolSize;
 		mxMarshallAlign(aBuffer.size, aBuffer.symbolSize);
-		aBuffer.base = aBuffer.current = (txByte *)c_malloc(aBuffer.size);
+		aBuffer.base = aBuffer.current = (txByte *)c_malloc(aBuffer.size + ((aBuffer.transferCount + 1) * sizeof(txMarshallTransfer)));
 		if (!aBuffer.base)
 			mxRangeError("marshall: cannot allocate buffer");
 		*((txSize*)(aBuffer.current)) = aBuffer.size;
@@ -325,7 +386,10 @@ void* fxMarshall(txMachine* the, txBoolean alien)
 		}
 		mxMarshallAlign(aBuffer.current, aBuffer.symbolSize);
 		
+		aBuffer.transfer = (txMarshallTransfer*)(aBuffer.base + aBuffer.size);
 		fxMarshallSlot(the, the->stack, &aSlot, &aBuffer, alien);
+		aBuffer.transfer->slot = C_NULL;
+		aBuffer.transfer->data = C_NULL;
 		aSlot = aBuffer.link;
 		while (aSlot) {
 			bSlot = aSlot->value.instance.garbage;
@@ -335,6 +399,12 @@ void* fxMarshall(txMachine* the, txBoolean alien)
 		}
 		
 		mxCheck(the, aBuffer.current == aBuffer.base + aBuffer.size);
+		
+		fxTransferChunks(the, &aBuffer);
+		if (theTransfer)
+			fxTransferList(the, theTransfer, 0);
+		if (copied)
+			*copied = aBuffer.copied;
 	}
 	mxCatch(the) {
 		aSlot = the->firstHeap;
@@ -351,6 +421,7 @@ void* fxMarshall(txMachine* the, txBoolean alien)
 			c_free(aBuffer.base);
 			aBuffer.base = C_NULL;
 		}
+		failed = 1;
 		break;
 	}
 	if (!alien && aBuffer.symbolCount) {
@@ -369,6 +440,12 @@ void* fxMarshall(txMachine* the, txBoolean alien)
 	}
 	the->stack++;
 	c_free(aBuffer.symbolMap);
+	skipped = the->collectFlag & XS_SKIPPED_COLLECT_FLAG;
+	the->collectFlag = aFlag;
+	if (failed && theTransfer)
+		fxJump(the);
+	if (skipped)
+		fxCollectGarbage(the);
 	return aBuffer.base;
 }
 
@@ -382,6 +459,7 @@ void fxMarshallChunk(txMachine* the, void* theData, void** theDataAddress, txMar
 	aChunk = (txChunk*)aResult;
 	aChunk->size &= 0x7FFFFFFF;
 	*theDataAddress = aResult + sizeof(txChunk);
+	theBuffer->copied += (aSize - sizeof(txChunk)) << 1; // marshall and demarshall
 	mxMarshallAlign(theBuffer->current, aSize);
 }
 
@@ -395,7 +473,11 @@ void fxMarshallSlot(txMachine* the, txSlot* theSlot, txSlot** theSlotAddress, tx
 	aResult = (txSlot*)(theBuffer->current);
 	theBuffer->current += sizeof(txSlot);
 	anID = theSlot->ID;
-	if (anID < XS_NO_ID) {
+	if (theSlot->kind == XS_INSTANCE_KIND) {
+		if (anID < XS_NO_ID)
+			anID = XS_NO_ID;
+	}
+	else if (anID < XS_NO_ID) {
 		txID anIndex = anID & 0x7FFF;
 		if (alien) {
             anID = theBuffer->symbolMap[anIndex];
@@ -425,7 +507,13 @@ void fxMarshallSlot(txMachine* the, txSlot* theSlot, txSlot** theSlotAddress, tx
 		}
 		break;
 	case XS_ARRAY_BUFFER_KIND: 
-		if (theSlot->value.arrayBuffer.address) {
+		if (theSlot->flag & XS_MARK_FLAG) {
+			theSlot->flag &= ~XS_MARK_FLAG;
+			theBuffer->transfer->slot = aResult;
+			theBuffer->transfer->data = theSlot->value.arrayBuffer.address;
+			theBuffer->transfer++;
+		}
+		else if (theSlot->value.arrayBuffer.address) {
 			txByte **s = &aResult->value.arrayBuffer.address;
 			fxMarshallChunk(the, theSlot->value.arrayBuffer.address, (void **)s, theBuffer);
 		}
@@ -483,6 +571,13 @@ void fxMarshallSlot(txMachine* the, txSlot* theSlot, txSlot** theSlotAddress, tx
 	}
 }
 
+void* fxMarshallTransfer(txMachine* the, txBoolean alien, txSize* copied)
+{
+	void* result = fxMarshallBuffer(the, the->stack + 1, alien, copied);
+	the->stack++;
+	return result;
+}
+
 void fxMeasureChunk(txMachine* the, void* theData, txMarshallBuffer* theBuffer)
 {
 	txChunk* aChunk = ((txChunk*)(((txByte*)theData) - sizeof(txChunk)));
@@ -498,7 +593,7 @@ void fxMeasureSlot(txMachine* the, txSlot* theSlot, txMarshallBuffer* theBuffer,
 	txIndex aLength;
 
 	anID = theSlot->ID;
-	if (anID < XS_NO_ID) {
+	if ((anID < XS_NO_ID) && (theSlot->kind != XS_INSTANCE_KIND)) {
 		txID anIndex = anID & 0x7FFF;
 		if (alien) {
 			if (!theBuffer->symbolMap[anIndex]) {
@@ -547,7 +642,9 @@ void fxMeasureSlot(txMachine* the, txSlot* theSlot, txMarshallBuffer* theBuffer,
 		fxMeasureChunk(the, theSlot->value.string, theBuffer);
 		break;
 	case XS_ARRAY_BUFFER_KIND: 
-		if (theSlot->value.arrayBuffer.address)
+		if (theSlot->flag & XS_MARK_FLAG)
+			theBuffer->transferCount++;
+		else if (theSlot->value.arrayBuffer.address)
 			fxMeasureChunk(the, theSlot->value.arrayBuffer.address, theBuffer);
 		break;
 	case XS_HOST_KIND: 
@@ -597,3 +694,77 @@ void fxMeasureSlot(txMachine* the, txSlot* theSlot, txMarshallBuffer* theBuffer,
 	}
 }
 
+void fxTransferChunks(txMachine* the, txMarshallBuffer* theBuffer)
+{
+	txMarshallTransfer* first = (txMarshallTransfer*)(theBuffer->base + theBuffer->size);
+	txMarshallTransfer* transfer = first;
+	txBlock* aBlock;
+	txChunk* aChunk;
+	txSize aSize;
+	while (transfer < theBuffer->transfer) {
+		aBlock = fxDetachChunk(the, transfer->data);
+		if (!aBlock) {
+			aChunk = (txChunk*)(transfer->data - sizeof(txChunk));
+			aSize = aChunk->size & 0x7FFFFFFF;
+			aBlock = (txBlock*)c_malloc(sizeof(txBlock) + aSize);
+			if (!aBlock) {
+				while (transfer > first) {
+					transfer--;
+					aBlock = (txBlock*)transfer->slot->value.arrayBuffer.address;
+					if (((txByte*)aBlock) + sizeof(txBlock) + sizeof(txChunk) == transfer->data)
+						fxAttachChunk(the, aBlock);
+					else
+						c_free(aBlock);
+					transfer->slot->value.arrayBuffer.address = C_NULL;
+				}
+				mxRangeError("marshall: cannot allocate buffer");
+			}
+			aBlock->nextBlock = C_NULL;
+			aBlock->current = aBlock->limit = ((txByte*)aBlock) + sizeof(txBlock) + aSize;
+			aBlock->temporary = C_NULL;
+			c_memcpy(((txByte*)aBlock) + sizeof(txBlock), aChunk, aSize);
+			aChunk = (txChunk*)(((txByte*)aBlock) + sizeof(txBlock));
+			aChunk->size = aSize;
+			aChunk->temporary = C_NULL;
+		#if mxTransferChunks
+			theBuffer->copied += aSize - sizeof(txChunk);
+		#else
+			theBuffer->copied += (aSize - sizeof(txChunk)) << 1; // marshall and attach
+		#endif
+		}
+		transfer->slot->value.arrayBuffer.address = (txByte*)aBlock;
+		transfer++;
+	}
+}
+
+void fxTransferList(txMachine* the, txSlot* theTransfer, txBoolean mark)
+{
+	txSlot* array;
+	txSlot* item;
+	txSlot* limit;
+	txSlot* slot;
+	if (theTransfer->kind == XS_UNDEFINED_KIND)
+		return;
+	if ((theTransfer->kind != XS_REFERENCE_KIND) || !(array = theTransfer->value.reference->next) || (array->kind != XS_ARRAY_KIND))
+		mxTypeError("marshall: transfer is no array");
+	item = array->value.array.address;
+	limit = item + fxGetIndexSize(the, array);
+	while (item < limit) {
+		if ((item->kind != XS_REFERENCE_KIND) || !(slot = item->value.reference->next) || !(slot->flag & XS_INTERNAL_FLAG) || (slot->kind != XS_ARRAY_BUFFER_KIND))
+			mxTypeError("marshall: transfer no ArrayBuffer");
+		if (mark) {
+			if (slot->flag & XS_MARK_FLAG)
+				mxTypeError("marshall: transfer twice");
+			if (!slot->value.arrayBuffer.address)
+				mxTypeError("marshall: transfer detached ArrayBuffer");
+			slot->flag |= XS_MARK_FLAG;
+		}
+		else if (slot->flag & XS_MARK_FLAG)
+			slot->flag &= ~XS_MARK_FLAG; // not in the message
+		else {
+			slot->value.arrayBuffer.address = C_NULL;
+			slot->value.arrayBuffer.length = 0;
+		}
+		item++;
+	}
+}
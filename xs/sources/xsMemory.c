@@ -53,10 +53,16 @@ int gxStress = 0;
 
 #define mxChunkFlag 0x80000000
 
+#if mxTransferChunks
+/* Chunks larger than the incremental size get a block of their own, so they can move to another machine without copy. The last block is the initial one. */
+#define mxIsLargeBlock(BLOCK) (((BLOCK)->nextBlock != C_NULL) && (((BLOCK)->limit - ((txByte*)(BLOCK)) - (txSize)sizeof(txBlock)) > the->minimumChunksSize))
+#endif
+
 //#define mxRoundSize(_SIZE) ((_SIZE + (sizeof(txChunk) - 1)) & ~(sizeof(txChunk) - 1))
 #define mxRoundSize(_SIZE) ((_SIZE + (sizeof(txSize) - 1)) & ~(sizeof(txSize) - 1))
 
 static void fxGrowChunks(txMachine* the, txSize theSize); 
+static txBoolean fxTryGrowChunks(txMachine* the, txSize theSize); 
 static void fxGrowSlots(txMachine* the, txSize theCount); 
 static void fxMark(txMachine* the, void (*theMarker)(txMachine*, txSlot*));
 static void fxMarkInstance(txMachine* the, txSlot* theCurrent, void (*theMarker)(txMachine*, txSlot*));
@@ -65,6 +71,27 @@ static void fxMarkValue(txMachine* the, txSlot* theSlot);
 static void fxMarkWeakMapTable(txMachine* the, txSlot* table, void (*theMarker)(txMachine*, txSlot*));
 static void fxMarkWeakSetTable(txMachine* the, txSlot* table);
 static void fxMarkWeakTables(txMachine* the, void (*theMarker)(txMachine*, txSlot*));
+#if mxSnapshot
+typedef struct sxRelocation txRelocation;
+typedef struct sxRelocationRange txRelocationRange;
+struct sxRelocationRange {
+	txByte* begin;
+	txByte* end;
+	txByte* target;
+	txInteger* map;
+};
+struct sxRelocation {
+	txByte* begin;
+	txByte* end;
+	txInteger count;
+	txRelocationRange* ranges;
+};
+static void* fxRelocate(txRelocation* relocation, void* address);
+static int fxRelocateCompare(const void* p, const void* q);
+static void fxRelocateSlot(txRelocation* relocation, txSlot* slot);
+static void fxRelocateTable(txRelocation* relocation, txSlot** address, txSize length);
+#endif
+static void fxShareKind(txSlot* theSlot);
 static void fxSweep(txMachine* the);
 static void fxSweepValue(txMachine* the, txSlot* theSlot);
 
@@ -183,9 +210,40 @@ void fxAllocate(txMachine* the, txCreation* theCreation)
 	if (!the->symbolTable)
 		fxJump(the);
 
+#if mxInlineCache
+	the->inlineCaches = (txInlineCache *)c_calloc(mxInlineCacheCount, sizeof(txInlineCache));
+	if (!the->inlineCaches)
+		fxJump(the);
+	the->inlineCacheEpoch = 1;
+#endif
+
 	the->cRoot = C_NULL;
 }
 
+void* fxAttachChunk(txMachine* the, txBlock* theBlock)
+{
+	txChunk* aChunk = (txChunk*)(((txByte*)theBlock) + sizeof(txBlock));
+#if mxTransferChunks
+	if (the->maximumChunksSize - the->currentChunksSize < aChunk->size)
+		fxCollect(the, 1); // as if the chunk had been allocated here
+	theBlock->nextBlock = the->firstBlock;
+	theBlock->temporary = C_NULL;
+	theBlock->transferred = 1;
+	the->firstBlock = theBlock;
+	the->currentChunksSize += aChunk->size;
+	if (the->peakChunksSize < the->currentChunksSize)
+		the->peakChunksSize = the->currentChunksSize;
+	the->maximumChunksSize += theBlock->limit - (txByte*)theBlock;
+	return ((txByte*)aChunk) + sizeof(txChunk);
+#else
+	txSize aSize = aChunk->size - sizeof(txChunk);
+	txByte* aResult = (txByte*)fxNewChunk(the, aSize);
+	c_memcpy(aResult, ((txByte*)aChunk) + sizeof(txChunk), aSize);
+	c_free(theBlock);
+	return aResult;
+#endif
+}
+
 void fxCollect(txMachine* the, txBoolean theFlag)
 {
 	txSize aCount;
@@ -193,11 +251,21 @@ void fxCollect(txMachine* the, txBoolean theFlag)
 	txSlot* aSlot;
 	txSlot* bSlot;
 	txSlot* cSlot;
+	c_timeval tv0, tv1;
+	txInteger pause;
 
 	if ((the->collectFlag & XS_COLLECTING_FLAG) == 0) {
 		the->collectFlag |= XS_SKIPPED_COLLECT_FLAG;
 		return;
 	}
+	c_gettimeofday(&tv0, C_NULL);
+
+	mxInlineCacheFlush(the);
+#if mxJobPool
+	// pooled job records are not roots, the collector frees them
+	the->freeJobs = C_NULL;
+	the->freeJobCount = 0;
+#endif
 
 #ifdef mxProfile
 	fxBeginGC(the);
@@ -209,6 +277,12 @@ void fxCollect(txMachine* the, txBoolean theFlag)
 		fxMark(the, fxMarkValue);
 		fxMarkWeakTables(the, fxMarkValue);
 		fxSweep(the);
+	#if mxStringAppend
+		the->appendSlot = C_NULL;
+		the->appendStack = C_NULL;
+		the->appendString = C_NULL;
+	#endif
+		fxFlushStringIndexCache(the, C_NULL);
 	}
 	else {
 		fxMark(the, fxMarkReference);
@@ -276,18 +350,52 @@ void fxCollect(txMachine* the, txBoolean theFlag)
 			else
 				the->collectFlag &= ~XS_TRASHING_FLAG;
 	}
+	else {
+		// if compacting did not recover an increment, the next chunk allocation that fails grows instead of compacting again
+		if ((the->maximumChunksSize - the->currentChunksSize) < the->minimumChunksSize)
+			the->collectFlag |= XS_CHUNK_TRASHING_FLAG;
+		else
+			the->collectFlag &= ~XS_CHUNK_TRASHING_FLAG;
+	}
 	
 #if mxReport
-	if (theFlag)
+	if (theFlag) {
+		txBlock* aBlock = the->firstBlock;
+		txSize aFree = 0, aLargest = 0;
+		while (aBlock) {
+			txSize aSize = aBlock->limit - aBlock->current;
+			aFree += aSize;
+			if (aLargest < aSize)
+				aLargest = aSize;
+			aBlock = aBlock->nextBlock;
+		}
 		fxReport(the, "# Chunk collection: reserved %ld used %ld peak %ld bytes\n", 
 			(long)the->maximumChunksSize, (long)the->currentChunksSize, (long)the->peakChunksSize);
+		fxReport(the, "# Chunk fragmentation: free %ld largest %ld bytes, compactions avoided %ld\n", 
+			(long)aFree, (long)aLargest, (long)the->avoidedCompactionCount);
+	}
 	fxReport(the, "# Slot collection: reserved %ld used %ld peak %ld bytes %ld\n",
 		(long)(the->maximumHeapCount * sizeof(txSlot)),
 		(long)(the->currentHeapCount * sizeof(txSlot)),
 		(long)(the->peakHeapCount * sizeof(txSlot)),
 		the->collectFlag & XS_TRASHING_FLAG);
 #endif
+	/* slots only, chunks stay in place; or slots and chunks, chunks are compacted */
+	c_gettimeofday(&tv1, C_NULL);
+	pause = (txInteger)(((tv1.tv_sec - tv0.tv_sec) * 1000000) + (tv1.tv_usec - tv0.tv_usec));
+	if (theFlag)
+		the->chunkCollectionPause = pause;
+	else
+		the->slotCollectionPause = pause;
 #ifdef mxInstrument
+	if (theFlag) {
+		the->chunkCollectionCount++;
+		the->chunkCollectionTime += pause;
+	}
+	else {
+		the->slotCollectionCount++;
+		the->slotCollectionTime += pause;
+	}
 	the->garbageCollectionCount++;
 #endif
 #ifdef mxProfile
@@ -295,6 +403,26 @@ void fxCollect(txMachine* the, txBoolean theFlag)
 #endif
 }
 
+txBlock* fxDetachChunk(txMachine* the, void* theData)
+{
+#if mxTransferChunks
+	txByte* aData = ((txByte*)theData) - sizeof(txChunk);
+	txBlock** aBlockAddress = &(the->firstBlock);
+	txBlock* aBlock;
+	while ((aBlock = *aBlockAddress)) {
+		if ((((txByte*)aBlock) + sizeof(txBlock) == aData) && (aBlock->current == aData + ((txChunk*)aData)->size)) {
+			*aBlockAddress = aBlock->nextBlock;
+			aBlock->nextBlock = C_NULL;
+			the->currentChunksSize -= ((txChunk*)aData)->size;
+			the->maximumChunksSize -= aBlock->limit - (txByte*)aBlock;
+			return aBlock;
+		}
+		aBlockAddress = &(aBlock->nextBlock);
+	}
+#endif
+	return C_NULL;
+}
+
 txSlot* fxDuplicateSlot(txMachine* the, txSlot* theSlot)
 {
 	txSlot* result;
@@ -316,6 +444,22 @@ void fxFree(txMachine* the)
 		c_free_uint32(the->aliasArray);
 	the->aliasArray = C_NULL;
 
+#if mxInlineCache
+	if (the->inlineCaches)
+		c_free(the->inlineCaches);
+	the->inlineCaches = C_NULL;
+#endif
+#if mxShapes
+	if (the->shapeTable)
+		c_free(the->shapeTable);
+	the->shapeTable = C_NULL;
+	if (the->shapes)
+		c_free(the->shapes);
+	the->shapes = C_NULL;
+	the->shapeCount = 0;
+	the->shapeSize = 0;
+#endif
+
 	if (the->symbolTable)
 		c_free_uint32(the->symbolTable);
 	the->symbolTable = C_NULL;
@@ -369,6 +513,14 @@ void fxFree(txMachine* the)
 #endif
 
 void fxGrowChunks(txMachine* the, txSize theSize) 
+{
+	if (!fxTryGrowChunks(the, theSize)) {
+		fxReport(the, "# Chunk allocation: failed for %ld bytes\n", theSize);
+		fxJump(the);
+	}
+}
+
+txBoolean fxTryGrowChunks(txMachine* the, txSize theSize) 
 {
 	txByte* aData;
 	txBlock* aBlock;
@@ -377,11 +529,9 @@ void fxGrowChunks(txMachine* the, txSize theSize)
 		theSize = roundup(theSize, the->minimumChunksSize);
 	theSize += sizeof(txBlock);
 	aData = fxAllocateChunks(the, theSize);
-	if (!aData) {
-		fxReport(the, "# Chunk allocation: failed for %ld bytes\n", theSize);
-		fxJump(the);
-	}
-	if ((the->firstBlock != C_NULL) && (the->firstBlock->limit == aData)) {
+	if (!aData)
+		return 0;
+	if (!mxTransferChunks && (the->firstBlock != C_NULL) && (the->firstBlock->limit == aData)) {
 		the->firstBlock->limit += theSize;
 		aBlock = the->firstBlock;
 	}
@@ -391,6 +541,9 @@ void fxGrowChunks(txMachine* the, txSize theSize)
 		aBlock->current = aData + sizeof(txBlock);
 		aBlock->limit = aData + theSize;
 		aBlock->temporary = C_NULL;
+	#if mxTransferChunks
+		aBlock->transferred = 0;
+	#endif
 		the->firstBlock = aBlock;
 	}
 	the->maximumChunksSize += theSize;
@@ -398,6 +551,7 @@ void fxGrowChunks(txMachine* the, txSize theSize)
 	fxReport(the, "# Chunk allocation: reserved %ld used %ld peak %ld bytes\n", 
 		the->maximumChunksSize, the->currentChunksSize, the->peakChunksSize);
 #endif
+	return 1;
 }
 
 void fxGrowSlots(txMachine* the, txSize theCount) 
@@ -925,6 +1079,12 @@ void* fxNewChunk(txMachine* the, txSize theSize)
 again:
 	aBlock = the->firstBlock;
 	while (aBlock) {
+	#if mxTransferChunks
+		if (mxIsLargeBlock(aBlock) ? ((theSize <= the->minimumChunksSize) || (aBlock->current != ((txByte*)aBlock) + sizeof(txBlock))) : (theSize > the->minimumChunksSize)) {
+			aBlock = aBlock->nextBlock;
+			continue;
+		}
+	#endif
 		if ((aBlock->current + theSize) <= aBlock->limit) {
 			aData = aBlock->current;
 			((txChunk*)aData)->size = theSize;
@@ -938,7 +1098,12 @@ again:
 		aBlock = aBlock->nextBlock;
 	}
 	if (once) {
-		fxCollect(the, 1);
+		txBoolean wasTrashing = ((the->collectFlag & XS_CHUNK_TRASHING_FLAG) != 0);
+		the->collectFlag &= ~XS_CHUNK_TRASHING_FLAG;
+		if (wasTrashing && fxTryGrowChunks(the, theSize))
+			the->avoidedCompactionCount++;
+		else
+			fxCollect(the, 1);
 		once = 0;
 	}
 	else {
@@ -989,6 +1154,163 @@ again:
 	return C_NULL;
 }
 
+#if mxSnapshot
+void* fxRelocate(txRelocation* relocation, void* address)
+{
+	txByte* p = (txByte*)address;
+	txRelocationRange* range;
+	txInteger min, max, mid, index;
+	if ((p < relocation->begin) || (p >= relocation->end))
+		return address;
+	min = 0;
+	max = relocation->count;
+	while (min < max) {
+		mid = (min + max) >> 1;
+		range = relocation->ranges + mid;
+		if (p < range->begin)
+			max = mid;
+		else if (p >= range->end)
+			min = mid + 1;
+		else if (range->map) {
+			index = range->map[(p - range->begin) / sizeof(txSlot)];
+			return (index < 0) ? C_NULL : range->target + (index * sizeof(txSlot));
+		}
+		else
+			return range->target + (p - range->begin);
+	}
+	return address;
+}
+
+int fxRelocateCompare(const void* p, const void* q)
+{
+	txByte* a = ((txRelocationRange*)p)->begin;
+	txByte* b = ((txRelocationRange*)q)->begin;
+	return (a < b) ? -1 : (a > b) ? 1 : 0;
+}
+
+void fxRelocateSlot(txRelocation* relocation, txSlot* slot)
+{
+#define mxRelocate(FIELD) FIELD = fxRelocate(relocation, FIELD)
+	txSlot* item;
+	txIndex length;
+	mxRelocate(slot->next);
+	switch (slot->kind) {
+	case XS_STRING_KIND:
+	case XS_STRING_X_KIND:
+		mxRelocate(slot->value.string);
+		break;
+	case XS_REFERENCE_KIND:
+	case XS_CLOSURE_KIND:
+	case XS_WITH_KIND:
+		mxRelocate(slot->value.reference);
+		break;
+	case XS_FRAME_KIND:
+		mxRelocate(slot->value.frame.code);
+		mxRelocate(slot->value.frame.scope);
+		break;
+	case XS_INSTANCE_KIND:
+		slot->value.instance.garbage = C_NULL;
+		mxRelocate(slot->value.instance.prototype);
+		break;
+	case XS_ARGUMENTS_SLOPPY_KIND:
+	case XS_ARGUMENTS_STRICT_KIND:
+	case XS_ARRAY_KIND:
+	case XS_STACK_KIND:
+		if (slot->value.array.address) {
+			mxRelocate(slot->value.array.address);
+			item = slot->value.array.address;
+			length = (((txChunk*)(((txByte*)item) - sizeof(txChunk)))->size) / sizeof(txSlot);
+			while (length) {
+				fxRelocateSlot(relocation, item);
+				item++;
+				length--;
+			}
+		}
+		break;
+	case XS_ARRAY_BUFFER_KIND:
+		mxRelocate(slot->value.arrayBuffer.address);
+		break;
+	case XS_CALLBACK_KIND:
+	case XS_CALLBACK_X_KIND:
+		mxRelocate(slot->value.callback.IDs);
+		break;
+	case XS_CODE_KIND:
+	case XS_CODE_X_KIND:
+		mxRelocate(slot->value.code.address);
+		mxRelocate(slot->value.code.closures);
+		break;
+	case XS_GLOBAL_KIND:
+	case XS_MAP_KIND:
+	case XS_SET_KIND:
+		mxRelocate(slot->value.table.address);
+		fxRelocateTable(relocation, slot->value.table.address, slot->value.table.length);
+		break;
+	case XS_WEAK_MAP_KIND:
+	case XS_WEAK_SET_KIND:
+		mxRelocate(slot->value.table.address);
+		fxRelocateTable(relocation, slot->value.table.address, slot->value.table.length);
+		slot->value.table.address[slot->value.table.length] = C_NULL;
+		break;
+	case XS_HOST_KIND:
+		if (slot->flag & XS_HOST_CHUNK_FLAG)
+			mxRelocate(slot->value.host.data);
+		break;
+	case XS_PROXY_KIND:
+		mxRelocate(slot->value.proxy.handler);
+		mxRelocate(slot->value.proxy.target);
+		break;
+	case XS_REGEXP_KIND:
+		mxRelocate(slot->value.regexp.code);
+		mxRelocate(slot->value.regexp.data);
+		break;
+	case XS_ACCESSOR_KIND:
+		mxRelocate(slot->value.accessor.getter);
+		mxRelocate(slot->value.accessor.setter);
+		break;
+	case XS_ENTRY_KIND:
+		mxRelocate(slot->value.entry.slot);
+		break;
+	case XS_HOME_KIND:
+		mxRelocate(slot->value.home.object);
+		mxRelocate(slot->value.home.module);
+		break;
+	case XS_KEY_KIND:
+	case XS_KEY_X_KIND:
+		mxRelocate(slot->value.key.string);
+		break;
+	case XS_LIST_KIND:
+		mxRelocate(slot->value.list.first);
+		mxRelocate(slot->value.list.last);
+		break;
+#ifdef mxHostFunctionPrimitive
+	case XS_HOST_FUNCTION_KIND:
+		mxRelocate(slot->value.hostFunction.IDs);
+		break;
+#endif
+	case XS_HOST_INSPECTOR_KIND:
+		mxRelocate(slot->value.hostInspector.cache);
+		mxRelocate(slot->value.hostInspector.instance);
+		break;
+	case XS_INSTANCE_INSPECTOR_KIND:
+		mxRelocate(slot->value.instanceInspector.slot);
+		break;
+	case XS_EXPORT_KIND:
+		mxRelocate(slot->value.export.closure);
+		mxRelocate(slot->value.export.module);
+		break;
+	}
+}
+
+void fxRelocateTable(txRelocation* relocation, txSlot** address, txSize length)
+{
+	while (length) {
+		*address = fxRelocate(relocation, *address);
+		address++;
+		length--;
+	}
+}
+#endif
+
 void* fxRenewChunk(txMachine* the, void* theData, txSize theSize)
 {
 	txByte* aData = ((txByte*)theData) - sizeof(txChunk);
@@ -996,6 +1318,7 @@ void* fxRenewChunk(txMachine* the, void* theData, txSize theSize)
 	txBlock* aBlock = the->firstBlock;
 	theSize = mxRoundSize(theSize) + sizeof(txChunk); 
 	
+	fxFlushStringIndexCache(the, theData);
 	if (aChunk->size == theSize) {
 	#ifdef mxNever
 		gxRenewChunkCases[0]++;
@@ -1045,24 +1368,289 @@ void* fxRenewChunk(txMachine* the, void* theData, txSize theSize)
 	return C_NULL;
 }
 
+#if mxSnapshot
+void fxRestore(txMachine* the, txCreation* theCreation, txSnapshot* theSnapshot)
+{
+	txRelocationRange ranges[3];
+	txRelocation relocation;
+	txSize count;
+	txSlot* heap;
+	txSlot* slot;
+	txSlot* limit;
+
+	/* one block, one heap and one stack, copied from the snapshot then relocated */
+	the->currentChunksSize = 0;
+	the->peakChunksSize = 0;
+	the->maximumChunksSize = 0;
+	the->minimumChunksSize = theCreation->incrementalChunkSize - sizeof(txBlock);
+	
+	the->currentHeapCount = 0;
+	the->peakHeapCount = 0;
+	the->maximumHeapCount = 0;
+	the->minimumHeapCount = theCreation->incrementalHeapCount;
+	
+	the->firstBlock = C_NULL;
+	the->firstHeap = C_NULL;
+
+	count = theCreation->initialChunkSize;
+	if (count < theSnapshot->chunksSize)
+		count = theSnapshot->chunksSize;
+	fxGrowChunks(the, count);
+	c_memcpy(the->firstBlock->current, theSnapshot->chunks, theSnapshot->chunksSize);
+	ranges[0].begin = theSnapshot->chunks;
+	ranges[0].end = theSnapshot->chunks + theSnapshot->chunksSize;
+	ranges[0].target = the->firstBlock->current;
+	ranges[0].map = C_NULL;
+	the->firstBlock->current += theSnapshot->chunksSize;
+	the->currentChunksSize = theSnapshot->chunksSize;
+	the->peakChunksSize = theSnapshot->chunksSize;
+
+	count = theCreation->stackCount;
+	if (count < theSnapshot->stackCount)
+		count = theSnapshot->stackCount;
+	the->stackBottom = fxAllocateSlots(the, count);
+	if (!the->stackBottom)
+		fxJump(the);
+	the->stackTop = the->stackBottom + count;
+	the->stack = the->stackTop - theSnapshot->stackCount;
+	c_memcpy(the->stack, theSnapshot->stack, theSnapshot->stackCount * sizeof(txSlot));
+	the->stackPrototypes = theSnapshot->stackPrototypes ? theSnapshot->stackPrototypes : the->stackTop;
+#ifdef mxInstrument
+	the->stackPeak = the->stack;
+#endif
+	ranges[1].begin = (txByte*)theSnapshot->stack;
+	ranges[1].end = (txByte*)(theSnapshot->stack + theSnapshot->stackCount);
+	ranges[1].target = (txByte*)the->stack;
+	ranges[1].map = C_NULL;
+
+	count = theCreation->initialHeapCount;
+	if (count < theSnapshot->slotCount + the->minimumHeapCount)
+		count = theSnapshot->slotCount + the->minimumHeapCount;
+	heap = fxAllocateSlots(the, count);
+	if (!heap) {
+		fxReport(the, "# Slot allocation: failed for %ld bytes\n", count * sizeof(txSlot));
+		fxJump(the);
+	}
+	heap->next = C_NULL;
+	heap->ID = 0;
+	heap->flag = 0;
+	heap->kind = 0;
+	heap->value.reference = heap + count;
+	c_memcpy(heap + 1, theSnapshot->slots, theSnapshot->slotCount * sizeof(txSlot));
+	ranges[2].begin = (txByte*)theSnapshot->slots;
+	ranges[2].end = (txByte*)(theSnapshot->slots + theSnapshot->slotCount);
+	ranges[2].target = (txByte*)(heap + 1);
+	ranges[2].map = C_NULL;
+	slot = heap + 1 + theSnapshot->slotCount;
+	limit = heap + count;
+	the->freeHeap = (slot < limit) ? slot : C_NULL;
+	while (slot < limit) {
+		txSlot* next = slot + 1;
+		slot->next = (next < limit) ? next : C_NULL;
+		slot->kind = XS_UNDEFINED_KIND;
+		slot = next;
+	}
+	the->firstHeap = heap;
+	the->maximumHeapCount = count;
+	the->currentHeapCount = theSnapshot->slotCount;
+	the->peakHeapCount = theSnapshot->slotCount;
+
+	c_qsort(ranges, 3, sizeof(txRelocationRange), fxRelocateCompare);
+	relocation.begin = ranges[0].begin;
+	relocation.end = ranges[2].end;
+	relocation.count = 3;
+	relocation.ranges = ranges;
+	slot = heap + 1;
+	limit = slot + theSnapshot->slotCount;
+	while (slot < limit) {
+		fxRelocateSlot(&relocation, slot);
+		slot++;
+	}
+	slot = the->stack;
+	while (slot < the->stackTop) {
+		fxRelocateSlot(&relocation, slot);
+		slot++;
+	}
+	slot = heap + 1;
+	limit = slot + theSnapshot->slotCount;
+	while (slot < limit) {
+		if ((slot->kind == XS_MAP_KIND) || (slot->kind == XS_SET_KIND) || (slot->kind == XS_WEAK_MAP_KIND) || (slot->kind == XS_WEAK_SET_KIND))
+			fxRehashEntries(the, slot);
+		slot++;
+	}
+
+	the->keyOffset = theSnapshot->keyOffset;
+	the->keyIndex = theSnapshot->keyIndex;
+	the->keyCount = theSnapshot->keyCount;
+	if (the->keyCount < the->keyOffset + (txID)theCreation->keyCount)
+		the->keyCount = the->keyOffset + (txID)theCreation->keyCount;
+	the->keyArray = (txSlot **)c_malloc_uint32((the->keyCount - the->keyOffset) * sizeof(txSlot*));
+	if (!the->keyArray)
+		fxJump(the);
+	count = the->keyIndex - the->keyOffset;
+	c_memcpy(the->keyArray, theSnapshot->keys, count * sizeof(txSlot*));
+	c_memset(the->keyArray + count, 0, (the->keyCount - the->keyIndex) * sizeof(txSlot*));
+	fxRelocateTable(&relocation, the->keyArray, count);
+	the->keyArrayHost = theSnapshot->keyArrayHost;
+
+	the->nameModulo = theSnapshot->nameModulo;
+	the->nameTable = (txSlot **)c_malloc_uint32(the->nameModulo * sizeof(txSlot*));
+	if (!the->nameTable)
+		fxJump(the);
+	c_memcpy(the->nameTable, theSnapshot->names, the->nameModulo * sizeof(txSlot*));
+	fxRelocateTable(&relocation, the->nameTable, the->nameModulo);
+
+	the->symbolModulo = theSnapshot->symbolModulo;
+	the->symbolTable = (txSlot **)c_malloc_uint32(the->symbolModulo * sizeof(txSlot*));
+	if (!the->symbolTable)
+		fxJump(the);
+	c_memcpy(the->symbolTable, theSnapshot->symbols, the->symbolModulo * sizeof(txSlot*));
+	fxRelocateTable(&relocation, the->symbolTable, the->symbolModulo);
+
+	the->aliasCount = theSnapshot->aliasCount;
+	if (the->aliasCount) {
+		the->aliasArray = (txSlot **)c_malloc_uint32(the->aliasCount * sizeof(txSlot*));
+		if (!the->aliasArray)
+			fxJump(the);
+		c_memcpy(the->aliasArray, theSnapshot->aliases, the->aliasCount * sizeof(txSlot*));
+		fxRelocateTable(&relocation, the->aliasArray, the->aliasCount);
+	}
+
+#if mxInlineCache
+	the->inlineCaches = (txInlineCache *)c_calloc(mxInlineCacheCount, sizeof(txInlineCache));
+	if (!the->inlineCaches)
+		fxJump(the);
+	the->inlineCacheEpoch = 1;
+#endif
+#if mxShapes
+	if (theSnapshot->shapeCount) {
+		the->shapes = c_malloc(theSnapshot->shapeCount * sizeof(txShape));
+		if (!the->shapes)
+			fxJump(the);
+		c_memcpy(the->shapes, theSnapshot->shapes, theSnapshot->shapeCount * sizeof(txShape));
+		the->shapeCount = theSnapshot->shapeCount;
+		the->shapeSize = theSnapshot->shapeCount;
+	}
+	if (theSnapshot->shapeTable) {
+		the->shapeTable = c_malloc(mxShapeModulo * sizeof(txInteger));
+		if (!the->shapeTable)
+			fxJump(the);
+		c_memcpy(the->shapeTable, theSnapshot->shapeTable, mxShapeModulo * sizeof(txInteger));
+	}
+#endif
+
+	the->lastJob = fxRelocate(&relocation, theSnapshot->lastJob);
+#if mxJobPool
+	the->freeJobs = fxRelocate(&relocation, theSnapshot->freeJobs);
+	the->freeJobCount = theSnapshot->freeJobCount;
+#endif
+	the->requireFlag = theSnapshot->requireFlag;
+	the->sharedMachine = theSnapshot->sharedMachine;
+	the->sharedModules = theSnapshot->sharedModules;
+#ifdef mxInstrument
+	the->loadedModulesCount = theSnapshot->loadedModulesCount;
+#endif
+	the->cRoot = C_NULL;
+}
+#endif
+
+#if mxProtectSharedMachine
+void fxProtectShare(txMachine* the, txBoolean readOnly)
+{
+	uintptr_t mask = (uintptr_t)sysconf(_SC_PAGESIZE) - 1;
+	int protection = readOnly ? PROT_READ : PROT_READ | PROT_WRITE;
+	txBlock* aBlock;
+	txSlot* aSlot;
+	uintptr_t begin, end;
+
+#define mxProtect(BEGIN, END) \
+	begin = ((uintptr_t)(BEGIN) + mask) & ~mask; \
+	end = (uintptr_t)(END) & ~mask; \
+	if (begin < end) \
+		mprotect((void*)begin, end - begin, protection)
+
+	aBlock = the->firstBlock;
+	while (aBlock) {
+		mxProtect(aBlock, aBlock->limit);
+		aBlock = aBlock->nextBlock;
+	}
+	aSlot = the->firstHeap;
+	while (aSlot) {
+		mxProtect(aSlot, aSlot->value.reference);
+		aSlot = aSlot->next;
+	}
+	mxProtect(the->stackBottom, the->stackTop);
+}
+#endif
+
 void fxShare(txMachine* the)
 {
 	txID aliasCount = 0;
 	txSlot* aSlot;
 	txSlot* bSlot;
 	txSlot* cSlot;
+	txSlot* aProperty;
+	txInteger aSize;
 
+	/* as in the linker, functions and arrays are frozen, closures are constant and other instances are aliased, but Array.prototype stays extensible */
 	fxCollect(the, 1);
 	aSlot = the->firstHeap;
 	while (aSlot) {
 		bSlot = aSlot + 1;
 		cSlot = aSlot->value.reference;
 		while (bSlot < cSlot) {
-			if (bSlot->kind == XS_INSTANCE_KIND) {
-				bSlot->ID = aliasCount++;
-				bSlot->flag |= XS_MARK_FLAG; 
+			if ((bSlot->kind == XS_ARRAY_KIND) && ((aProperty = bSlot->value.array.address))) {
+				aSize = (txInteger)fxGetIndexSize(the, bSlot);
+				while (aSize) {
+					if (aProperty->kind != XS_ACCESSOR_KIND) 
+						aProperty->flag |= XS_DONT_SET_FLAG;
+					aProperty->flag |= XS_DONT_DELETE_FLAG | XS_MARK_FLAG;
+					fxShareKind(aProperty);
+					aProperty++;
+					aSize--;
+				}
+				bSlot->flag |= XS_DONT_DELETE_FLAG | XS_DONT_SET_FLAG;
 			}
-			
+			else if (bSlot->kind == XS_CLOSURE_KIND) {
+				if (bSlot->value.closure)
+					bSlot->value.closure->flag |= XS_DONT_SET_FLAG;
+			}
+			else if (bSlot->kind == XS_EXPORT_KIND) {
+				if (bSlot->value.export.closure)
+					bSlot->value.export.closure->flag |= XS_DONT_SET_FLAG;
+			}
+			else if (bSlot->kind == XS_INSTANCE_KIND) {
+				aProperty = bSlot->next;
+				if (bSlot == mxArrayPrototype.value.reference)
+					bSlot->ID = aliasCount++;
+				else if (aProperty && ((aProperty->kind == XS_ARRAY_KIND) || (aProperty->kind == XS_CALLBACK_KIND) || (aProperty->kind == XS_CALLBACK_X_KIND) || (aProperty->kind == XS_CODE_KIND) || (aProperty->kind == XS_CODE_X_KIND))) {
+					bSlot->ID = XS_NO_ID;
+					while (aProperty) {
+						if (aProperty->kind != XS_ACCESSOR_KIND) 
+							aProperty->flag |= XS_DONT_SET_FLAG;
+						aProperty->flag |= XS_DONT_DELETE_FLAG;
+						aProperty = aProperty->next;
+					}
+					bSlot->flag |= XS_DONT_PATCH_FLAG;
+				}
+				else if (aProperty && ((aProperty->kind == XS_MODULE_KIND) || (aProperty->kind == XS_WITH_KIND)))
+					bSlot->ID = XS_NO_ID;
+				else if (aProperty && (aProperty->kind == XS_PROXY_KIND))
+					bSlot->ID = aliasCount++;
+				else {
+					txBoolean frozen = (bSlot->flag & XS_DONT_PATCH_FLAG) ? 1 : 0;
+					while (frozen && aProperty) {
+						if ((aProperty->kind != XS_ACCESSOR_KIND) && !(aProperty->flag & XS_DONT_SET_FLAG))
+							frozen = 0;
+						if (!(aProperty->flag & XS_DONT_DELETE_FLAG))
+							frozen = 0;
+						aProperty = aProperty->next;
+					}
+					bSlot->ID = frozen ? XS_NO_ID : aliasCount++;
+				}
+			}
+			fxShareKind(bSlot);
+			bSlot->flag |= XS_MARK_FLAG; 
 			bSlot++;
 		}
 		aSlot = aSlot->next;
@@ -1077,9 +1665,266 @@ void fxShare(txMachine* the)
 	*/
 }
 
+void fxShareKind(txSlot* theSlot)
+{
+	/* chunks of a shared machine are neither marked nor swept by its clones */
+	switch (theSlot->kind) {
+	case XS_STRING_KIND:
+		theSlot->kind = XS_STRING_X_KIND;
+		break;
+	case XS_CALLBACK_KIND:
+		theSlot->kind = XS_CALLBACK_X_KIND;
+		break;
+	case XS_CODE_KIND:
+		theSlot->kind = XS_CODE_X_KIND;
+		break;
+	case XS_KEY_KIND:
+		theSlot->kind = XS_KEY_X_KIND;
+		break;
+	}
+}
+
+#if mxSnapshot
+txSnapshot* fxSnapshot(txMachine* the)
+{
+#define mxSnapshotRound(SIZE) (((SIZE) + 15) & ~15)
+	txSnapshot* snapshot = C_NULL;
+	txRelocation relocation;
+	txRelocationRange* range;
+	txInteger* map = C_NULL;
+	txSlot* heap;
+	txSlot* slot;
+	txSlot* limit;
+	txBlock* block;
+	txByte* chunks;
+	txSize mapCount = 0, slotCount = 0, chunksSize = 0, stackCount, keyCount, size;
+	txSize slotsOffset, stackOffset, keysOffset, namesOffset, symbolsOffset, aliasesOffset, chunksOffset;
+#if mxShapes
+	txSize shapesOffset, shapeTableOffset;
+#endif
+	txInteger index;
+
+	fxCollect(the, 1);
+
+	/* host data owned outside chunks cannot be duplicated */
+	relocation.count = 1;
+	heap = the->firstHeap;
+	while (heap) {
+		slot = heap + 1;
+		limit = heap->value.reference;
+		while (slot < limit) {
+			if ((slot->kind == XS_HOST_KIND) && slot->value.host.data) {
+				if (slot->flag & XS_HOST_HOOKS_FLAG) {
+					if (slot->value.host.variant.hooks->marker || slot->value.host.variant.hooks->sweeper)
+						return C_NULL;
+					if (slot->value.host.variant.hooks->destructor && !(slot->flag & XS_HOST_CHUNK_FLAG))
+						return C_NULL;
+				}
+				else if (slot->value.host.variant.destructor && !(slot->flag & XS_HOST_CHUNK_FLAG))
+					return C_NULL;
+			}
+			slot++;
+		}
+		mapCount += limit - heap;
+		relocation.count++;
+		heap = heap->next;
+	}
+	block = the->firstBlock;
+	while (block) {
+		chunksSize += block->current - (((txByte*)block) + sizeof(txBlock));
+		relocation.count++;
+		block = block->nextBlock;
+	}
+	relocation.ranges = c_malloc(relocation.count * sizeof(txRelocationRange));
+	map = c_malloc(mapCount * sizeof(txInteger));
+	if (!relocation.ranges || !map)
+		goto bail;
+
+	/* free slots are flagged then skipped, live slots are numbered */
+	slot = the->freeHeap;
+	while (slot) {
+		slot->flag |= XS_MARK_FLAG;
+		slot = slot->next;
+	}
+	range = relocation.ranges;
+	index = 0;
+	heap = the->firstHeap;
+	while (heap) {
+		limit = heap->value.reference;
+		range->begin = (txByte*)heap;
+		range->end = (txByte*)limit;
+		range->map = map + index;
+		map[index++] = -1;
+		slot = heap + 1;
+		while (slot < limit) {
+			if (slot->flag & XS_MARK_FLAG) {
+				slot->flag &= ~XS_MARK_FLAG;
+				map[index++] = -1;
+			}
+			else
+				map[index++] = slotCount++;
+			slot++;
+		}
+		range++;
+		heap = heap->next;
+	}
+
+	stackCount = the->stackTop - the->stack;
+	keyCount = the->keyIndex - the->keyOffset;
+	size = mxSnapshotRound(sizeof(txSnapshot));
+	slotsOffset = size;
+	size += slotCount * sizeof(txSlot);
+	stackOffset = size;
+	size += stackCount * sizeof(txSlot);
+	keysOffset = size;
+	size += keyCount * sizeof(txSlot*);
+	namesOffset = size;
+	size += the->nameModulo * sizeof(txSlot*);
+	symbolsOffset = size;
+	size += the->symbolModulo * sizeof(txSlot*);
+	aliasesOffset = size;
+	size += the->aliasCount * sizeof(txSlot*);
+#if mxShapes
+	size = mxSnapshotRound(size);
+	shapesOffset = size;
+	size += the->shapeCount * sizeof(txShape);
+	size = mxSnapshotRound(size);
+	shapeTableOffset = size;
+	if (the->shapeTable)
+		size += mxShapeModulo * sizeof(txInteger);
+#endif
+	size = mxSnapshotRound(size);
+	chunksOffset = size;
+	size += chunksSize;
+	snapshot = c_malloc(size);
+	if (!snapshot)
+		goto bail;
+	c_memset(snapshot, 0, sizeof(txSnapshot));
+	snapshot->size = size;
+	snapshot->slotCount = slotCount;
+	snapshot->slots = (txSlot*)(((txByte*)snapshot) + slotsOffset);
+	snapshot->stackCount = stackCount;
+	snapshot->stack = (txSlot*)(((txByte*)snapshot) + stackOffset);
+	snapshot->chunksSize = chunksSize;
+	snapshot->chunks = ((txByte*)snapshot) + chunksOffset;
+	snapshot->keyCount = the->keyCount;
+	snapshot->keyIndex = the->keyIndex;
+	snapshot->keyOffset = the->keyOffset;
+	snapshot->keys = (txSlot**)(((txByte*)snapshot) + keysOffset);
+	snapshot->nameModulo = the->nameModulo;
+	snapshot->names = (txSlot**)(((txByte*)snapshot) + namesOffset);
+	snapshot->symbolModulo = the->symbolModulo;
+	snapshot->symbols = (txSlot**)(((txByte*)snapshot) + symbolsOffset);
+	snapshot->aliasCount = the->aliasCount;
+	snapshot->aliases = (txSlot**)(((txByte*)snapshot) + aliasesOffset);
+
+	index = 0;
+	heap = the->firstHeap;
+	while (heap) {
+		limit = heap->value.reference;
+		range = relocation.ranges;
+		while (range->begin != (txByte*)heap)
+			range++;
+		range->target = (txByte*)snapshot->slots;
+		slot = heap + 1;
+		index++;
+		while (slot < limit) {
+			if (map[index] >= 0)
+				snapshot->slots[map[index]] = *slot;
+			index++;
+			slot++;
+		}
+		heap = heap->next;
+	}
+	c_memcpy(snapshot->stack, the->stack, stackCount * sizeof(txSlot));
+	range = relocation.ranges + (relocation.count - 1);
+	range->begin = (txByte*)the->stack;
+	range->end = (txByte*)the->stackTop;
+	range->target = (txByte*)snapshot->stack;
+	range->map = C_NULL;
+	chunks = snapshot->chunks;
+	range = relocation.ranges + (relocation.count - 1);
+	block = the->firstBlock;
+	while (block) {
+		range--;
+		range->begin = ((txByte*)block) + sizeof(txBlock);
+		range->end = block->current;
+		range->target = chunks;
+		range->map = C_NULL;
+		c_memcpy(chunks, range->begin, range->end - range->begin);
+		chunks += range->end - range->begin;
+		block = block->nextBlock;
+	}
+	c_qsort(relocation.ranges, relocation.count, sizeof(txRelocationRange), fxRelocateCompare);
+	relocation.begin = relocation.ranges[0].begin;
+	relocation.end = relocation.ranges[0].end;
+	for (index = 1; index < relocation.count; index++) {
+		if (relocation.end < relocation.ranges[index].end)
+			relocation.end = relocation.ranges[index].end;
+	}
+
+	slot = snapshot->slots;
+	limit = slot + slotCount;
+	while (slot < limit) {
+		fxRelocateSlot(&relocation, slot);
+		slot++;
+	}
+	slot = snapshot->stack;
+	limit = slot + stackCount;
+	while (slot < limit) {
+		fxRelocateSlot(&relocation, slot);
+		slot++;
+	}
+	c_memcpy(snapshot->keys, the->keyArray, keyCount * sizeof(txSlot*));
+	fxRelocateTable(&relocation, snapshot->keys, keyCount);
+	c_memcpy(snapshot->names, the->nameTable, the->nameModulo * sizeof(txSlot*));
+	fxRelocateTable(&relocation, snapshot->names, the->nameModulo);
+	c_memcpy(snapshot->symbols, the->symbolTable, the->symbolModulo * sizeof(txSlot*));
+	fxRelocateTable(&relocation, snapshot->symbols, the->symbolModulo);
+	if (the->aliasCount) {
+		c_memcpy(snapshot->aliases, the->aliasArray, the->aliasCount * sizeof(txSlot*));
+		fxRelocateTable(&relocation, snapshot->aliases, the->aliasCount);
+	}
+#if mxShapes
+	snapshot->shapeCount = the->shapeCount;
+	snapshot->shapes = (txShape*)(((txByte*)snapshot) + shapesOffset);
+	if (the->shapeCount)
+		c_memcpy(snapshot->shapes, the->shapes, the->shapeCount * sizeof(txShape));
+	if (the->shapeTable) {
+		snapshot->shapeTable = (txInteger*)(((txByte*)snapshot) + shapeTableOffset);
+		c_memcpy(snapshot->shapeTable, the->shapeTable, mxShapeModulo * sizeof(txInteger));
+	}
+#endif
+
+	snapshot->stackPrototypes = (the->stackPrototypes == the->stackTop) ? C_NULL : the->stackPrototypes;
+	snapshot->lastJob = fxRelocate(&relocation, the->lastJob);
+#if mxJobPool
+	snapshot->freeJobs = fxRelocate(&relocation, the->freeJobs);
+	snapshot->freeJobCount = the->freeJobCount;
+#endif
+	snapshot->collectFlag = the->collectFlag;
+	snapshot->requireFlag = the->requireFlag;
+	snapshot->sharedMachine = the->sharedMachine;
+	snapshot->sharedModules = the->sharedModules;
+	snapshot->keyArrayHost = the->keyArrayHost;
+	snapshot->preparation = the->preparation;
+	snapshot->archive = the->archive;
+#ifdef mxInstrument
+	snapshot->loadedModulesCount = the->loadedModulesCount;
+#endif
+bail:
+	if (map)
+		c_free(map);
+	if (relocation.ranges)
+		c_free(relocation.ranges);
+	return snapshot;
+}
+#endif
+
 void fxSweep(txMachine* the)
 {
 	txSize aTotal;
+	txBlock** aBlockAddress;
 	txBlock* aBlock;
 	txByte* mByte;
 	txByte* nByte;
@@ -1231,8 +2076,8 @@ void fxSweep(txMachine* the)
 	startTime(&gxCompactChunkTime);
 #endif
 
-	aBlock = the->firstBlock;
-	while (aBlock) {
+	aBlockAddress = &(the->firstBlock);
+	while ((aBlock = *aBlockAddress)) {
 		mByte = ((txByte*)aBlock) + sizeof(txBlock);
 		nByte = aBlock->current;
 		while (mByte < nByte) {
@@ -1249,7 +2094,16 @@ void fxSweep(txMachine* the)
 	#endif
 		aBlock->current = aBlock->temporary;
 		aBlock->temporary = C_NULL;
-		aBlock = aBlock->nextBlock;
+	#if mxTransferChunks
+		/* blocks received from other machines are released once empty */
+		if (aBlock->transferred && (aBlock->current == ((txByte*)aBlock) + sizeof(txBlock))) {
+			*aBlockAddress = aBlock->nextBlock;
+			the->maximumChunksSize -= aBlock->limit - (txByte*)aBlock;
+			fxFreeChunks(the, aBlock);
+			continue;
+		}
+	#endif
+		aBlockAddress = &(aBlock->nextBlock);
 	}
 	
 #ifdef mxNever
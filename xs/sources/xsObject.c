@@ -125,6 +125,64 @@ txSlot* fxNewObjectInstance(txMachine* the)
 	return instance;
 }
 
+#if mxShapes
+txSlot* fxGetShapeProperty(txMachine* the, txSlot* instance, txInteger offset)
+{
+	txSlot* property = instance->next;
+	while (offset) {
+		property = property->next;
+		offset--;
+	}
+	return property;
+}
+
+txID fxNextShape(txMachine* the, txID shape, txID id)
+{
+	txInteger parent = (shape == XS_NO_ID) ? -1 : mxShapeIndex(shape);
+	txInteger length = (parent < 0) ? 1 : the->shapes[parent].length + 1;
+	txInteger modulo = (((txUnsigned)(parent + 1) * 31) + (txU2)id) & (mxShapeModulo - 1);
+	txInteger index;
+	txShape* it;
+	if (length > mxShapeLength)
+		return XS_NO_ID;
+	if (!the->shapeTable) {
+		the->shapeTable = c_malloc(mxShapeModulo * sizeof(txInteger));
+		if (!the->shapeTable)
+			return XS_NO_ID;
+		c_memset(the->shapeTable, 0xFF, mxShapeModulo * sizeof(txInteger));
+	}
+	index = the->shapeTable[modulo];
+	while (index >= 0) {
+		it = the->shapes + index;
+		if ((it->parent == parent) && (it->id == id))
+			return mxShapeID(index);
+		index = it->link;
+	}
+	if (the->shapeCount == the->shapeSize) {
+		txInteger size = (the->shapeSize) ? the->shapeSize * 2 : 64;
+		txShape* shapes;
+		if (size > mxShapeCount)
+			size = mxShapeCount;
+		if (size == the->shapeSize)
+			return XS_NO_ID;
+		shapes = c_realloc(the->shapes, size * sizeof(txShape));
+		if (!shapes)
+			return XS_NO_ID;
+		the->shapes = shapes;
+		the->shapeSize = size;
+	}
+	index = the->shapeCount++;
+	it = the->shapes + index;
+	it->parent = parent;
+	it->link = the->shapeTable[modulo];
+	it->filter = ((parent < 0) ? 0 : the->shapes[parent].filter) | mxShapeBit(id);
+	it->id = id;
+	it->length = (txU2)length;
+	the->shapeTable[modulo] = index;
+	return mxShapeID(index);
+}
+#endif
+
 void fx_Object(txMachine* the)
 {
 	if (!mxIsUndefined(mxTarget) && !fxIsSameSlot(the, mxTarget, mxFunction)) {
@@ -69,6 +69,9 @@
 #ifndef mxUseDefaultDebug
 	#define mxUseDefaultDebug 0
 #endif
+#ifndef mxScriptCache
+	#define mxScriptCache 0
+#endif
 
 #ifndef mxLink
 
@@ -392,6 +395,34 @@ void fxLoadModule(txMachine* the, txID moduleID)
 }
 
 #ifdef mxParse
+#if mxScriptCache
+#include <arpa/inet.h>
+#include <stddef.h>
+#include <sys/stat.h>
+
+typedef struct {
+	uint64_t flags;
+	uint64_t size;
+	uint64_t time;
+	uint64_t nanoseconds;
+	uint64_t hash;
+	uint64_t build;
+	uint64_t atoms;
+} txScriptCacheStamp;
+
+typedef struct {
+	char path[C_PATH_MAX];
+	txString source;
+	txSize size;
+	txScriptCacheStamp stamp;
+} txScriptCache;
+
+static txScriptCache* fxOpenScriptCache(txString path, txUnsigned flags, txScriptCache* cache);
+static void fxCloseScriptCache(txScriptCache* cache);
+static txScript* fxReadScriptCache(txScriptCache* cache, txString path);
+static void fxWriteScriptCache(txScriptCache* cache, txString path, txScript* script);
+#endif
+
 txScript* fxLoadScript(txMachine* the, txString path, txUnsigned flags)
 {
 	txParser _parser;
@@ -400,16 +431,39 @@ txScript* fxLoadScript(txMachine* the, txString path, txUnsigned flags)
 	FILE* file = NULL;
 	txString name = NULL;
 	char map[C_PATH_MAX];
+	txParserSource source;
 	txScript* script = NULL;
+#if mxScriptCache
+	txScriptCache _cache;
+	txScriptCache* cache = fxOpenScriptCache(path, flags, &_cache);
+	if (cache) {
+		script = fxReadScriptCache(cache, path);
+		if (script) {
+			fxCloseScriptCache(cache);
+			return script;
+		}
+	}
+#endif
 	fxInitializeParser(parser, the, 32*1024, 1993);
 	parser->firstJump = &jump;
 	if (c_setjmp(jump.jmp_buf) == 0) {
 		parser->path = fxNewParserSymbol(parser, path);
-		file = fopen(path, "r");
-		mxParserThrowElse(file);
-		fxParserTree(parser, file, (txGetter)fgetc, flags, &name);
-		fclose(file);
-		file = NULL;
+#if mxScriptCache
+		if (cache) {
+			source.buffer = cache->source;
+			source.offset = 0;
+			source.size = cache->size;
+		}
+		else
+#endif
+		{
+			file = fopen(path, "r");
+			mxParserThrowElse(file);
+			fxReadParserSource(parser, file, &source);
+			fclose(file);
+			file = NULL;
+		}
+		fxParserTree(parser, &source, fxParserSourceGetter, flags, &name);
 		if (name) {
 			txString slash = c_strrchr(path, mxSeparator);
 			if (slash) *slash = 0;
@@ -418,9 +472,10 @@ txScript* fxLoadScript(txMachine* the, txString path, txUnsigned flags)
 			parser->path = fxNewParserSymbol(parser, map);
 			file = fopen(map, "r");
 			mxParserThrowElse(file);
-			fxParserSourceMap(parser, file, (txGetter)fgetc, flags, &name);
+			fxReadParserSource(parser, file, &source);
 			fclose(file);
 			file = NULL;
+			fxParserSourceMap(parser, &source, fxParserSourceGetter, flags, &name);
 			if (slash) *slash = 0;
 			c_strcat(path, name);
 			mxParserThrowElse(c_realpath(path, map));
@@ -429,6 +484,10 @@ txScript* fxLoadScript(txMachine* the, txString path, txUnsigned flags)
 		fxParserHoist(parser);
 		fxParserBind(parser);
 		script = fxParserCode(parser);
+#if mxScriptCache
+		if (cache && script && !name)
+			fxWriteScriptCache(cache, path, script);
+#endif
 	}
 	if (file)
 		fclose(file);
@@ -437,8 +496,231 @@ txScript* fxLoadScript(txMachine* the, txString path, txUnsigned flags)
 		the->parserTotal = parser->total;
 #endif
 	fxTerminateParser(parser);
+#if mxScriptCache
+	if (cache)
+		fxCloseScriptCache(cache);
+#endif
 	return script;
 }
+
+#if mxScriptCache
+/*
+	Parsed scripts are cached in $XS_SCRIPT_CACHE, else $XDG_CACHE_HOME/xs or $HOME/.cache/xs. An empty XS_SCRIPT_CACHE disables the cache.
+	Cache files are named after the path and the flags, and use the .xsb atoms. The CHKS atom stamps the source size, modification time and content hash, and the executable that wrote the code.
+	The stamp ends with a hash of the SYMB, CODE and HOST atoms, checked once they are read, so a damaged cache file is parsed again instead of run.
+	Cache files are written to a unique temporary file, then renamed.
+*/
+
+static uint64_t fxHashScriptCache(uint64_t hash, void* buffer, size_t size)
+{
+	txU1* p = (txU1*)buffer;
+	txU1* q = p + size;
+	while (p < q) {
+		hash ^= *p++;
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static uint64_t fxHashScriptCacheAtoms(txScript* script)
+{
+	uint64_t hash = fxHashScriptCache(0xCBF29CE484222325ULL, script->symbolsBuffer, script->symbolsSize);
+	hash = fxHashScriptCache(hash, script->codeBuffer, script->codeSize);
+	if (script->hostsBuffer)
+		hash = fxHashScriptCache(hash, script->hostsBuffer, script->hostsSize);
+	return hash;
+}
+
+txScriptCache* fxOpenScriptCache(txString path, txUnsigned flags, txScriptCache* cache)
+{
+	char* directory = getenv("XS_SCRIPT_CACHE");
+	struct stat info;
+	FILE* file = NULL;
+	uint64_t hash;
+	size_t length;
+	c_memset(cache, 0, sizeof(txScriptCache));
+	if (directory) {
+		if (!*directory)
+			return C_NULL;
+		length = snprintf(cache->path, sizeof(cache->path), "%s", directory);
+	}
+	else if ((directory = getenv("XDG_CACHE_HOME")) && *directory)
+		length = snprintf(cache->path, sizeof(cache->path), "%s/xs", directory);
+	else if ((directory = getenv("HOME")) && *directory) {
+		length = snprintf(cache->path, sizeof(cache->path), "%s/.cache", directory);
+		if (length < sizeof(cache->path))
+			mkdir(cache->path, 0700);
+		length = snprintf(cache->path, sizeof(cache->path), "%s/.cache/xs", directory);
+	}
+	else
+		return C_NULL;
+	if (length + 1 + 16 + 4 + 1 + 6 >= sizeof(cache->path))
+		return C_NULL;
+	if (mkdir(cache->path, 0700) && (errno != EEXIST))
+		return C_NULL;
+	hash = fxHashScriptCache(0xCBF29CE484222325ULL, path, c_strlen(path));
+	hash = fxHashScriptCache(hash, &flags, sizeof(flags));
+	snprintf(cache->path + length, sizeof(cache->path) - length, "/%016llx.xsb", (unsigned long long)hash);
+	
+	if (stat("/proc/self/exe", &info))
+		return C_NULL;
+	hash = fxHashScriptCache(0xCBF29CE484222325ULL, &info.st_size, sizeof(info.st_size));
+	hash = fxHashScriptCache(hash, &info.st_mtim, sizeof(info.st_mtim));
+	cache->stamp.build = hash;
+	
+	file = fopen(path, "rb");
+	if (!file)
+		return C_NULL;
+	if (fstat(fileno(file), &info) || (info.st_size > 0x7FFFFFFF))
+		goto bail;
+	cache->size = (txSize)info.st_size;
+	cache->source = c_malloc(cache->size + 1);
+	if (!cache->source)
+		goto bail;
+	if (fread(cache->source, 1, cache->size, file) != (size_t)cache->size)
+		goto bail;
+	cache->source[cache->size] = 0;
+	fclose(file);
+	cache->stamp.flags = flags;
+	cache->stamp.size = cache->size;
+	cache->stamp.time = info.st_mtim.tv_sec;
+	cache->stamp.nanoseconds = info.st_mtim.tv_nsec;
+	cache->stamp.hash = fxHashScriptCache(0xCBF29CE484222325ULL, cache->source, cache->size);
+	return cache;
+bail:
+	fclose(file);
+	fxCloseScriptCache(cache);
+	return C_NULL;
+}
+
+void fxCloseScriptCache(txScriptCache* cache)
+{
+	if (cache->source) {
+		c_free(cache->source);
+		cache->source = C_NULL;
+	}
+}
+
+static void* fxReadScriptCacheAtom(FILE* file, txU4 type, txSize* size)
+{
+	Atom atom;
+	void* buffer;
+	if (fread(&atom, sizeof(atom), 1, file) != 1) 
+		return C_NULL;
+	atom.atomSize = ntohl(atom.atomSize);
+	atom.atomType = ntohl(atom.atomType);
+	if ((atom.atomType != type) || (atom.atomSize < (txS4)sizeof(atom)))
+		return C_NULL;
+	*size = atom.atomSize - sizeof(atom);
+	buffer = c_malloc(*size ? *size : 1);
+	if (buffer && (fread(buffer, 1, *size, file) != (size_t)*size)) {
+		c_free(buffer);
+		buffer = C_NULL;
+	}
+	return buffer;
+}
+
+txScript* fxReadScriptCache(txScriptCache* cache, txString path)
+{
+	FILE* file = fopen(cache->path, "rb");
+	txScript* script = C_NULL;
+	txString buffer = C_NULL;
+	txSize size;
+	Atom atom;
+	txU1 version[4];
+	uint64_t atoms;
+	if (!file)
+		return C_NULL;
+	if ((fread(&atom, sizeof(atom), 1, file) != 1) || (ntohl(atom.atomType) != XS_ATOM_BINARY))
+		goto bail;
+	if (!(buffer = fxReadScriptCacheAtom(file, XS_ATOM_VERSION, &size)) || (size != sizeof(version)))
+		goto bail;
+	c_memcpy(version, buffer, sizeof(version));
+	c_free(buffer);
+	if ((version[0] != XS_MAJOR_VERSION) || (version[1] != XS_MINOR_VERSION) || (version[2] != XS_PATCH_VERSION))
+		goto bail;
+	if (!(buffer = fxReadScriptCacheAtom(file, XS_ATOM_CHECKSUM, &size)) || (size != sizeof(txScriptCacheStamp)) || c_memcmp(buffer, &cache->stamp, offsetof(txScriptCacheStamp, atoms)))
+		goto bail;
+	atoms = ((txScriptCacheStamp*)buffer)->atoms;
+	c_free(buffer);
+	if (!(buffer = fxReadScriptCacheAtom(file, XS_ATOM_PATH, &size)) || (size != (txSize)c_strlen(path) + 1) || c_memcmp(buffer, path, size))
+		goto bail;
+	c_free(buffer);
+	buffer = C_NULL;
+	script = c_malloc(sizeof(txScript));
+	if (!script)
+		goto bail;
+	c_memset(script, 0, sizeof(txScript));
+	if (!(script->symbolsBuffer = fxReadScriptCacheAtom(file, XS_ATOM_SYMBOLS, &script->symbolsSize)))
+		goto bail;
+	if (!(script->codeBuffer = fxReadScriptCacheAtom(file, XS_ATOM_CODE, &script->codeSize)))
+		goto bail;
+	if (version[3] && !(script->hostsBuffer = fxReadScriptCacheAtom(file, XS_ATOM_HOSTS, &script->hostsSize)))
+		goto bail;
+	if (fxHashScriptCacheAtoms(script) != atoms)
+		goto bail;
+	fclose(file);
+	return script;
+bail:
+	if (buffer)
+		c_free(buffer);
+	fxDeleteScript(script);
+	fclose(file);
+	return C_NULL;
+}
+
+static txBoolean fxWriteScriptCacheAtom(FILE* file, txU4 type, void* buffer, txSize size)
+{
+	Atom atom;
+	atom.atomSize = htonl(sizeof(atom) + size);
+	atom.atomType = htonl(type);
+	if (fwrite(&atom, sizeof(atom), 1, file) != 1)
+		return 0;
+	return (size == 0) || (fwrite(buffer, size, 1, file) == 1);
+}
+
+void fxWriteScriptCache(txScriptCache* cache, txString path, txScript* script)
+{
+	char temporary[C_PATH_MAX];
+	FILE* file;
+	Atom atom;
+	txSize length = c_strlen(path) + 1;
+	txSize size = sizeof(Atom) + sizeof(Atom) + 4 + sizeof(Atom) + sizeof(txScriptCacheStamp) + sizeof(Atom) + length + sizeof(Atom) + script->symbolsSize + sizeof(Atom) + script->codeSize;
+	txU1 version[4] = { XS_MAJOR_VERSION, XS_MINOR_VERSION, XS_PATCH_VERSION, 0 };
+	txBoolean success;
+	int descriptor;
+	if (script->hostsBuffer) {
+		size += sizeof(Atom) + script->hostsSize;
+		version[3] = 1;
+	}
+	cache->stamp.atoms = fxHashScriptCacheAtoms(script);
+	if (snprintf(temporary, sizeof(temporary), "%s.XXXXXX", cache->path) >= (int)sizeof(temporary))
+		return;
+	descriptor = mkstemp(temporary);
+	if (descriptor < 0)
+		return;
+	file = fdopen(descriptor, "wb");
+	if (!file) {
+		close(descriptor);
+		unlink(temporary);
+		return;
+	}
+	atom.atomSize = htonl(size);
+	atom.atomType = htonl(XS_ATOM_BINARY);
+	success = (fwrite(&atom, sizeof(atom), 1, file) == 1)
+		&& fxWriteScriptCacheAtom(file, XS_ATOM_VERSION, version, 4)
+		&& fxWriteScriptCacheAtom(file, XS_ATOM_CHECKSUM, &cache->stamp, sizeof(txScriptCacheStamp))
+		&& fxWriteScriptCacheAtom(file, XS_ATOM_PATH, path, length)
+		&& fxWriteScriptCacheAtom(file, XS_ATOM_SYMBOLS, script->symbolsBuffer, script->symbolsSize)
+		&& fxWriteScriptCacheAtom(file, XS_ATOM_CODE, script->codeBuffer, script->codeSize);
+	if (success && script->hostsBuffer)
+		success = fxWriteScriptCacheAtom(file, XS_ATOM_HOSTS, script->hostsBuffer, script->hostsSize);
+	if (fclose(file))
+		success = 0;
+	if (!success || rename(temporary, cache->path))
+		unlink(temporary);
+}
+#endif /* mxScriptCache */
 #endif
 
 #endif  /* mxUseDefaultLoadModule */
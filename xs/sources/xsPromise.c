@@ -47,6 +47,10 @@ static void fxCallPromise(txMachine* the);
 static void fxCallPromiseAll(txMachine* the);
 static void fxCheckPromiseCapability(txMachine* the, txSlot* capability, txSlot** resolveFunction, txSlot** rejectFunction);
 static void fxQueueJob(txMachine* the, txID id);
+static txSlot* fxNextJobSlot(txMachine* the, txSlot** address);
+#if mxJobPool
+static void fxRecycleJob(txMachine* the, txSlot* item);
+#endif
 
 void fxBuildPromise(txMachine* the)
 {
@@ -918,52 +922,76 @@ void fx_Promise_prototype_then(txMachine* the)
 void fxQueueJob(txMachine* the, txID id)
 {
 	txInteger count, index;
+	txSlot* item;
 	txSlot* job;
 	txSlot* stack;
 	txSlot* slot;
-	txSlot** address;
 	
 	if (mxPendingJobs.value.reference->next == NULL) {
 		fxQueuePromiseJobs(the);
+		the->lastJob = mxPendingJobs.value.reference;
+	}
+#if mxJobPool
+	item = the->freeJobs;
+	if (item) {
+		the->freeJobs = item->next;
+		item->next = C_NULL;
+		the->freeJobCount--;
+		job = item->value.reference;
+		mxPushReference(job);
 	}
-	job = fxNewInstance(the);
+	else
+#endif
+	{
+		job = fxNewInstance(the);
+		item = fxNewSlot(the);
+		item->kind = XS_REFERENCE_KIND;
+		item->value.reference = job;
+	}
+	the->lastJob->next = item;
+	the->lastJob = item;
+	
 	stack = the->stack + 4;
-	slot = job->next = fxNewSlot(the);
+	slot = fxNextJobSlot(the, &(job->next));
 	slot->ID = id;
 	slot->kind = XS_INTEGER_KIND;
 	count = slot->value.integer = stack->value.integer;
 	stack += count;
-	for (index = 0; index < count; index++) {
-		slot = slot->next = fxNewSlot(the);
+	for (index = 0; index < count + 4; index++) {
+		slot = fxNextJobSlot(the, &(slot->next));
 		slot->kind = stack->kind;
 		slot->value = stack->value;
 		stack--;
 	}
-	slot = slot->next = fxNewSlot(the);
-	slot->kind = stack->kind;
-	slot->value = stack->value;
-	stack--;
-	slot = slot->next = fxNewSlot(the);
-	slot->kind = stack->kind;
-	slot->value = stack->value;
-	stack--;
-	slot = slot->next = fxNewSlot(the);
-	slot->kind = stack->kind;
-	slot->value = stack->value;
-	stack--;
-	slot = slot->next = fxNewSlot(the);
-	slot->kind = stack->kind;
-	slot->value = stack->value;
-	
-	address = &(mxPendingJobs.value.reference->next);
-	while ((slot = *address)) 
-		address = &(slot->next);
-	slot = *address = fxNewSlot(the);	
-	slot->kind = XS_REFERENCE_KIND;
-	slot->value.reference = job;
+	slot->next = C_NULL;
 	the->stack += 5 + count;
 }
 
+txSlot* fxNextJobSlot(txMachine* the, txSlot** address)
+{
+	txSlot* slot = *address;
+	if (!slot)
+		slot = *address = fxNewSlot(the);
+	return slot;
+}
+
+#if mxJobPool
+void fxRecycleJob(txMachine* the, txSlot* item)
+{
+	txSlot* slot;
+	if (the->freeJobCount < mxJobPoolCount) {
+		slot = item->value.reference->next;
+		while (slot) {
+			slot->kind = XS_UNDEFINED_KIND;
+			slot = slot->next;
+		}
+		item->next = the->freeJobs;
+		the->freeJobs = item;
+		the->freeJobCount++;
+	}
+}
+#endif
+
 void fxRunPromiseJobs(txMachine* the)
 {
 	txInteger count, index;
@@ -1001,9 +1029,12 @@ void fxRunPromiseJobs(txMachine* the)
 		}
 		mxCatch(the) {
 		}
-		job = job->next;
+		mxRunningJobs.value.reference->next = job->next;
+#if mxJobPool
+		fxRecycleJob(the, job);
+#endif
+		job = mxRunningJobs.value.reference->next;
 	}
-	mxRunningJobs.value.reference->next = C_NULL;
 }
 
 
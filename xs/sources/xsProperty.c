@@ -40,6 +40,9 @@
 txSlot* fxLastProperty(txMachine* the, txSlot* slot)
 {
 	txSlot* property;
+	if (slot->kind == XS_INSTANCE_KIND) {
+		mxShapeForget(slot);
+	}
 	while ((property = slot->next))
 		slot = property;
 	return slot;
@@ -198,6 +201,25 @@ txSlot* fxQueueKey(txMachine* the, txID id, txIndex index, txSlot* keys)
 	return keys;
 }
 
+txSlot* fxQueueAliasKeys(txMachine* the, txSlot* instance, txSlot* first, txFlag flag, txSlot* keys)
+{
+	txSlot* alias = the->aliasArray[instance->ID];
+	if (alias) {
+		txSlot* property = alias->next;
+		while (property) {
+			if (((flag & XS_EACH_NAME_FLAG) && fxIsKeyName(the, property->ID)) || ((flag & XS_EACH_SYMBOL_FLAG) && fxIsKeySymbol(the, property->ID))) {
+				txSlot* shared = first;
+				while (shared && (shared->ID != property->ID))
+					shared = shared->next;
+				if (!shared)
+					keys = fxQueueKey(the, property->ID, XS_NO_ID, keys);
+			}
+			property = property->next;
+		}
+	}
+	return keys;
+}
+
 txSlot* fxQueueIDKeys(txMachine* the, txSlot* first, txFlag flag, txSlot* keys)
 {
 	if (flag & XS_EACH_NAME_FLAG) {
@@ -40,6 +40,31 @@
 static txSlot* fxCheckRegExpInstance(txMachine* the, txSlot* slot);
 static void fxExecuteRegExp(txMachine* the, txSlot* regexp, txSlot* argument);
 #endif
+#if mxRegExp && mxRegExpCache
+typedef struct sxRegExpCacheEntry txRegExpCacheEntry;
+struct sxRegExpCacheEntry {
+	txRegExpCacheEntry* previous;
+	txRegExpCacheEntry* next;
+	txU4 sum;
+	txInteger usage;
+	txSize size;
+	txSize codeSize;
+	txSize dataSize;
+	txString pattern;
+	txString modifier;
+	txString names;
+	txInteger* code;
+};
+static void fxCacheRegExp(txMachine* the, txString pattern, txString modifier, txSlot* regexp);
+static txBoolean fxGetCachedRegExp(txMachine* the, txString pattern, txString modifier, txSlot* regexp);
+static void fxReleaseCachedRegExp(txRegExpCacheEntry* entry);
+static txU4 fxSumCachedRegExp(txString pattern, txString modifier);
+
+static txRegExpCacheEntry* gxFirstCachedRegExp = C_NULL;
+static txRegExpCacheEntry* gxLastCachedRegExp = C_NULL;
+static txInteger gxCachedRegExpCount = 0;
+static txSize gxCachedRegExpSize = 0;
+#endif
 
 static void fx_RegExp_prototype_get_flag(txMachine* the, txU4 flag);
 static void fx_RegExp_prototype_split_aux(txMachine* the, txSlot* string, txIndex start, txIndex stop, txSlot* item);
@@ -125,12 +150,174 @@ void fxInitializeRegExp(txMachine* the)
         key->kind = XS_KEY_X_KIND;
     pattern = key->value.key.string = mxArgv(0)->value.string;
 	modifier = mxArgv(1)->value.string;
-	if (!fxCompileRegExp(the, pattern, modifier, &regexp->value.regexp.code, &regexp->value.regexp.data, the->nameBuffer, sizeof(the->nameBuffer)))
-		mxSyntaxError("invalid regular expression: %s", the->nameBuffer);
+#if mxRegExpCache
+	if (!fxGetCachedRegExp(the, pattern, modifier, regexp))
+#endif
+	{
+		if (!fxCompileRegExp(the, pattern, modifier, &regexp->value.regexp.code, &regexp->value.regexp.data, the->nameBuffer, sizeof(the->nameBuffer)))
+			mxSyntaxError("invalid regular expression: %s", the->nameBuffer);
+	#if mxRegExpCache
+		fxCacheRegExp(the, mxArgv(0)->value.string, mxArgv(1)->value.string, regexp);
+	#endif
+	}
 	*mxResult = *mxThis;
 #endif
 }
 
+#if mxRegExp && mxRegExpCache
+void fxCacheRegExp(txMachine* the, txString pattern, txString modifier, txSlot* regexp)
+{
+	txInteger* code = regexp->value.regexp.code;
+	txSize codeSize = ((txChunk*)(((txByte*)code) - sizeof(txChunk)))->size - sizeof(txChunk);
+	txSize dataSize = ((txChunk*)(((txByte*)regexp->value.regexp.data) - sizeof(txChunk)))->size - sizeof(txChunk);
+	txSize patternSize = c_strlen(pattern) + 1;
+	txSize modifierSize = c_strlen(modifier) + 1;
+	txSize namesSize = 0;
+	txSize size;
+	txInteger count = code[1], index;
+	txU4 sum = fxSumCachedRegExp(pattern, modifier);
+	txRegExpCacheEntry* entry;
+	txRegExpCacheEntry* former;
+	txString name;
+	for (index = 0; index < count; index++) {
+		txID id = (txID)code[2 + index];
+		namesSize += ((id != XS_NO_ID) ? c_strlen(fxGetKeyName(the, id)) : 0) + 1;
+	}
+	size = sizeof(txRegExpCacheEntry) + codeSize + patternSize + modifierSize + namesSize;
+	if (size > (mxRegExpCacheSize / 4))
+		return;
+	entry = c_malloc(size);
+	if (!entry)
+		return;
+	entry->previous = C_NULL;
+	entry->sum = sum;
+	entry->usage = 1;
+	entry->size = size;
+	entry->codeSize = codeSize;
+	entry->dataSize = dataSize;
+	entry->code = (txInteger*)(entry + 1);
+	c_memcpy(entry->code, code, codeSize);
+	entry->pattern = ((txString)entry->code) + codeSize;
+	c_memcpy(entry->pattern, pattern, patternSize);
+	entry->modifier = entry->pattern + patternSize;
+	c_memcpy(entry->modifier, modifier, modifierSize);
+	entry->names = name = entry->modifier + modifierSize;
+	for (index = 0; index < count; index++) {
+		txID id = (txID)code[2 + index];
+		if (id != XS_NO_ID) {
+			txString string = fxGetKeyName(the, id);
+			txSize length = c_strlen(string);
+			c_memcpy(name, string, length);
+			name += length;
+		}
+		*name++ = 0;
+	}
+	fxLockSharedCache();
+	former = gxFirstCachedRegExp;
+	while (former) {
+		if ((former->sum == sum) && !c_strcmp(former->pattern, pattern) && !c_strcmp(former->modifier, modifier))
+			break;
+		former = former->next;
+	}
+	if (!former) {
+		entry->next = gxFirstCachedRegExp;
+		if (gxFirstCachedRegExp)
+			gxFirstCachedRegExp->previous = entry;
+		else
+			gxLastCachedRegExp = entry;
+		gxFirstCachedRegExp = entry;
+		gxCachedRegExpCount++;
+		gxCachedRegExpSize += size;
+		while ((gxCachedRegExpCount > mxRegExpCacheCount) || (gxCachedRegExpSize > mxRegExpCacheSize)) {
+			txRegExpCacheEntry* last = gxLastCachedRegExp;
+			gxLastCachedRegExp = last->previous;
+			gxLastCachedRegExp->next = C_NULL;
+			gxCachedRegExpCount--;
+			gxCachedRegExpSize -= last->size;
+			if (--last->usage == 0)
+				c_free(last);
+		}
+		entry = C_NULL;
+	}
+	fxUnlockSharedCache();
+	if (entry)
+		c_free(entry);
+}
+
+txBoolean fxGetCachedRegExp(txMachine* the, txString pattern, txString modifier, txSlot* regexp)
+{
+	txU4 sum = fxSumCachedRegExp(pattern, modifier);
+	txRegExpCacheEntry* entry;
+	txString name;
+	txInteger count, index;
+	fxLockSharedCache();
+	entry = gxFirstCachedRegExp;
+	while (entry) {
+		if ((entry->sum == sum) && !c_strcmp(entry->pattern, pattern) && !c_strcmp(entry->modifier, modifier))
+			break;
+		entry = entry->next;
+	}
+	if (entry) {
+		if (entry->previous) {
+			entry->previous->next = entry->next;
+			if (entry->next)
+				entry->next->previous = entry->previous;
+			else
+				gxLastCachedRegExp = entry->previous;
+			entry->previous = C_NULL;
+			entry->next = gxFirstCachedRegExp;
+			gxFirstCachedRegExp->previous = entry;
+			gxFirstCachedRegExp = entry;
+		}
+		entry->usage++;
+	}
+	fxUnlockSharedCache();
+	if (!entry) {
+	#ifdef mxInstrument
+		the->regExpCacheMissCount++;
+	#endif
+		return 0;
+	}
+#ifdef mxInstrument
+	the->regExpCacheHitCount++;
+#endif
+	regexp->value.regexp.data = fxNewChunk(the, entry->dataSize);
+	regexp->value.regexp.code = fxNewChunk(the, entry->codeSize);
+	c_memcpy(regexp->value.regexp.code, entry->code, entry->codeSize);
+	// capture names are keys, resolve them in this machine
+	count = entry->code[1];
+	name = entry->names;
+	for (index = 0; index < count; index++) {
+		if (*name) {
+			txID id = fxNewNameC(the, name);
+			regexp->value.regexp.code[2 + index] = id;
+		}
+		name += c_strlen(name) + 1;
+	}
+	fxReleaseCachedRegExp(entry);
+	return 1;
+}
+
+void fxReleaseCachedRegExp(txRegExpCacheEntry* entry)
+{
+	fxLockSharedCache();
+	if (--entry->usage == 0)
+		c_free(entry);
+	fxUnlockSharedCache();
+}
+
+txU4 fxSumCachedRegExp(txString pattern, txString modifier)
+{
+	txU4 sum = 0;
+	txU1 c;
+	while ((c = c_read8(pattern++)))
+		sum = (sum << 1) + c;
+	while ((c = c_read8(modifier++)))
+		sum = (sum << 1) + c;
+	return sum;
+}
+#endif
+
 txBoolean fxIsRegExp(txMachine* the, txSlot* slot)
 {
 #if mxRegExp
@@ -437,7 +624,7 @@ void fx_RegExp_prototype_exec(txMachine* the)
 	globalFlag = (flags & XS_REGEXP_G) ? 1 : 0;
 	namedFlag = (flags & XS_REGEXP_N) ? 1 : 0;
 	stickyFlag = (flags & XS_REGEXP_Y) ? 1 : 0;
-	offset = (globalFlag || stickyFlag) ? fxUnicodeToUTF8Offset(argument->value.string, lastIndex) : 0;
+	offset = (globalFlag || stickyFlag) ? fxStringUnicodeToUTF8Offset(the, argument->value.string, lastIndex) : 0;
 
 	if (fxMatchRegExp(the, regexp->value.regexp.code, regexp->value.regexp.data, argument->value.string, offset)) {
 		txSlot* array;
@@ -448,7 +635,7 @@ void fx_RegExp_prototype_exec(txMachine* the)
 		txInteger index;
 		txInteger length;
 		if (globalFlag || stickyFlag) {
-			lastIndex = fxUTF8ToUnicodeOffset(argument->value.string, regexp->value.regexp.data[1]);
+			lastIndex = fxStringUTF8ToUnicodeOffset(the, argument->value.string, regexp->value.regexp.data[1]);
 			mxPushInteger(lastIndex);
 			mxPushSlot(mxThis);
 			fxSetID(the, mxID(_lastIndex));
@@ -488,7 +675,7 @@ void fx_RegExp_prototype_exec(txMachine* the)
 		item = item->next = fxNewSlot(the);
 		item->ID = mxID(_index);
 		item->kind = XS_INTEGER_KIND;
-		item->value.integer = fxUTF8ToUnicodeOffset(argument->value.string, regexp->value.regexp.data[0]);
+		item->value.integer = fxStringUTF8ToUnicodeOffset(the, argument->value.string, regexp->value.regexp.data[0]);
 		item = item->next = fxNewSlot(the);
 		item->ID = mxID(_input);
 		item->value.string = argument->value.string;
@@ -622,7 +809,7 @@ void fx_RegExp_prototype_replace(txMachine* the)
 	}
 	list = item = fxNewInstance(the);
 	mxPushSlot(list);
-	size = fxUnicodeLength(argument->value.string);
+	size = fxStringUnicodeLength(the, argument->value.string);
 	utf8Size = c_strlen(argument->value.string);
 	former = 0;
 	for (;;) {
@@ -685,7 +872,7 @@ void fx_RegExp_prototype_replace(txMachine* the)
             else {
  				mxPushSlot(result);
 				fxGetID(the, mxID(_groups));
-				fxPushSubstitutionString(the, argument, utf8Size, fxUnicodeToUTF8Offset(argument->value.string, position), matched, c_strlen(matched->value.string), i - 1, the->stack + 1, the->stack, replacement);
+				fxPushSubstitutionString(the, argument, utf8Size, fxStringUnicodeToUTF8Offset(the, argument->value.string, position), matched, c_strlen(matched->value.string), i - 1, the->stack + 1, the->stack, replacement);
                 item = item->next = fxNewSlot(the);
                 mxPullSlot(item);
                 the->stack += 1 + i;			
@@ -845,7 +1032,7 @@ void fx_RegExp_prototype_split(txMachine* the)
 	item = fxLastProperty(the, array);
 	if (!limit)
 		goto bail;
-	size = fxUnicodeLength(argument->value.string);
+	size = fxStringUnicodeLength(the, argument->value.string);
 	if (size == 0) {
 		fxExecuteRegExp(the, splitter, argument);
 		if (the->stack->kind == XS_NULL_KIND) {
@@ -920,7 +1107,7 @@ bail:
 void fx_RegExp_prototype_split_aux(txMachine* the, txSlot* string, txIndex start, txIndex stop, txSlot* item)
 {
 #if mxRegExp
-	txInteger offset = fxUnicodeToUTF8Offset(string->value.string, start);
+	txInteger offset = fxStringUnicodeToUTF8Offset(the, string->value.string, start);
 	txInteger length = fxUnicodeToUTF8Offset(string->value.string + offset, stop - start);
 	if ((offset >= 0) && (length > 0)) {
 		item->value.string = (txString)fxNewChunk(the, length + 1);
@@ -350,6 +350,9 @@ void fxRunID(txMachine* the, txSlot* generator, txID id)
 	register txU1 byte = 0;
 	register txU4 index;
 	register txS4 offset;
+#if mxInlineCache
+	txInlineCache* cache;
+#endif
 #if defined(__GNUC__) && defined(__OPTIMIZE__)
 	static void *const ICACHE_RAM_ATTR gxBytes[] = {
 		&&XS_NO_CODE,
@@ -403,6 +406,8 @@ void fxRunID(txMachine* the, txSlot* generator, txID id)
 		&&XS_CODE_CURRENT,
 		&&XS_CODE_DEBUGGER,
 		&&XS_CODE_DECREMENT,
+		&&XS_CODE_DECREMENT_LOCAL_1,
+		&&XS_CODE_DECREMENT_LOCAL_2,
 		&&XS_CODE_DELETE_PROPERTY,
 		&&XS_CODE_DELETE_PROPERTY_AT,
 		&&XS_CODE_DELETE_SUPER,
@@ -432,6 +437,8 @@ void fxRunID(txMachine* the, txSlot* generator, txID id)
 		&&XS_CODE_GET_CLOSURE_2,
 		&&XS_CODE_GET_LOCAL_1,
 		&&XS_CODE_GET_LOCAL_2,
+		&&XS_CODE_GET_LOCAL_APPEND_1,
+		&&XS_CODE_GET_LOCAL_APPEND_2,
 		&&XS_CODE_GET_PROPERTY,
 		&&XS_CODE_GET_PROPERTY_AT,
 		&&XS_CODE_GET_SUPER,
@@ -442,6 +449,8 @@ void fxRunID(txMachine* the, txSlot* generator, txID id)
 		&&XS_CODE_HOST,
 		&&XS_CODE_IN,
 		&&XS_CODE_INCREMENT,
+		&&XS_CODE_INCREMENT_LOCAL_1,
+		&&XS_CODE_INCREMENT_LOCAL_2,
 		&&XS_CODE_INSTANCEOF,
 		&&XS_CODE_INSTANTIATE,
 		&&XS_CODE_INTEGER_1,
@@ -1397,9 +1406,43 @@ XS_CODE_JUMP:
 			#endif
 			if (variable->kind < 0)
 				mxRunDebugID(XS_REFERENCE_ERROR, "get %s: not initialized yet", variable->ID);
+		#if mxStringAppend
+			if (variable == the->appendSlot)
+				the->appendSlot = C_NULL;
+		#endif
+			mxPushKind(variable->kind);
+			mxStack->value = variable->value;
+			mxBreak;
+		mxCase(XS_CODE_GET_LOCAL_APPEND_1)
+			index = mxRunU1(1);
+			mxNextCode(2);
+			goto XS_CODE_GET_LOCAL_APPEND_ALL;
+		mxCase(XS_CODE_GET_LOCAL_APPEND_2)
+			index = mxRunU2(1);
+			mxNextCode(3);
+		XS_CODE_GET_LOCAL_APPEND_ALL:
+		#if mxStringAppend
+		#ifdef mxTrace
+			if (gxDoTrace) fxTraceIndex(the, index - 2);
+		#endif
+			variable = mxFrame - index;
+			#ifdef mxDebug
+				offset = variable->ID;
+			#endif
+			if (variable->kind < 0)
+				mxRunDebugID(XS_REFERENCE_ERROR, "get %s: not initialized yet", variable->ID);
 			mxPushKind(variable->kind);
 			mxStack->value = variable->value;
+			if (variable == the->appendSlot) {
+				if (the->appendStack)
+					the->appendSlot = C_NULL;
+				else
+					the->appendStack = mxStack;
+			}
 			mxBreak;
+		#else
+			goto XS_CODE_GET_LOCAL;
+		#endif
 			
 		mxCase(XS_CODE_LET_CLOSURE_1)
 			index = mxRunU1(1);
@@ -1952,7 +1995,21 @@ XS_CODE_JUMP:
 			mxToInstance(mxStack);
 			offset = mxRunS2(1);
 			index = XS_NO_ID;
+		#if mxInlineCache
+			cache = mxInlineCacheAt(the, mxCode);
+			if (mxInlineCacheHit(the, cache, mxCode, variable)) {
+			#ifdef mxInstrument
+				the->inlineCacheHitCount++;
+			#endif
+				slot = mxInlineCacheProperty(the, cache, variable);
+			}
+			else
+				slot = fxGetCachedProperty(the, cache, mxCode, variable, (txID)offset);
+			mxNextCode(3);
+			goto XS_CODE_GET_ALL;
+		#else
 			mxNextCode(3);
+		#endif
 			/* continue */
 		XS_CODE_GET_PROPERTY_ALL:	
 			slot = mxBehaviorGetProperty(the, variable, (txID)offset, index, XS_ANY);
@@ -2068,7 +2125,25 @@ XS_CODE_JUMP:
 			mxToInstance(mxStack + 1);
 			offset = mxRunS2(1);
 			index = XS_NO_ID;
+		#if mxInlineCache
+			cache = mxInlineCacheAt(the, mxCode);
+			if (mxInlineCacheHit(the, cache, mxCode, variable) && (cache->own || (cache->property->kind == XS_ACCESSOR_KIND) || (cache->property->flag & XS_DONT_SET_FLAG))) {
+			#ifdef mxInstrument
+				the->inlineCacheHitCount++;
+			#endif
+				slot = mxInlineCacheProperty(the, cache, variable);
+				mxNextCode(3);
+			}
+			else {
+				mxSaveState;
+				slot = fxSetCachedProperty(the, variable, (txID)offset);
+				mxRestoreState;
+				mxNextCode(3);
+			}
+			goto XS_CODE_SET_ALL;
+		#else
 			mxNextCode(3);
+		#endif
 			/* continue */
 		XS_CODE_SET_PROPERTY_ALL:	
 			mxSaveState;
@@ -2518,7 +2593,7 @@ XS_CODE_JUMP:
 			mxBreak;
 			
 		mxCase(XS_CODE_DECREMENT)
-			if (mxStack->kind == XS_INTEGER_KIND) {
+			if ((mxStack->kind == XS_INTEGER_KIND) && (mxStack->value.integer != (txInteger)0x80000000)) {
 				mxStack->value.integer--;
 			}
 			else {
@@ -2528,7 +2603,7 @@ XS_CODE_JUMP:
 			mxNextCode(1);
 			mxBreak;
 		mxCase(XS_CODE_INCREMENT)
-			if (mxStack->kind == XS_INTEGER_KIND)
+			if ((mxStack->kind == XS_INTEGER_KIND) && (mxStack->value.integer != 0x7FFFFFFF))
 				mxStack->value.integer++;
 			else {
 				mxToNumber(mxStack);
@@ -2536,6 +2611,56 @@ XS_CODE_JUMP:
 			}
 			mxNextCode(1);
 			mxBreak;
+		mxCase(XS_CODE_DECREMENT_LOCAL_1)
+			index = mxRunU1(1);
+			mxNextCode(2);
+			offset = -1;
+			goto XS_CODE_INCREMENT_LOCAL;
+		mxCase(XS_CODE_DECREMENT_LOCAL_2)
+			index = mxRunU2(1);
+			mxNextCode(3);
+			offset = -1;
+			goto XS_CODE_INCREMENT_LOCAL;
+		mxCase(XS_CODE_INCREMENT_LOCAL_1)
+			index = mxRunU1(1);
+			mxNextCode(2);
+			offset = 1;
+			goto XS_CODE_INCREMENT_LOCAL;
+		mxCase(XS_CODE_INCREMENT_LOCAL_2)
+			index = mxRunU2(1);
+			mxNextCode(3);
+			offset = 1;
+		XS_CODE_INCREMENT_LOCAL:
+#ifdef mxTrace
+			if (gxDoTrace) fxTraceIndex(the, index - 2);
+#endif
+			variable = mxFrame - index;
+			if (variable->kind < 0)
+				mxRunDebugID(XS_REFERENCE_ERROR, "get %s: not initialized yet", variable->ID);
+		#if mxStringAppend
+			if (variable == the->appendSlot)
+				the->appendSlot = C_NULL;
+		#endif
+			if ((variable->kind == XS_INTEGER_KIND) && (variable->value.integer != ((offset > 0) ? 0x7FFFFFFF : (txInteger)0x80000000))) {
+				if (!(variable->flag & XS_DONT_SET_FLAG)) {
+					variable->value.integer += offset;
+					mxBreak;
+				}
+			}
+			mxPushKind(variable->kind);
+			mxStack->value = variable->value;
+			if ((mxStack->kind == XS_INTEGER_KIND) && (mxStack->value.integer != ((offset > 0) ? 0x7FFFFFFF : (txInteger)0x80000000)))
+				mxStack->value.integer += offset;
+			else {
+				mxToNumber(mxStack);
+				mxStack->value.number += offset;
+			}
+			if (variable->flag & XS_DONT_SET_FLAG)
+				mxRunDebugID(XS_TYPE_ERROR, "set %s: const", variable->ID);
+			variable->kind = mxStack->kind;
+			variable->value = mxStack->value;
+			mxStack++;
+			mxBreak;
 			
 		mxCase(XS_CODE_ADD)
 			slot = mxStack + 1;
@@ -2582,7 +2707,22 @@ XS_CODE_JUMP:
 				if ((slot->kind == XS_STRING_KIND) || (slot->kind == XS_STRING_X_KIND) || (mxStack->kind == XS_STRING_KIND) || (mxStack->kind == XS_STRING_X_KIND)) {
 					fxToString(the, slot);
 					fxToString(the, mxStack);
-					fxConcatString(the, slot, mxStack);
+				#if mxStringAppend
+					variable = C_NULL;
+					offset = mxRunU1(1);
+					if ((offset == XS_CODE_PULL_LOCAL_1) || ((offset == XS_CODE_SET_LOCAL_1) && (mxRunU1(3) == XS_CODE_POP))) {
+						index = mxRunU1(2);
+						variable = mxFrame - index;
+					}
+					else if ((offset == XS_CODE_PULL_LOCAL_2) || ((offset == XS_CODE_SET_LOCAL_2) && (mxRunU1(4) == XS_CODE_POP))) {
+						index = mxRunU2(2);
+						variable = mxFrame - index;
+					}
+					if (variable)
+						fxAppendString(the, variable, slot, mxStack);
+					else
+				#endif
+						fxConcatString(the, slot, mxStack);
 				}
 				else {
 					mxToNumber(slot);
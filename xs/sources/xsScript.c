@@ -52,6 +52,7 @@ void fxInitializeParser(txParser* parser, void* console, txSize bufferSize, txSi
 	c_memset(parser, 0, sizeof(txParser));
 	parser->first = C_NULL;
 	parser->console = console;
+	parser->optimizeFlag = mxOptimizeCode;
 
 	parser->buffer = fxNewParserChunk(parser, bufferSize);
 	parser->bufferSize = bufferSize;
@@ -121,13 +122,33 @@ void fxInitializeParser(txParser* parser, void* console, txSize bufferSize, txSi
 
 void* fxNewParserChunk(txParser* parser, txSize size)
 {
-	txParserChunk* block = c_malloc(sizeof(txParserChunk) + size);
+	txParserChunk* block;
+	char* result;
+	size = (size + 7) & ~7;
+	if (parser->arena && (size <= parser->arenaLimit - parser->arena)) {
+		result = parser->arena;
+		parser->arena += size;
+		return result;
+	}
+	if (size > (mxParserArenaSize >> 2)) {
+		block = c_malloc(sizeof(txParserChunk) + size);
+		if (!block)
+			fxThrowMemoryError(parser);
+		parser->total += sizeof(txParserChunk) + size;
+		block->next = parser->first;
+		parser->first = block;
+		return block + 1;
+	}
+	block = c_malloc(sizeof(txParserChunk) + mxParserArenaSize);
 	if (!block)
 		fxThrowMemoryError(parser);
-	parser->total += sizeof(txParserChunk) + size;
+	parser->total += sizeof(txParserChunk) + mxParserArenaSize;
 	block->next = parser->first;
 	parser->first = block;
-	return block + 1;
+	result = (char*)(block + 1);
+	parser->arena = result + size;
+	parser->arenaLimit = result + mxParserArenaSize;
+	return result;
 }
 
 void* fxNewParserChunkClear(txParser* parser, txSize size)
@@ -182,6 +203,33 @@ txSymbol* fxNewParserSymbol(txParser* parser, txString theString)
 	return aSymbol;
 }
 
+int fxParserSourceGetter(void* theStream)
+{
+	txParserSource* source = (txParserSource*)theStream;
+	int result = C_EOF;
+	if (source->offset < source->size) {
+		result = (txU1)source->buffer[source->offset];
+		source->offset++;
+	}
+	return result;
+}
+
+#if mxLinux || mxMacOSX || mxWindows
+void fxReadParserSource(txParser* parser, void* stream, txParserSource* source)
+{
+	FILE* file = stream;
+	long size;
+	mxParserThrowElse(fseek(file, 0, SEEK_END) == 0);
+	size = ftell(file);
+	mxParserThrowElse((size >= 0) && (size < 0x7FFFFFFF));
+	mxParserThrowElse(fseek(file, 0, SEEK_SET) == 0);
+	source->buffer = fxNewParserChunk(parser, (txSize)size);
+	source->offset = 0;
+	source->size = (txSize)fread(source->buffer, 1, size, file);
+	mxParserThrowElse(!ferror(file));
+}
+#endif
+
 void fxReportParserError(txParser* parser, txString theFormat, ...)
 {
 	c_va_list arguments;
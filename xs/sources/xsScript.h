@@ -40,6 +40,13 @@
 
 #include "xsCommon.h"
 
+#ifndef mxParserArenaSize
+	#define mxParserArenaSize (32 * 1024)
+#endif
+#ifndef mxOptimizeCode
+	#define mxOptimizeCode 0
+#endif
+
 typedef void (*txReport)(void* console, txString thePath, txInteger theLine, txString theFormat, c_va_list theArguments);
 
 typedef txS2 txToken;
@@ -52,6 +59,7 @@ typedef struct sxScope txScope;
 typedef struct sxParser txParser;
 typedef struct sxParserChunk txParserChunk;
 typedef struct sxParserJump txParserJump;
+typedef struct sxParserSource txParserSource;
 
 typedef struct sxByteCode txByteCode;
 typedef struct sxBranchCode txBranchCode;
@@ -523,6 +531,12 @@ struct sxParserChunk {
 	txParserChunk* next;
 };
 
+struct sxParserSource {
+	txString buffer;
+	txSize offset;
+	txSize size;
+};
+
 struct sxScope {
 	txParser* parser;
 	txScope* scope;
@@ -548,6 +562,8 @@ struct sxParserJump {
 
 struct sxParser {
 	txParserChunk* first;
+	char* arena;
+	char* arenaLimit;
 	txParserJump* firstJump;
 	void* console;
 	int error;
@@ -563,11 +579,13 @@ struct sxParser {
 	
 	void* stream;
 	txGetter getter;
+	txParserSource* source;
 	txSymbol* origin;
 	txSymbol* path;
 	txString name;
 	
 	int cFlag;
+	int optimizeFlag;
 	txUnsigned flags;
 	
 	int ahead;
@@ -842,6 +860,8 @@ extern void* fxNewParserChunk(txParser* parser, txSize size);
 extern void* fxNewParserChunkClear(txParser* parser, txSize size);
 extern txString fxNewParserString(txParser* parser, txString buffer, txSize size);
 extern txSymbol* fxNewParserSymbol(txParser* parser, txString buffer);
+extern int fxParserSourceGetter(void* stream);
+extern void fxReadParserSource(txParser* parser, void* stream, txParserSource* source);
 extern void fxReportReferenceError(txParser* parser, txString theFormat, ...);
 extern void fxReportParserError(txParser* parser, txString theFormat, ...);
 extern void fxReportParserWarning(txParser* parser, txString theFormat, ...);
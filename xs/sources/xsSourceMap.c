@@ -59,6 +59,7 @@ void fxParserSourceMap(txParser* parser, void* theStream, txGetter theGetter, tx
 	parser->root = NULL;
 	parser->stream = theStream;
 	parser->getter = theGetter;
+	parser->source = (theGetter == fxParserSourceGetter) ? (txParserSource*)theStream : C_NULL;
 	
 	parser->line2 = 1;
 	parser->crlf2 = 0;
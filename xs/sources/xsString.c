@@ -170,9 +170,9 @@ void fxStringAccessorGetter(txMachine* the)
 		mxResult->kind = XS_INTEGER_KIND;
 	}
 	else {
-		txInteger from = fxUnicodeToUTF8Offset(string->value.key.string, index);
+		txInteger from = fxStringUnicodeToUTF8Offset(the, string->value.key.string, index);
 		if (from >= 0) {
-			txInteger to = fxUnicodeToUTF8Offset(string->value.key.string, index + 1);
+			txInteger to = fxStringUnicodeToUTF8Offset(the, string->value.key.string, index + 1);
 			if (to >= 0) {
 				mxResult->value.string = fxNewChunk(the, to - from + 1);
 				c_memcpy(mxResult->value.string, string->value.key.string + from, to - from);
@@ -213,8 +213,8 @@ txBoolean fxStringGetOwnProperty(txMachine* the, txSlot* instance, txID id, txIn
 	}
 	if (!id && (mxStringInstanceLength(instance) > index)) {
 		txSlot* string = instance->next;
-		txInteger from = fxUnicodeToUTF8Offset(string->value.key.string, index);
-		txInteger to = fxUnicodeToUTF8Offset(string->value.key.string, index + 1);
+		txInteger from = fxStringUnicodeToUTF8Offset(the, string->value.key.string, index);
+		txInteger to = fxStringUnicodeToUTF8Offset(the, string->value.key.string, index + 1);
 		descriptor->value.string = fxNewChunk(the, to - from + 1);
 		c_memcpy(descriptor->value.string, string->value.key.string + from, to - from);
 		descriptor->value.string[to - from] = 0;
@@ -295,7 +295,7 @@ void fx_String(txMachine* the)
 	instance = fxNewStringInstance(the);
 	instance->next->kind = slot->kind; // @@
 	instance->next->value.key.string = slot->value.string;
-	instance->next->value.key.sum = fxUnicodeLength(slot->value.string);	
+	instance->next->value.key.sum = fxStringUnicodeLength(the, slot->value.string);	
 	mxPullSlot(mxResult);
 }
 
@@ -486,13 +486,13 @@ void fx_String_prototype_charAt(txMachine* the)
 	txInteger anOffset;
 
 	aString = fxCoerceToString(the, mxThis);
-	aLength = fxUnicodeLength(aString);
+	aLength = fxStringUnicodeLength(the, aString);
 	if ((mxArgc > 0) && (mxArgv(0)->kind != XS_UNDEFINED_KIND))
 		anOffset = fxToInteger(the, mxArgv(0));
 	else
 		anOffset = 0;
 	if ((0 <= anOffset) && (anOffset < aLength)) {
-		anOffset = fxUnicodeToUTF8Offset(aString, anOffset);
+		anOffset = fxStringUnicodeToUTF8Offset(the, aString, anOffset);
 		aLength = fxUnicodeToUTF8Offset(aString + anOffset, 1);
 		if ((anOffset >= 0) && (aLength > 0)) {
 			mxResult->value.string = (txString)fxNewChunk(the, aLength + 1);
@@ -518,13 +518,13 @@ void fx_String_prototype_charCodeAt(txMachine* the)
 	txInteger anOffset;
 
 	aString = fxCoerceToString(the, mxThis);
-	aLength = fxUnicodeLength(aString);
+	aLength = fxStringUnicodeLength(the, aString);
 	if ((mxArgc > 0) && (mxArgv(0)->kind != XS_UNDEFINED_KIND))
 		anOffset = fxToInteger(the, mxArgv(0));
 	else
 		anOffset = 0;
 	if ((0 <= anOffset) && (anOffset < aLength)) {
-		anOffset = fxUnicodeToUTF8Offset(aString, anOffset);
+		anOffset = fxStringUnicodeToUTF8Offset(the, aString, anOffset);
 		aLength = fxUnicodeToUTF8Offset(aString + anOffset, 1);
 		if ((anOffset >= 0) && (aLength > 0)) {
 			fxUTF8Decode(aString + anOffset, &mxResult->value.integer);
@@ -544,12 +544,12 @@ void fx_String_prototype_charCodeAt(txMachine* the)
 void fx_String_prototype_codePointAt(txMachine* the)
 {
 	txString string = fxCoerceToString(the, mxThis);
-	txInteger length = fxUnicodeLength(string);
+	txInteger length = fxStringUnicodeLength(the, string);
 	txNumber at = (mxArgc > 0) ? fxToNumber(the, mxArgv(0)) : 0;
 	if (c_isnan(at))
 		at = 0;
 	if ((0 <= at) && (at < (txNumber)length)) {
-		txInteger offset = fxUnicodeToUTF8Offset(string, (txInteger)at);
+		txInteger offset = fxStringUnicodeToUTF8Offset(the, string, (txInteger)at);
 		length = fxUnicodeToUTF8Offset(string + offset, 1);
 		if ((offset >= 0) && (length > 0)) {
 			fxUTF8Decode(string + offset, &mxResult->value.integer);
@@ -577,23 +577,32 @@ void fx_String_prototype_concat(txMachine* the)
 	txInteger aCount;
 	txInteger aLength;
 	txInteger anIndex;
+	txInteger aSize;
+	txString aString;
 	
 	fxCoerceToString(the, mxThis);
 	aCount = mxArgc;
 	aLength = c_strlen(mxThis->value.string);
 	for (anIndex = 0; anIndex < aCount; anIndex++)
 		aLength += c_strlen(fxToString(the, mxArgv(anIndex)));
-	mxResult->value.string = (txString)fxNewChunk(the, aLength + 1);
+	aString = (txString)fxNewChunk(the, aLength + 1);
+	aSize = c_strlen(mxThis->value.string);
+	c_memcpy(aString, mxThis->value.string, aSize);
+	aLength = aSize;
+	for (anIndex = 0; anIndex < aCount; anIndex++) {
+		aSize = c_strlen(mxArgv(anIndex)->value.string);
+		c_memcpy(aString + aLength, mxArgv(anIndex)->value.string, aSize);
+		aLength += aSize;
+	}
+	aString[aLength] = 0;
+	mxResult->value.string = aString;
 	mxResult->kind = XS_STRING_KIND;
-	c_strcpy(mxResult->value.string, mxThis->value.string);
-	for (anIndex = 0; anIndex < aCount; anIndex++)
-		c_strcat(mxResult->value.string, mxArgv(anIndex)->value.string);
 }
 
 void fx_String_prototype_endsWith(txMachine* the)
 {
 	txString string = fxCoerceToString(the, mxThis);
-	txInteger length = fxUnicodeLength(string);
+	txInteger length = fxStringUnicodeLength(the, string);
 	txString searchString;
 	txInteger searchLength;
 	txInteger offset;
@@ -605,7 +614,7 @@ void fx_String_prototype_endsWith(txMachine* the)
 		mxTypeError("future editions");
 	searchString = fxToString(the, mxArgv(0));
 	searchLength = c_strlen(searchString);
-	offset = fxUnicodeToUTF8Offset(string, fxArgToPosition(the, 1, length, length));
+	offset = fxStringUnicodeToUTF8Offset(the, string, fxArgToPosition(the, 1, length, length));
 	if (offset < searchLength)
 		return;
 	if (!c_strncmp(string + offset - searchLength, searchString, searchLength))
@@ -627,7 +636,7 @@ void fx_String_prototype_includes(txMachine* the)
 		mxTypeError("future editions");
 	searchString = fxToString(the, mxArgv(0));
 	searchLength = c_strlen(searchString);
-	offset = fxUnicodeToUTF8Offset(string, fxArgToPosition(the, 1, 0, fxUnicodeLength(string)));
+	offset = fxStringUnicodeToUTF8Offset(the, string, fxArgToPosition(the, 1, 0, fxStringUnicodeLength(the, string)));
 	if ((length - offset) < searchLength)
 		return;
 	if (c_strstr(string + offset, searchString))
@@ -653,7 +662,7 @@ void fx_String_prototype_indexOf(txMachine* the)
 		return;
 	}
 	aSubString = fxToString(the, mxArgv(0));
-	aLength = fxUnicodeLength(aString);
+	aLength = fxStringUnicodeLength(the, aString);
 	aSubLength = fxUnicodeLength(aSubString);
 	anOffset = 0;
 	if ((mxArgc > 1) && (mxArgv(1)->kind != XS_UNDEFINED_KIND)) {
@@ -661,7 +670,7 @@ void fx_String_prototype_indexOf(txMachine* the)
 		anOffset = (c_isnan(aNumber)) ? 0 : (aNumber < 0) ? 0 : (aNumber > aLength) ? aLength : (txInteger)c_floor(aNumber);
 	}
 	if (anOffset + aSubLength <= aLength) {
-		anOffset = fxUnicodeToUTF8Offset(aString, anOffset);
+		anOffset = fxStringUnicodeToUTF8Offset(the, aString, anOffset);
 		aLimit = c_strlen(aString) - c_strlen(aSubString);
 		while (anOffset <= aLimit) {
 			p = aString + anOffset;
@@ -676,7 +685,7 @@ void fx_String_prototype_indexOf(txMachine* the)
 				break;
 		}
 		if (anOffset <= aLimit)
-			anOffset = fxUTF8ToUnicodeOffset(aString, anOffset);
+			anOffset = fxStringUTF8ToUnicodeOffset(the, aString, anOffset);
 		else
 			anOffset = -1;
 	}
@@ -730,7 +739,7 @@ void fx_String_prototype_lastIndexOf(txMachine* the)
 		return;
 	}
 	aSubString = fxToString(the, mxArgv(0));
-	aLength = fxUnicodeLength(aString);
+	aLength = fxStringUnicodeLength(the, aString);
 	aSubLength = fxUnicodeLength(aSubString);
 	anOffset = aLength;
 	if ((mxArgc > 1) && (mxArgv(1)->kind != XS_UNDEFINED_KIND)) {
@@ -741,7 +750,7 @@ void fx_String_prototype_lastIndexOf(txMachine* the)
 			anOffset = aLength;
 	}
 	if (anOffset - aSubLength >= 0) {
-		anOffset = fxUnicodeToUTF8Offset(aString, anOffset - aSubLength);
+		anOffset = fxStringUnicodeToUTF8Offset(the, aString, anOffset - aSubLength);
 		while (anOffset >= 0) {
 			p = aString + anOffset;
 			q = aSubString;
@@ -754,7 +763,7 @@ void fx_String_prototype_lastIndexOf(txMachine* the)
 			else
 				break;
 		}		
-		anOffset = fxUTF8ToUnicodeOffset(aString, anOffset);
+		anOffset = fxStringUTF8ToUnicodeOffset(the, aString, anOffset);
 	}
 	else
 		anOffset = -1;
@@ -906,7 +915,7 @@ void fx_String_prototype_pad(txMachine* the, txBoolean flag)
 {
 	txString string = fxCoerceToString(the, mxThis), filler;
 	txInteger stringLength = c_strlen(string), fillerLength;
-	txInteger stringSize = fxUnicodeLength(string), fillerSize;
+	txInteger stringSize = fxStringUnicodeLength(the, string), fillerSize;
 	txInteger resultSize = (txInteger)fxArgToRange(the, 0, 0, 0, 0x7FFFFFFF);
 	*mxResult = *mxThis;
 	if (resultSize > stringSize) {
@@ -1040,7 +1049,7 @@ void fx_String_prototype_replace(txMachine* the)
 		txInteger replaceLength;
 		if (function) {
 			mxPushSlot(match);
-			mxPushInteger(fxUTF8ToUnicodeOffset(mxThis->value.string, offset));
+			mxPushInteger(fxStringUTF8ToUnicodeOffset(the, mxThis->value.string, offset));
 			mxPushSlot(mxThis);
 			mxPushInteger(3);
 			mxPushUndefined();
@@ -1105,11 +1114,11 @@ void fx_String_prototype_search(txMachine* the)
 void fx_String_prototype_slice(txMachine* the)
 {
 	txString string = fxCoerceToString(the, mxThis);
-	txInteger length = fxUnicodeLength(string);
+	txInteger length = fxStringUnicodeLength(the, string);
 	txNumber start = fxArgToIndex(the, 0, 0, length);
 	txNumber end = fxArgToIndex(the, 1, length, length);
 	if (start < end) {
-		txInteger offset = fxUnicodeToUTF8Offset(string, (txInteger)start);
+		txInteger offset = fxStringUnicodeToUTF8Offset(the, string, (txInteger)start);
 		length = fxUnicodeToUTF8Offset(string + offset, (txInteger)(end - start));
 		if ((offset >= 0) && (length > 0)) {
 			mxResult->value.string = (txString)fxNewChunk(the, length + 1);
@@ -1245,7 +1254,7 @@ void fx_String_prototype_startsWith(txMachine* the)
 		mxTypeError("future editions");
 	searchString = fxToString(the, mxArgv(0));
 	searchLength = c_strlen(searchString);
-	offset = fxUnicodeToUTF8Offset(string, fxArgToPosition(the, 1, 0, fxUnicodeLength(string)));
+	offset = fxStringUnicodeToUTF8Offset(the, string, fxArgToPosition(the, 1, 0, fxStringUnicodeLength(the, string)));
 	if (length - offset < searchLength)
 		return;
 	if (!c_strncmp(string + offset, searchString, searchLength))
@@ -1255,7 +1264,7 @@ void fx_String_prototype_startsWith(txMachine* the)
 void fx_String_prototype_substr(txMachine* the)
 {
 	txString string = fxCoerceToString(the, mxThis);
-	txInteger size = fxUnicodeLength(string);
+	txInteger size = fxStringUnicodeLength(the, string);
 	txInteger start = (txInteger)fxArgToIndex(the, 0, 0, size);
 	txInteger stop = size;
 	if ((mxArgc > 1) && (mxArgv(1)->kind != XS_UNDEFINED_KIND)) {
@@ -1265,8 +1274,8 @@ void fx_String_prototype_substr(txMachine* the)
 	}	
 	if (start < stop) {
 		txInteger length;
-		start = fxUnicodeToUTF8Offset(string, start);
-		stop = fxUnicodeToUTF8Offset(string, stop);
+		start = fxStringUnicodeToUTF8Offset(the, string, start);
+		stop = fxStringUnicodeToUTF8Offset(the, string, stop);
 		length = stop - start;
 		mxResult->value.string = (txString)fxNewChunk(the, length + 1);
 		c_memcpy(mxResult->value.string, string + start, length);
@@ -1289,7 +1298,7 @@ void fx_String_prototype_substring(txMachine* the)
 	txInteger anOffset;
 
 	aString = fxCoerceToString(the, mxThis);
-	aLength = fxUnicodeLength(aString);
+	aLength = fxStringUnicodeLength(the, aString);
 	aStart = 0;
 	aStop = aLength;
 	if ((mxArgc > 0) && (mxArgv(0)->kind != XS_UNDEFINED_KIND)) {
@@ -1306,7 +1315,7 @@ void fx_String_prototype_substring(txMachine* the)
 		aStop = aLength;
 	}
 	if (aStart < aStop) {
-		anOffset = fxUnicodeToUTF8Offset(aString, aStart);
+		anOffset = fxStringUnicodeToUTF8Offset(the, aString, aStart);
 		aLength = fxUnicodeToUTF8Offset(aString + anOffset, aStop - aStart);
 		if ((anOffset >= 0) && (aLength > 0)) {
 			mxResult->value.string = (txString)fxNewChunk(the, aLength + 1);
@@ -1491,7 +1500,7 @@ void fx_String_prototype_iterator(txMachine* the)
 	txSlot* property;
 	mxPush(mxStringIteratorPrototype);
 	property = fxLastProperty(the, fxNewIteratorInstance(the, mxThis));
-	property = fxNextIntegerProperty(the, property, fxUnicodeLength(string), mxID(_length), XS_GET_ONLY);
+	property = fxNextIntegerProperty(the, property, fxStringUnicodeLength(the, string), mxID(_length), XS_GET_ONLY);
 	mxPullSlot(mxResult);
 }
 
@@ -1505,7 +1514,7 @@ void fx_String_prototype_iterator_next(txMachine* the)
 	txSlot* value = result->value.reference->next;
 	txSlot* done = value->next;
 	if (index->value.integer < length->value.integer) {
-		txInteger offset = fxUnicodeToUTF8Offset(iterable->value.string, index->value.integer);
+		txInteger offset = fxStringUnicodeToUTF8Offset(the, iterable->value.string, index->value.integer);
 		txInteger length = fxUnicodeToUTF8Offset(iterable->value.string + offset, 1);
 		value->value.string = (txString)fxNewChunk(the, length + 1);
 		c_memcpy(value->value.string, iterable->value.string + offset, length);
@@ -1764,3 +1773,130 @@ void fxPushSubstitutionString(txMachine* the, txSlot* string, txInteger size, tx
 		mxPushSlot(replace);
 }
 
+
+#if mxStringIndexCache
+static txStringIndexCache* fxGetStringIndexCache(txMachine* the, txString string)
+{
+	txStringIndexCache* cache = the->stringIndexCaches;
+	txStringIndexCache* limit = cache + mxStringIndexCacheCount;
+	txU1* p;
+	txU1 c;
+	txInteger length;
+	while (cache < limit) {
+		if (cache->string == string)
+			return cache;
+		cache++;
+	}
+	p = (txU1*)string;
+	if (((c_read8(p) & 0xC0) == 0x80) || (c_strlen(string) < mxStringIndexCacheMinimum))
+		return C_NULL;
+	length = 0;
+	while ((c = c_read8(p++))) {
+		if ((c & 0xC0) != 0x80)
+			length++;
+	}
+	cache = the->stringIndexCaches + the->stringIndexCacheVictim;
+	the->stringIndexCacheVictim = (the->stringIndexCacheVictim + 1) % mxStringIndexCacheCount;
+	cache->string = string;
+	cache->length = length;
+	cache->size = (txInteger)(p - 1 - (txU1*)string);
+	cache->index = 0;
+	cache->offset = 0;
+	return cache;
+}
+
+void fxFlushStringIndexCache(txMachine* the, txString string)
+{
+	txStringIndexCache* cache = the->stringIndexCaches;
+	txStringIndexCache* limit = cache + mxStringIndexCacheCount;
+	while (cache < limit) {
+		if (!string || (cache->string == string))
+			cache->string = C_NULL;
+		cache++;
+	}
+}
+
+txInteger fxStringUnicodeLength(txMachine* the, txString string)
+{
+	txStringIndexCache* cache = fxGetStringIndexCache(the, string);
+	if (cache)
+		return cache->length;
+	return fxUnicodeLength(string);
+}
+
+txInteger fxStringUnicodeToUTF8Offset(txMachine* the, txString string, txInteger index)
+{
+	txStringIndexCache* cache = fxGetStringIndexCache(the, string);
+	txInteger i;
+	txU1* p;
+	if (!cache)
+		return fxUnicodeToUTF8Offset(string, index);
+	if ((index < 0) || (cache->length < index))
+		return -1;
+	if (cache->length == cache->size)
+		return index;
+	if (cache->length == index)
+		return cache->size;
+	i = cache->index;
+	p = (txU1*)string + cache->offset;
+	if (index < (i >> 1)) {
+		i = 0;
+		p = (txU1*)string;
+	}
+	while (i < index) {
+		p++;
+		while ((c_read8(p) & 0xC0) == 0x80)
+			p++;
+		i++;
+	}
+	while (i > index) {
+		p--;
+		while ((c_read8(p) & 0xC0) == 0x80)
+			p--;
+		i--;
+	}
+	cache->index = index;
+	cache->offset = (txInteger)(p - (txU1*)string);
+	return cache->offset;
+}
+
+txInteger fxStringUTF8ToUnicodeOffset(txMachine* the, txString string, txInteger offset)
+{
+	txStringIndexCache* cache = fxGetStringIndexCache(the, string);
+	txInteger i;
+	txU1* p;
+	txU1* q;
+	if (!cache)
+		return fxUTF8ToUnicodeOffset(string, offset);
+	if ((offset < 0) || (cache->size < offset))
+		return -1;
+	if (cache->length == cache->size)
+		return offset;
+	if (cache->size == offset)
+		return cache->length;
+	i = cache->index;
+	p = (txU1*)string + cache->offset;
+	q = (txU1*)string + offset;
+	if (offset < (cache->offset >> 1)) {
+		i = 0;
+		p = (txU1*)string;
+	}
+	while (p < q) {
+		p++;
+		while ((c_read8(p) & 0xC0) == 0x80)
+			p++;
+		i++;
+	}
+	while (p > q) {
+		p--;
+		while ((c_read8(p) & 0xC0) == 0x80)
+			p--;
+		i--;
+	}
+	if (p != q)
+		return -1;
+	cache->index = i;
+	cache->offset = offset;
+	return i;
+}
+#endif
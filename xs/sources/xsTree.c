@@ -135,6 +135,7 @@ void fxParserTree(txParser* parser, void* theStream, txGetter theGetter, txUnsig
 {
 	parser->stream = theStream;
 	parser->getter = theGetter;
+	parser->source = (theGetter == fxParserSourceGetter) ? (txParserSource*)theStream : C_NULL;
 	parser->line = 1;
 	parser->flags = flags;
 	
@@ -113,7 +113,7 @@ txSlot* fxToInstance(txMachine* the, txSlot* theSlot)
 		anInstance = fxNewStringInstance(the);
 		anInstance->next->kind = theSlot->kind;
 		anInstance->next->value.string = theSlot->value.string;
-		anInstance->next->value.key.sum = fxUnicodeLength(theSlot->value.string);
+		anInstance->next->value.key.sum = fxStringUnicodeLength(the, theSlot->value.string);
 		if (the->frame->flag & XS_STRICT_FLAG)
 			anInstance->flag |= XS_DONT_PATCH_FLAG;
 		mxPullSlot(theSlot);
@@ -334,8 +334,19 @@ txBoolean fxOrdinaryDeleteProperty(txMachine* the, txSlot* instance, txID id, tx
 {
 	txSlot** address = &(instance->next);
 	txSlot* property;
-	if (instance->ID >= 0)
-		return 0;
+	if (instance->ID >= 0) {
+		/* shared properties cannot be deleted, aliased properties can */
+		txSlot* alias = the->aliasArray[instance->ID];
+		if (!id)
+			return 0;
+		property = instance->next;
+		while (property) {
+			if (property->ID == id)
+				return 0;
+			property = property->next;
+		}
+		return (alias) ? fxOrdinaryDeleteProperty(the, alias, id, index) : 1;
+	}
 	address = &(instance->next);
 	while ((property = *address) && (property->flag & XS_INTERNAL_FLAG))
 		address = &(property->next);
@@ -346,6 +357,8 @@ txBoolean fxOrdinaryDeleteProperty(txMachine* the, txSlot* instance, txID id, tx
 					return 0;
 				*address = property->next;
 				property->next = C_NULL;
+				mxShapeForget(instance);
+				mxInlineCacheFlush(the);
 				return 1;
 			}
 			address = &(property->next);
@@ -387,6 +400,10 @@ again:
 		}
 	}
 	result = instance->next;
+#if mxShapes
+	if (mxIsShaped(instance) && !mxShapeHas(the, instance->ID, id))
+		result = C_NULL;
+#endif
 	while (result && (result->flag & XS_INTERNAL_FLAG))
 		result = result->next;
 	if (id) {
@@ -493,7 +510,9 @@ void fxOrdinaryOwnKeys(txMachine* the, txSlot* instance, txFlag flag, txSlot* ke
 		keys = fxQueueIndexKeys(the, property, flag, keys);
 		property = property->next;
 	}
-	fxQueueIDKeys(the, property, flag, keys);
+	keys = fxQueueIDKeys(the, property, flag, keys);
+	if (instance->ID >= 0)
+		fxQueueAliasKeys(the, instance, property, flag, keys);
 }
 
 txBoolean fxOrdinaryPreventExtensions(txMachine* the, txSlot* instance)
@@ -565,14 +584,22 @@ txSlot* fxOrdinarySetProperty(txMachine* the, txSlot* instance, txID id, txIndex
 	if (instance->flag & XS_DONT_PATCH_FLAG)
 		return C_NULL;
 	if (id) {
+		mxInlineCacheShadow(the, id);
 		*address = result = fxNewSlot(the);
 		result->ID = id;
+	#if mxShapes
+		if (mxIsShaped(instance))
+			instance->ID = fxNextShape(the, instance->ID, id);
+		else if ((instance->ID == XS_NO_ID) && (address == &(instance->next)))
+			instance->ID = fxNextShape(the, XS_NO_ID, id);
+	#endif
 	}
 	else {
 		if (property && (property->kind == XS_ARRAY_KIND)) {
 			result = fxSetIndexProperty(the, instance, property, index);
 		}
 		else {
+			mxShapeForget(instance);
 			property = fxNewSlot(the);
 			property->next = *address;
 			property->ID = 0;
@@ -647,10 +674,117 @@ txBoolean fxOrdinarySetPrototype(txMachine* the, txSlot* instance, txSlot* slot)
 			slot = slot->value.instance.prototype;
 		}
 		instance->value.instance.prototype = prototype;
+		mxInlineCacheFlush(the);
 	}
 	return 1;
 }
 
+#if mxInlineCache
+static void fxShapeInlineCache(txMachine* the, txInlineCache* cache, txSlot* instance, txInteger offset)
+{
+	cache->instance = instance;
+#if mxShapes
+	if (mxIsShaped(instance)) {
+		cache->shape = instance->ID;
+		cache->offset = (txU2)offset;
+		cache->prototype = instance->value.instance.prototype;
+	}
+	else
+		cache->shape = XS_NO_ID;
+#endif
+}
+
+txSlot* fxGetCachedProperty(txMachine* the, txInlineCache* cache, txByte* code, txSlot* instance, txID id)
+{
+	txSlot* receiver = instance;
+	txBoolean own = 1;
+	txInteger offset = 0;
+	txSlot* result;
+#ifdef mxInstrument
+	the->inlineCacheMissCount++;
+#endif
+again:
+	if (instance->flag & XS_EXOTIC_FLAG)
+		return mxBehaviorGetProperty(the, instance, id, XS_NO_ID, XS_ANY);
+	if (instance->ID >= 0) {
+		txSlot* alias = the->aliasArray[instance->ID];
+		own = 0;
+		if (alias) {
+			result = fxOrdinaryGetProperty(the, alias, id, XS_NO_ID, XS_OWN);
+			if (result)
+				goto cache;
+		}
+	}
+	result = instance->next;
+#if mxShapes
+	if (mxIsShaped(instance) && !mxShapeHas(the, instance->ID, id))
+		result = C_NULL;
+#endif
+	while (result && (result->flag & XS_INTERNAL_FLAG))
+		result = result->next;
+	while (result) {
+		if (result->ID == id)
+			goto cache;
+		result = result->next;
+		offset++;
+	}
+	instance = instance->value.instance.prototype;
+	if (!instance)
+		return C_NULL;
+	own = 0;
+	goto again;
+cache:
+	cache->code = code;
+	cache->property = result;
+	cache->epoch = the->inlineCacheEpoch;
+	cache->own = own;
+	fxShapeInlineCache(the, cache, receiver, offset);
+	if (!own)
+		mxInlineCacheShadowByte(the, id) |= mxInlineCacheShadowBit(id);
+	return result;
+}
+
+txSlot* fxSetCachedProperty(txMachine* the, txSlot* instance, txID id)
+{
+	txInlineCache* cache;
+	txSlot* result;
+	txSlot* property;
+	txBoolean own = 1;
+	txInteger offset = 0;
+#ifdef mxInstrument
+	the->inlineCacheMissCount++;
+#endif
+	result = mxBehaviorSetProperty(the, instance, id, XS_NO_ID, XS_ANY);
+	if (!result || (instance->flag & XS_EXOTIC_FLAG) || (instance->ID >= 0))
+		return result;
+	property = instance->next;
+	while (property) {
+		if (property == result)
+			goto cache;
+		property = property->next;
+		offset++;
+	}
+	own = 0;
+	property = instance->value.instance.prototype;
+	while (property) {
+		if (property->flag & XS_EXOTIC_FLAG)
+			return result;
+		property = property->value.instance.prototype;
+	}
+cache:
+	/* setting can collect garbage, so the code is only reliable now */
+	cache = mxInlineCacheAt(the, the->code);
+	cache->code = the->code;
+	cache->property = result;
+	cache->epoch = the->inlineCacheEpoch;
+	cache->own = own;
+	fxShapeInlineCache(the, cache, instance, offset);
+	if (!own)
+		mxInlineCacheShadowByte(the, id) |= mxInlineCacheShadowBit(id);
+	return result;
+}
+#endif
+
 void fx_species_get(txMachine* the)
 {
 	*mxResult = *mxThis;
@@ -53,6 +53,19 @@ enum {
 	cxWordContinueStep
 };
 
+enum {
+	cxAutomatonCharSet,
+	cxAutomatonJump,
+	cxAutomatonLineBegin,
+	cxAutomatonLineEnd,
+	cxAutomatonMatch,
+	cxAutomatonReset,
+	cxAutomatonSave,
+	cxAutomatonSplit,
+	cxAutomatonWordBreak,
+	cxAutomatonWordContinue
+};
+
 #define mxCharCaseFoldingCount 189
 static const txCharCase gxCharCaseFoldings[mxCharCaseFoldingCount] ICACHE_XS6RO_ATTR = {
 	{0x41,0x5A,32},{0xB5,0xB5,775},{0xC0,0xD6,32},{0xD8,0xDE,32},{0x100,0x12E,0},{0x132,0x136,0},{0x139,0x147,0},
@@ -158,6 +171,32 @@ typedef struct {
 	txTerm* right;
 } txSequence;
 
+#define mxLiteralSize 64
+
+typedef struct {
+	txU4 bitmap[4];
+	txBoolean any;
+	txBoolean wide;
+	txBoolean leading;
+	txInteger length;
+	char literal[mxLiteralSize];
+	txInteger prefixLength;
+	char prefix[mxLiteralSize];
+	txInteger requiredLength;
+	char required[mxLiteralSize];
+} txPatternFilter;
+
+#define mxAutomatonCount 1024
+#define mxAutomatonRatio 4
+
+typedef struct {
+	txInteger* instructions;
+	txInteger count;
+	txInteger threadCount;
+	txInteger stackCount;
+	txBoolean backtracking;
+} txPatternAutomaton;
+
 struct sxPatternParser {
 	txMachine* the;
 	txTerm* first;
@@ -183,6 +222,7 @@ struct sxPatternParser {
 };
 
 static void* fxCharSetAny(txPatternParser* parser);
+static void fxCharSetBitmap(txPatternParser* parser, txCharSet* set, txU4* bitmap, txBoolean* wide);
 static void* fxCharSetDigits(txPatternParser* parser);
 static void* fxCharSetEmpty(txPatternParser* parser);
 static void* fxCharSetNot(txPatternParser* parser, txCharSet* set);
@@ -226,6 +266,15 @@ static void fxSequenceCode(txPatternParser* parser, void* it, txInteger directio
 static void fxWordBreakCode(txPatternParser* parser, void* it, txInteger direction, txInteger sequel);
 static void fxWordContinueCode(txPatternParser* parser, void* it, txInteger direction, txInteger sequel);
 
+static void fxPatternFilterBreak(txPatternFilter* filter);
+static txBoolean fxPatternFilterFirst(txPatternParser* parser, txTerm* term, txPatternFilter* filter);
+static void fxPatternFilterLiteral(txPatternParser* parser, txTerm* term, txPatternFilter* filter);
+static txInteger fxPatternFilterSize(txPatternFilter* filter);
+
+static txInteger fxAutomatonEmit(txPatternAutomaton* automaton, txInteger instruction, txInteger x, txInteger y);
+static txBoolean fxAutomatonNullable(txTerm* term);
+static txBoolean fxAutomatonTerm(txPatternParser* parser, txTerm* term, txPatternAutomaton* automaton);
+
 static void fxPatternParserInitialize(txPatternParser* parser);
 static txBoolean fxPatternParserDecimal(txPatternParser* parser, txU4* value);
 static void fxPatternParserError(txPatternParser* parser, txString format, ...);
@@ -239,6 +288,10 @@ static void fxPatternParserTerminate(txPatternParser* parser);
 #define mxStepSize sizeof(txInteger)
 #define mxIndexSize sizeof(txInteger)
 #define mxTermStepSize mxCodeSize + mxStepSize
+#define mxCharSetBitmapSize (4 * sizeof(txInteger))
+#define mxFilterSize (8 * sizeof(txInteger))
+#define mxAutomatonInstructionSize 3
+#define mxAutomatonSize (3 * sizeof(txInteger))
 #define mxAssertionNotStepSize mxTermStepSize + mxIndexSize + mxStepSize
 #define mxAssertionNotCompletionSize mxCodeSize + mxIndexSize
 #define mxAssertionStepSize mxTermStepSize + mxIndexSize
@@ -312,14 +365,30 @@ struct sxStateData {
 	txStateData* nextState;
 	txInteger step;
 	txInteger offset;
-	txCaptureData captures[1];
+	txCaptureData captures[1]; // followed by the quantifiers
 };
 
+typedef struct {
+	txInteger* instructions;
+	txInteger* marks;
+	txInteger generation;
+	txInteger* stack;
+	txInteger* slots;
+	txInteger slotCount;
+	txInteger threadCount;
+	txString subject;
+	txInteger stop;
+	txInteger flags;
+} txAutomatonData;
+
 static txInteger fxFindCharacter(txString input, txInteger offset, txInteger direction);
 static txInteger fxGetCharacter(txString input, txInteger offset, txInteger flags);
+static txInteger fxFilterRegExp(txInteger* filter, txString subject, txInteger start);
 static txBoolean fxMatchCharacter(txInteger* characters, txInteger character);
 static txStateData* fxPopStates(txMachine* the, txStateData* fromState, txStateData* toState);
-static txStateData* fxPushState(txMachine* the, txStateData* firstState, txInteger step, txInteger offset, txCaptureData* captures, txInteger captureCount);
+static void fxAutomatonAdd(txAutomatonData* self, txInteger* thread, txInteger pc, txInteger offset);
+static txBoolean fxMatchAutomaton(void* the, txInteger* code, txInteger* data, txInteger* filter, txInteger* automaton, txString subject, txInteger start);
+static txStateData* fxPushState(txMachine* the, txStateData* firstState, txInteger step, txInteger offset, txCaptureData* captures, txInteger captureCount, txQuantifierData* quantifiers, txInteger quantifierCount);
 
 #ifdef mxTrace
 	static txString gxStepNames[cxWordContinueStep + 1] = {
@@ -412,6 +481,32 @@ void* fxCharSetAny(txPatternParser* parser)
 	return result;
 }
 
+void fxCharSetBitmap(txPatternParser* parser, txCharSet* set, txU4* bitmap, txBoolean* wide)
+{
+	txInteger* characters = set->characters;
+	txInteger count = characters[0], index, character;
+	// ASCII letters are canonicalized to lowercase with the u flag, to uppercase without
+	txInteger canonical = (parser->flags & XS_REGEXP_U) ? 0x20 : 0;
+	for (index = 1; index < count; index += 2) {
+		txInteger begin = characters[index], end = characters[index + 1];
+		if (begin < 1)
+			begin = 1;
+		if (end > 128)
+			end = 128;
+		for (character = begin; character < end; character++) {
+			if ((parser->flags & XS_REGEXP_I) && ((('A' <= character) && (character <= 'Z')) || (('a' <= character) && (character <= 'z')))) {
+				if ((character & 0x20) != canonical)
+					continue;
+				bitmap[(character ^ 0x20) >> 5] |= 1 << ((character ^ 0x20) & 31);
+			}
+			bitmap[character >> 5] |= 1 << (character & 31);
+		}
+	}
+	// non ASCII characters, and NUL which strings encode on four bytes
+	if ((parser->flags & XS_REGEXP_I) || ((count > 0) && ((characters[1] == 0) || (characters[count] > 0x80))))
+		*wide = 1;
+}
+
 void* fxCharSetCanonicalizeSingle(txPatternParser* parser, txCharSet* set)
 {
 	if ((parser->flags & XS_REGEXP_I)&& (set->characters[0] == 2) && (set->characters[1] + 1 == set->characters[2])) {
@@ -1074,6 +1169,7 @@ void* fxSequenceParse(txPatternParser* parser, txInteger character)
 				current = fxTermCreate(parser, sizeof(txCapture), fxCaptureMeasure);
 				((txCapture*)current)->term = term;
 				((txCapture*)current)->captureIndex = currentIndex;
+				((txCapture*)current)->name[0] = 0;
 				current = fxQuantifierParse(parser, current, currentIndex - 1);
 			}
 		}
@@ -1190,7 +1286,7 @@ void fxCharSetMeasure(txPatternParser* parser, void* it, txInteger direction)
 {
 	txCharSet* self = it;
 	self->step = parser->size;
-	parser->size += mxTermStepSize + ((1 + self->characters[0]) * sizeof(txInteger));
+	parser->size += mxTermStepSize + mxCharSetBitmapSize + ((1 + self->characters[0]) * sizeof(txInteger));
 	self->dispatch.code = fxCharSetCode;
 }
 
@@ -1320,8 +1416,10 @@ void fxCaptureCode(txPatternParser* parser, void* it, txInteger direction, txInt
 	*buffer++ = sequel;
 	*buffer++ = self->captureIndex;
 #ifdef mxRun
-	if (parser->the && self->name[0])
-		(*parser->code)[2 + self->captureIndex] = fxNewNameC(parser->the, self->name);
+	if (parser->the && self->name[0]) {
+		txID id = fxNewNameC(parser->the, self->name);
+		(*parser->code)[2 + self->captureIndex] = id;
+	}
 	else
 #endif
 		(*parser->code)[2 + self->captureIndex] = XS_NO_ID;
@@ -1344,11 +1442,15 @@ void fxCharSetCode(txPatternParser* parser, void* it, txInteger direction, txInt
 	txCharSet* self = it;
 	txInteger* buffer = (txInteger*)(((txByte*)*(parser->code)) + self->step);
 	txInteger count, index;
+	txBoolean wide = 0;
 	if (direction == 1)
 		*buffer++ = cxCharSetForwardStep;
 	else
 		*buffer++ = cxCharSetBackwardStep;
 	*buffer++ = sequel;
+	c_memset(buffer, 0, mxCharSetBitmapSize);
+	fxCharSetBitmap(parser, self, (txU4*)buffer, &wide);
+	buffer += mxCharSetBitmapSize / sizeof(txInteger);
 	count = *buffer++ = self->characters[0];
 	index = 1;
 	while (index <= count) {
@@ -1409,7 +1511,7 @@ void fxQuantifierCode(txPatternParser* parser, void* it, txInteger direction, tx
 	*buffer++ = self->quantifierIndex;
 	*buffer++ = sequel;
 	*buffer++ = self->captureIndex + 1;
-	*buffer++ = self->captureIndex + self->captureCount;
+	*buffer++ = self->captureIndex + self->captureCount + 1;
 	(*self->term->dispatch.code)(parser, self->term, direction, self->completion);
 	buffer = (txInteger*)(((txByte*)*(parser->code)) + self->completion);
 	*buffer++ = cxQuantifierCompletion;
@@ -1448,6 +1550,247 @@ void fxWordContinueCode(txPatternParser* parser, void* it, txInteger direction,
 }
 
 
+void fxPatternFilterBreak(txPatternFilter* filter)
+{
+	if (filter->leading) {
+		c_memcpy(filter->prefix, filter->literal, filter->length);
+		filter->prefixLength = filter->length;
+		filter->leading = 0;
+	}
+	if (filter->requiredLength < filter->length) {
+		c_memcpy(filter->required, filter->literal, filter->length);
+		filter->requiredLength = filter->length;
+	}
+	filter->length = 0;
+}
+
+txBoolean fxPatternFilterFirst(txPatternParser* parser, txTerm* term, txPatternFilter* filter)
+{
+	txTermCode code = term->dispatch.code;
+	if (code == fxCharSetCode) {
+		fxCharSetBitmap(parser, (txCharSet*)term, filter->bitmap, &filter->wide);
+		return 0;
+	}
+	if (code == fxSequenceCode) {
+		txSequence* sequence = (txSequence*)term;
+		if (fxPatternFilterFirst(parser, sequence->left, filter))
+			return fxPatternFilterFirst(parser, sequence->right, filter);
+		return 0;
+	}
+	if (code == fxDisjunctionCode) {
+		txDisjunction* disjunction = (txDisjunction*)term;
+		txBoolean left = fxPatternFilterFirst(parser, disjunction->left, filter);
+		txBoolean right = fxPatternFilterFirst(parser, disjunction->right, filter);
+		return left || right;
+	}
+	if (code == fxCaptureCode)
+		return fxPatternFilterFirst(parser, ((txCapture*)term)->term, filter);
+	if (code == fxQuantifierCode) {
+		txQuantifier* quantifier = (txQuantifier*)term;
+		return fxPatternFilterFirst(parser, quantifier->term, filter) || (quantifier->min == 0);
+	}
+	if (code == fxCaptureReferenceCode)
+		filter->any = 1;
+	return 1;
+}
+
+void fxPatternFilterLiteral(txPatternParser* parser, txTerm* term, txPatternFilter* filter)
+{
+	txTermCode code = term->dispatch.code;
+	if (code == fxSequenceCode) {
+		fxPatternFilterLiteral(parser, ((txSequence*)term)->left, filter);
+		fxPatternFilterLiteral(parser, ((txSequence*)term)->right, filter);
+	}
+	else if (code == fxCaptureCode)
+		fxPatternFilterLiteral(parser, ((txCapture*)term)->term, filter);
+	else if ((code == fxAssertionCode) || (code == fxEmptyCode) || (code == fxLineBeginCode) || (code == fxLineEndCode) || (code == fxWordBreakCode) || (code == fxWordContinueCode))
+		return;
+	else if ((code == fxCharSetCode) && !(parser->flags & XS_REGEXP_I)) {
+		txInteger* characters = ((txCharSet*)term)->characters;
+		txInteger character = characters[1];
+		char buffer[8];
+		txInteger length;
+		if ((characters[0] != 2) || (characters[2] != character + 1) || (character == 0) || ((0xD800 <= character) && (character <= 0xDFFF))) {
+			fxPatternFilterBreak(filter);
+			return;
+		}
+		length = fxUTF8Encode(buffer, character) - buffer;
+		if (filter->length + length >= mxLiteralSize)
+			fxPatternFilterBreak(filter);
+		c_memcpy(filter->literal + filter->length, buffer, length);
+		filter->length += length;
+	}
+	else
+		fxPatternFilterBreak(filter);
+}
+
+txInteger fxPatternFilterSize(txPatternFilter* filter)
+{
+	txInteger size = mxFilterSize;
+	size += ((filter->prefixLength + sizeof(txInteger)) / sizeof(txInteger)) * sizeof(txInteger);
+	size += ((filter->requiredLength + sizeof(txInteger)) / sizeof(txInteger)) * sizeof(txInteger);
+	return size;
+}
+
+txInteger fxAutomatonEmit(txPatternAutomaton* automaton, txInteger instruction, txInteger x, txInteger y)
+{
+	txInteger index = automaton->count++;
+	if (automaton->instructions) {
+		txInteger* buffer = automaton->instructions + (index * mxAutomatonInstructionSize);
+		*buffer++ = instruction;
+		*buffer++ = x;
+		*buffer = y;
+	}
+	if (instruction == cxAutomatonSplit)
+		automaton->stackCount++;
+	else if (instruction == cxAutomatonSave)
+		automaton->stackCount++;
+	else if (instruction == cxAutomatonReset)
+		automaton->stackCount += 2 * (y - x);
+	else if ((instruction == cxAutomatonCharSet) || (instruction == cxAutomatonMatch))
+		automaton->threadCount++;
+	return index;
+}
+
+txBoolean fxAutomatonNullable(txTerm* term)
+{
+	txTermCode code = term->dispatch.code;
+	if (code == fxCharSetCode)
+		return 0;
+	if (code == fxSequenceCode)
+		return fxAutomatonNullable(((txSequence*)term)->left) && fxAutomatonNullable(((txSequence*)term)->right);
+	if (code == fxDisjunctionCode)
+		return fxAutomatonNullable(((txDisjunction*)term)->left) || fxAutomatonNullable(((txDisjunction*)term)->right);
+	if (code == fxCaptureCode)
+		return fxAutomatonNullable(((txCapture*)term)->term);
+	if (code == fxQuantifierCode)
+		return (((txQuantifier*)term)->min == 0) || fxAutomatonNullable(((txQuantifier*)term)->term);
+	return 1;
+}
+
+txBoolean fxAutomatonTerm(txPatternParser* parser, txTerm* term, txPatternAutomaton* automaton)
+{
+	txTermCode code = term->dispatch.code;
+	txInteger* instructions = automaton->instructions;
+	txInteger index, jump;
+	if (automaton->count > mxAutomatonCount)
+		return 0;
+	if (code == fxCharSetCode)
+		fxAutomatonEmit(automaton, cxAutomatonCharSet, term->step, 0);
+	else if (code == fxSequenceCode) {
+		if (!fxAutomatonTerm(parser, ((txSequence*)term)->left, automaton))
+			return 0;
+		if (!fxAutomatonTerm(parser, ((txSequence*)term)->right, automaton))
+			return 0;
+	}
+	else if (code == fxDisjunctionCode) {
+		automaton->backtracking = 1;
+		index = fxAutomatonEmit(automaton, cxAutomatonSplit, 0, 0);
+		if (!fxAutomatonTerm(parser, ((txDisjunction*)term)->left, automaton))
+			return 0;
+		jump = fxAutomatonEmit(automaton, cxAutomatonJump, 0, 0);
+		if (instructions) {
+			instructions[(index * mxAutomatonInstructionSize) + 1] = index + 1;
+			instructions[(index * mxAutomatonInstructionSize) + 2] = jump + 1;
+		}
+		if (!fxAutomatonTerm(parser, ((txDisjunction*)term)->right, automaton))
+			return 0;
+		if (instructions)
+			instructions[(jump * mxAutomatonInstructionSize) + 1] = automaton->count;
+	}
+	else if (code == fxCaptureCode) {
+		txInteger captureIndex = ((txCapture*)term)->captureIndex;
+		fxAutomatonEmit(automaton, cxAutomatonSave, 2 * captureIndex, 0);
+		if (!fxAutomatonTerm(parser, ((txCapture*)term)->term, automaton))
+			return 0;
+		fxAutomatonEmit(automaton, cxAutomatonSave, (2 * captureIndex) + 1, 0);
+	}
+	else if (code == fxQuantifierCode) {
+		txQuantifier* quantifier = (txQuantifier*)term;
+		txInteger from = quantifier->captureIndex + 1;
+		txInteger to = quantifier->captureIndex + quantifier->captureCount + 1;
+		txInteger min = quantifier->min, max = quantifier->max, iteration;
+		txBoolean nullable;
+		if (max == 0)
+			return 1;
+		if (min != max)
+			automaton->backtracking = 1;
+		nullable = fxAutomatonNullable(quantifier->term);
+		// empty optional iterations must fail, which depends on where the iteration began, not only on the instruction and the offset
+		if (nullable && (min != max))
+			return 0;
+		// mandatory iterations are unrolled, the last one is the loop when iterations are unbounded
+		for (iteration = 0; iteration < ((max != 0x7FFFFFFF) ? min : min - 1); iteration++) {
+			if (from < to)
+				fxAutomatonEmit(automaton, cxAutomatonReset, from, to);
+			if (!fxAutomatonTerm(parser, quantifier->term, automaton))
+				return 0;
+			if (automaton->count > mxAutomatonCount)
+				return 0;
+		}
+		if (max == 0x7FFFFFFF) {
+			if (min == 0) {
+				index = fxAutomatonEmit(automaton, cxAutomatonSplit, 0, 0);
+				if (from < to)
+					fxAutomatonEmit(automaton, cxAutomatonReset, from, to);
+				if (!fxAutomatonTerm(parser, quantifier->term, automaton))
+					return 0;
+				fxAutomatonEmit(automaton, cxAutomatonJump, index, 0);
+				if (instructions) {
+					instructions[(index * mxAutomatonInstructionSize) + 1] = quantifier->greedy ? index + 1 : automaton->count;
+					instructions[(index * mxAutomatonInstructionSize) + 2] = quantifier->greedy ? automaton->count : index + 1;
+				}
+			}
+			else {
+				index = automaton->count;
+				if (from < to)
+					fxAutomatonEmit(automaton, cxAutomatonReset, from, to);
+				if (!fxAutomatonTerm(parser, quantifier->term, automaton))
+					return 0;
+				jump = automaton->count;
+				fxAutomatonEmit(automaton, cxAutomatonSplit, quantifier->greedy ? index : jump + 1, quantifier->greedy ? jump + 1 : index);
+			}
+		}
+		else {
+			txInteger chain = -1;
+			if (min == max)
+				return 1;
+			for (iteration = min; iteration < max; iteration++) {
+				index = automaton->count;
+				// splits are chained by their exit until the end is known
+				fxAutomatonEmit(automaton, cxAutomatonSplit, quantifier->greedy ? index + 1 : chain, quantifier->greedy ? chain : index + 1);
+				chain = index;
+				if (from < to)
+					fxAutomatonEmit(automaton, cxAutomatonReset, from, to);
+				if (!fxAutomatonTerm(parser, quantifier->term, automaton))
+					return 0;
+				if (automaton->count > mxAutomatonCount)
+					return 0;
+			}
+			if (instructions) {
+				while (chain >= 0) {
+					txInteger* buffer = instructions + (chain * mxAutomatonInstructionSize) + (quantifier->greedy ? 2 : 1);
+					chain = *buffer;
+					*buffer = automaton->count;
+				}
+			}
+		}
+	}
+	else if (code == fxEmptyCode)
+		return 1;
+	else if (code == fxLineBeginCode)
+		fxAutomatonEmit(automaton, cxAutomatonLineBegin, 0, 0);
+	else if (code == fxLineEndCode)
+		fxAutomatonEmit(automaton, cxAutomatonLineEnd, 0, 0);
+	else if (code == fxWordBreakCode)
+		fxAutomatonEmit(automaton, cxAutomatonWordBreak, 0, 0);
+	else if (code == fxWordContinueCode)
+		fxAutomatonEmit(automaton, cxAutomatonWordContinue, 0, 0);
+	else
+		return 0;
+	return 1;
+}
+
 void fxPatternParserInitialize(txPatternParser* parser)
 {
 	c_memset(parser, 0, sizeof(txPatternParser));
@@ -1575,6 +1918,9 @@ txBoolean fxCompileRegExp(void* the, txString pattern, txString modifier, txInte
 	txPatternParser _parser;
 	txPatternParser* parser = &_parser;
 	txTerm* term;
+	txPatternFilter filter;
+	txPatternAutomaton automaton;
+	txBoolean first;
 
 	fxPatternParserInitialize(parser);
 	if (c_setjmp(parser->jmp_buf) == 0) {
@@ -1618,8 +1964,25 @@ txBoolean fxCompileRegExp(void* the, txString pattern, txString modifier, txInte
 		parser->captureIndex++;
 		if (!term) 
 			fxPatternParserError(parser, gxErrors[mxInvalidPattern]);
-		parser->size = (4 + parser->captureIndex) * sizeof(txInteger);
+		parser->size = (6 + parser->captureIndex) * sizeof(txInteger);
 		(*term->dispatch.measure)(parser, term, 1);
+		
+		c_memset(&filter, 0, sizeof(filter));
+		filter.leading = 1;
+		first = !fxPatternFilterFirst(parser, term, &filter) && !filter.any;
+		if (first && filter.wide && (filter.bitmap[0] == 0xFFFFFFFE) && (filter.bitmap[1] == 0xFFFFFFFF) && (filter.bitmap[2] == 0xFFFFFFFF) && (filter.bitmap[3] == 0xFFFFFFFF))
+			first = 0;
+		fxPatternFilterLiteral(parser, term, &filter);
+		fxPatternFilterBreak(&filter);
+		if (filter.requiredLength <= filter.prefixLength)
+			filter.requiredLength = 0;
+		
+		c_memset(&automaton, 0, sizeof(automaton));
+		if (fxAutomatonTerm(parser, term, &automaton) && automaton.backtracking) {
+			fxAutomatonEmit(&automaton, cxAutomatonMatch, 0, 0);
+			if (automaton.count <= mxAutomatonCount)
+				parser->flags |= XS_REGEXP_AUTOMATON;
+		}
 			
 		if (data) {
 			txInteger size = parser->captureIndex * sizeof(txCaptureData)
@@ -1635,10 +1998,18 @@ txBoolean fxCompileRegExp(void* the, txString pattern, txString modifier, txInte
 				fxPatternParserError(parser, gxErrors[mxNotEnoughMemory]);
 		}
 		if (code) {
-			txInteger offset;
+			txInteger offset, filterOffset = 0, automatonOffset = 0;
 			txInteger* buffer;
 			offset = parser->size;
 			parser->size += sizeof(txInteger);
+			if (first || filter.prefixLength || filter.requiredLength) {
+				filterOffset = parser->size;
+				parser->size += fxPatternFilterSize(&filter);
+			}
+			if (parser->flags & XS_REGEXP_AUTOMATON) {
+				automatonOffset = parser->size;
+				parser->size += mxAutomatonSize + (automaton.count * mxAutomatonInstructionSize * sizeof(txInteger));
+			}
 		#ifdef mxRun
 			if (the) {
 				*code = fxNewChunk(the, parser->size);
@@ -1652,11 +2023,40 @@ txBoolean fxCompileRegExp(void* the, txString pattern, txString modifier, txInte
 			buffer = *code;
 			buffer[0] = parser->flags;
 			buffer[1] = parser->captureIndex;
+			buffer[2] = XS_NO_ID;
 			buffer[2 + parser->captureIndex] = parser->assertionIndex;
 			buffer[2 + parser->captureIndex + 1] = parser->quantifierIndex;
+			buffer[2 + parser->captureIndex + 2] = filterOffset;
+			buffer[2 + parser->captureIndex + 3] = automatonOffset;
 			(*term->dispatch.code)(parser, term, 1, offset);
 			buffer = (txInteger*)(((txByte*)*code) + offset);
 			*buffer = cxMatchStep;
+			if (filterOffset) {
+				txString string;
+				buffer = (txInteger*)(((txByte*)*code) + filterOffset);
+				*buffer++ = first;
+				c_memcpy(buffer, filter.bitmap, sizeof(filter.bitmap));
+				buffer += 4;
+				*buffer++ = filter.wide;
+				*buffer++ = filter.prefixLength;
+				*buffer++ = filter.requiredLength;
+				string = (txString)buffer;
+				c_memcpy(string, filter.prefix, filter.prefixLength);
+				string[filter.prefixLength] = 0;
+				string += ((filter.prefixLength + sizeof(txInteger)) / sizeof(txInteger)) * sizeof(txInteger);
+				c_memcpy(string, filter.required, filter.requiredLength);
+				string[filter.requiredLength] = 0;
+			}
+			if (automatonOffset) {
+				buffer = (txInteger*)(((txByte*)*code) + automatonOffset);
+				c_memset(&automaton, 0, sizeof(automaton));
+				automaton.instructions = buffer + 3;
+				fxAutomatonTerm(parser, term, &automaton);
+				fxAutomatonEmit(&automaton, cxAutomatonMatch, 0, 0);
+				*buffer++ = automaton.count;
+				*buffer++ = automaton.threadCount;
+				*buffer = automaton.stackCount + 1;
+			}
 		}
 	}
 	else {
@@ -1696,6 +2096,37 @@ txInteger fxFindCharacter(txString input, txInteger offset, txInteger direction)
 	return p - (txU1*)input;
 }
 
+txInteger fxFilterRegExp(txInteger* filter, txString subject, txInteger start)
+{
+	txString prefix = (txString)(filter + 8);
+	txU1* p;
+	txU1 c;
+	if (filter[6]) {
+		prefix = c_strstr(subject + start, prefix);
+		return prefix ? prefix - subject : -1;
+	}
+	if (filter[0]) {
+		txU4* bitmap = (txU4*)(filter + 1);
+		p = (txU1*)subject + start;
+		while ((c = c_read8(p))) {
+			if (c < 0x80) {
+				if (bitmap[c >> 5] & (1 << (c & 31)))
+					return p - (txU1*)subject;
+				p++;
+			}
+			else if (filter[5])
+				return p - (txU1*)subject;
+			else {
+				p++;
+				while ((c_read8(p) & 0xC0) == 0x80)
+					p++;
+			}
+		}
+		return -1;
+	}
+	return start;
+}
+
 txInteger fxGetCharacter(txString input, txInteger offset, txInteger flags)
 {
 	txInteger character;
@@ -1748,9 +2179,9 @@ txStateData* fxPopStates(txMachine* the, txStateData* fromState, txStateData* to
 	return toState;
 }
 
-txStateData* fxPushState(txMachine* the, txStateData* firstState, txInteger step, txInteger offset, txCaptureData* captures, txInteger captureCount)
+txStateData* fxPushState(txMachine* the, txStateData* firstState, txInteger step, txInteger offset, txCaptureData* captures, txInteger captureCount, txQuantifierData* quantifiers, txInteger quantifierCount)
 {
-	txInteger size = sizeof(txStateData) + ((captureCount - 1) * sizeof(txCaptureData));
+	txInteger size = sizeof(txStateData) + ((captureCount - 1) * sizeof(txCaptureData)) + (quantifierCount * sizeof(txQuantifierData));
 	txStateData* state = C_NULL;
 	if (the && ((firstState == C_NULL) || (firstState->the != C_NULL))) {
 		txByte* current = (txByte*)firstState;
@@ -1775,9 +2206,213 @@ txStateData* fxPushState(txMachine* the, txStateData* firstState, txInteger step
 	state->step = step;
 	state->offset = offset;
 	c_memcpy(state->captures, captures, captureCount * sizeof(txCaptureData));
+	c_memcpy(state->captures + captureCount, quantifiers, quantifierCount * sizeof(txQuantifierData));
 	return state;
 }
 
+void fxAutomatonAdd(txAutomatonData* self, txInteger* thread, txInteger pc, txInteger offset)
+{
+	txInteger* instructions = self->instructions;
+	txInteger* marks = self->marks;
+	txInteger generation = self->generation;
+	txInteger* slots = self->slots;
+	txString subject = self->subject;
+	txInteger flags = self->flags;
+	txInteger* stack = self->stack;
+	txInteger* top = stack;
+	txInteger* instruction;
+	txInteger slot, from, to;
+	// explore the instructions in priority order, restoring slots on the way back
+	*top++ = pc;
+	*top++ = -1;
+	*top++ = 0;
+	while (top > stack) {
+		to = *--top;
+		slot = *--top;
+		pc = *--top;
+		if (slot >= 0) {
+			slots[slot] = to;
+			continue;
+		}
+		while (marks[pc] != generation) {
+			marks[pc] = generation;
+			instruction = instructions + (pc * mxAutomatonInstructionSize);
+			switch (*instruction) {
+			case cxAutomatonJump:
+				pc = instruction[1];
+				continue;
+			case cxAutomatonSplit:
+				*top++ = instruction[2];
+				*top++ = -1;
+				*top++ = 0;
+				pc = instruction[1];
+				continue;
+			case cxAutomatonSave:
+				slot = instruction[1];
+				*top++ = 0;
+				*top++ = slot;
+				*top++ = slots[slot];
+				slots[slot] = offset;
+				pc++;
+				continue;
+			case cxAutomatonReset:
+				from = 2 * instruction[1];
+				to = 2 * instruction[2];
+				while (from < to) {
+					*top++ = 0;
+					*top++ = from;
+					*top++ = slots[from];
+					slots[from] = -1;
+					from++;
+				}
+				pc++;
+				continue;
+			case cxAutomatonLineBegin:
+				if ((offset == 0) || ((flags & XS_REGEXP_M) && fxMatchCharacter((txInteger*)gxLineCharacters, fxGetCharacter(subject, fxFindCharacter(subject, offset, -1), flags)))) {
+					pc++;
+					continue;
+				}
+				break;
+			case cxAutomatonLineEnd:
+				if ((offset == self->stop) || ((flags & XS_REGEXP_M) && fxMatchCharacter((txInteger*)gxLineCharacters, fxGetCharacter(subject, offset, flags)))) {
+					pc++;
+					continue;
+				}
+				break;
+			case cxAutomatonWordBreak:
+				if (fxMatchCharacter((txInteger*)gxWordCharacters, fxGetCharacter(subject, fxFindCharacter(subject, offset, -1), flags)) 
+						!= fxMatchCharacter((txInteger*)gxWordCharacters, fxGetCharacter(subject, offset, flags))) {
+					pc++;
+					continue;
+				}
+				break;
+			case cxAutomatonWordContinue:
+				if (fxMatchCharacter((txInteger*)gxWordCharacters, fxGetCharacter(subject, fxFindCharacter(subject, offset, -1), flags)) 
+						== fxMatchCharacter((txInteger*)gxWordCharacters, fxGetCharacter(subject, offset, flags))) {
+					pc++;
+					continue;
+				}
+				break;
+			default:
+				instruction = thread + (self->threadCount * (1 + self->slotCount));
+				*instruction++ = pc;
+				c_memcpy(instruction, slots, self->slotCount * sizeof(txInteger));
+				self->threadCount++;
+				break;
+			}
+			break;
+		}
+	}
+}
+
+txBoolean fxMatchAutomaton(void* the, txInteger* code, txInteger* data, txInteger* filter, txInteger* automaton, txString subject, txInteger start)
+{
+	txInteger stop = c_strlen(subject);
+	txInteger flags = code[0];
+	txInteger captureCount = code[1];
+	txInteger count = automaton[0];
+	txInteger threadSize = 1 + (2 * captureCount);
+	txInteger size = ((2 * automaton[1] * threadSize) + count + (3 * automaton[2]) + (2 * captureCount)) * sizeof(txInteger);
+	txInteger* buffer = C_NULL;
+	txBoolean borrowed = 0;
+	txInteger* current;
+	txInteger* next;
+	txInteger* thread;
+	txInteger* step;
+	txInteger currentCount = 0, index, offset, nextOffset, character;
+	txAutomatonData _self;
+	txAutomatonData* self = &_self;
+	txBoolean result = 0;
+	txU1 c;
+	if ((start < 0) || (stop < start))
+		return 0;
+	// like states, the buffer is taken from the free part of the stack when possible
+	if (the && (((txByte*)(((txMachine*)the)->stackBottom) + size) < (txByte*)(((txMachine*)the)->stack))) {
+		buffer = (txInteger*)(((txMachine*)the)->stackBottom);
+		borrowed = 1;
+	}
+	else {
+		buffer = c_malloc(size);
+		if (!buffer)
+			return 0;
+	}
+	current = buffer;
+	next = current + (automaton[1] * threadSize);
+	self->instructions = automaton + 3;
+	self->marks = next + (automaton[1] * threadSize);
+	self->generation = 0;
+	self->stack = self->marks + count;
+	self->slots = self->stack + (3 * automaton[2]);
+	self->slotCount = 2 * captureCount;
+	self->subject = subject;
+	self->stop = stop;
+	self->flags = flags;
+	c_memset(self->marks, -1, count * sizeof(txInteger));
+	offset = start;
+	for (;;) {
+		if (!result && (!(flags & XS_REGEXP_Y) || (offset == start))) {
+			// a new thread at each offset, with the lowest priority
+			if (!currentCount) {
+				if (filter && !(flags & XS_REGEXP_Y)) {
+					offset = fxFilterRegExp(filter, subject, offset);
+					if (offset < 0)
+						break;
+				}
+				self->generation++;
+			}
+			c_memset(self->slots, -1, self->slotCount * sizeof(txInteger));
+			self->slots[0] = offset;
+			self->threadCount = currentCount;
+			fxAutomatonAdd(self, current, 0, offset);
+			currentCount = self->threadCount;
+		}
+		if (!currentCount)
+			break;
+		self->generation++;
+		self->threadCount = 0;
+		c = c_read8(subject + offset);
+		if (c < 0x80) {
+			character = c;
+			nextOffset = offset + 1;
+		}
+		else {
+			character = fxGetCharacter(subject, offset, flags);
+			nextOffset = fxFindCharacter(subject, offset, 1);
+		}
+		for (index = 0, thread = current; index < currentCount; index++, thread += threadSize) {
+			txInteger* instruction = self->instructions + (*thread * mxAutomatonInstructionSize);
+			if (*instruction == cxAutomatonMatch) {
+				// lower priority threads are cut
+				c_memcpy(data, thread + 1, self->slotCount * sizeof(txInteger));
+				((txCaptureData*)data)->to = offset;
+				result = 1;
+				break;
+			}
+			if (offset == stop)
+				continue;
+			step = (txInteger*)(((txByte*)code) + instruction[1]);
+			if (c < 0x80) {
+				if (!(((txU4*)(step + 2))[c >> 5] & (1 << (c & 31))))
+					continue;
+			}
+			else if (!fxMatchCharacter(step + 6, character))
+				continue;
+			c_memcpy(self->slots, thread + 1, self->slotCount * sizeof(txInteger));
+			fxAutomatonAdd(self, next, *thread + 1, nextOffset);
+		}
+		thread = current;
+		current = next;
+		next = thread;
+		currentCount = self->threadCount;
+		if (offset == stop)
+			break;
+		offset = nextOffset;
+	}
+	if (!borrowed)
+		c_free(buffer);
+	return result;
+}
+
 #if defined(__GNUC__)
 	#define mxBreak continue
 	#define mxCase(WHICH) WHICH
@@ -1829,18 +2464,42 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 	txAssertionData* assertions = (txAssertionData*)(captures + captureCount);
 	txAssertionData* assertion;
 	txQuantifierData* quantifiers = (txQuantifierData*)(assertions + code[2 + captureCount]);
+	txInteger quantifierCount = code[2 + captureCount + 1];
 	txQuantifierData* quantifier;
 	txStateData* firstState = C_NULL;
-	txInteger from, to, e, f, g;
+	txInteger* filter = code[2 + captureCount + 2] ? (txInteger*)(((txByte*)code) + code[2 + captureCount + 2]) : C_NULL;
+	txInteger* automaton = code[2 + captureCount + 3] ? (txInteger*)(((txByte*)code) + code[2 + captureCount + 3]) : C_NULL;
+	txInteger from, to, e, f, g, budget = 0, origin = start;
 	txBoolean result = 0;
+	txU1 c;
 	
+	if (filter && filter[7] && (0 <= start) && (start <= stop)) {
+		txString required = (txString)(filter + 8) + (((filter[6] + sizeof(txInteger)) / sizeof(txInteger)) * sizeof(txInteger));
+		if (!c_strstr(subject + start, required))
+			return 0;
+	}
+	if (automaton && (start <= stop)) {
+		// backtracking gets about the work of the automaton, then the automaton takes over
+		txInteger length = stop - start + 1, cost = mxAutomatonRatio * automaton[0];
+		budget = (length < (0x7FFFFFFF / cost)) ? length * cost : 0x7FFFFFFF;
+	}
 	while (!result && (0 <= start) && (start <= stop)) {
-		txInteger step = (2 + captureCount + 2) * sizeof(txInteger), sequel;
-		txInteger offset = start;
+		txInteger step = (2 + captureCount + 4) * sizeof(txInteger), sequel;
+		txInteger offset;
+		if (filter && !(flags & XS_REGEXP_Y)) {
+			start = fxFilterRegExp(filter, subject, start);
+			if (start < 0)
+				break;
+		}
+		offset = start;
 		c_memset(captures, -1, captureCount * sizeof(txCaptureData));
 		while (step) {
 			txInteger* pointer = (txInteger*)(((txByte*)code) + step);
 			txInteger which = *pointer++;
+			if (automaton && (--budget < 0)) {
+				fxPopStates(the, firstState, C_NULL);
+				return fxMatchAutomaton(the, code, data, filter, automaton, subject, origin);
+			}
 			#ifdef mxTrace 
 			{
 				txInteger captureIndex;
@@ -1885,7 +2544,7 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 					assertion->offset = offset;
 					assertion->firstState = firstState;
 					sequel = *pointer;
-					firstState = fxPushState(the, firstState, sequel, offset, captures, captureCount);
+					firstState = fxPushState(the, firstState, sequel, offset, captures, captureCount, quantifiers, quantifierCount);
 					if (!firstState)
 						return 0;
 					mxBreak;
@@ -1980,8 +2639,15 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 					e = offset;
 					if (e == 0)
 						goto mxPopState;
+					c = c_read8(subject + e - 1);
+					if (c < 0x80) {
+						if (!(((txU4*)pointer)[c >> 5] & (1 << (c & 31))))
+							goto mxPopState;
+						offset = e - 1;
+						mxBreak;
+					}
 					e = fxFindCharacter(subject, e, -1);
-					if (!fxMatchCharacter(pointer, fxGetCharacter(subject, e, flags)))
+					if (!fxMatchCharacter(pointer + 4, fxGetCharacter(subject, e, flags)))
 						goto mxPopState;
 					offset = e;
 					mxBreak;
@@ -1990,7 +2656,14 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 					e = offset;
 					if (e == stop)
 						goto mxPopState;
-					if (!fxMatchCharacter(pointer, fxGetCharacter(subject, e, flags)))
+					c = c_read8(subject + e);
+					if (c < 0x80) {
+						if (!(((txU4*)pointer)[c >> 5] & (1 << (c & 31))))
+							goto mxPopState;
+						offset = e + 1;
+						mxBreak;
+					}
+					if (!fxMatchCharacter(pointer + 4, fxGetCharacter(subject, e, flags)))
 						goto mxPopState;
 					e = fxFindCharacter(subject, e, 1);
 					offset = e;
@@ -1998,7 +2671,7 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 				mxCase(cxDisjunctionStep):
 					step = *pointer++;
 					sequel = *pointer;
-					firstState = fxPushState(the, firstState, sequel, offset, captures, captureCount);
+					firstState = fxPushState(the, firstState, sequel, offset, captures, captureCount, quantifiers, quantifierCount);
 					if (!firstState)
 						return 0;
 					mxBreak;
@@ -2049,10 +2722,11 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 					}
 					else {
 						if (quantifier->min == 0) {
-							firstState = fxPushState(the, firstState, sequel, offset, captures, captureCount);
+							firstState = fxPushState(the, firstState, sequel, offset, captures, captureCount, quantifiers, quantifierCount);
 							if (!firstState)
 								return 0;
 						}
+						quantifier->offset = offset;
 						if (from < to)
 							c_memset(captures + from, -1, (to - from) * sizeof(txCaptureData));
 					}
@@ -2075,12 +2749,13 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 						step = sequel;
 						mxBreak;
 					}
+					quantifier->offset = offset;
 					if (quantifier->min == 0) {
-						firstState = fxPushState(the, firstState, step, offset, captures, captureCount);
+						firstState = fxPushState(the, firstState, step, offset, captures, captureCount, quantifiers, quantifierCount);
 						if (!firstState)
 							return 0;
 						if (from < to)
-							c_memset(captures + from, -1, (to - from) * sizeof(txCaptureData));
+							c_memset(firstState->captures + from, -1, (to - from) * sizeof(txCaptureData));
 						step = sequel;
 					}
 					else {
@@ -2095,10 +2770,8 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 					#endif
 					quantifier = quantifiers + *pointer++;
 					sequel = *pointer;
-					if ((quantifier->min == 0) && (quantifier->offset == offset)) {
-						step = sequel;
-						mxBreak;
-					}
+					if ((quantifier->min == 0) && (quantifier->offset == offset))
+						goto mxPopState;
 					quantifier->min = (quantifier->min == 0) ? 0 : quantifier->min - 1;
 					quantifier->max = (quantifier->max == 0x7FFFFFFF) ? 0x7FFFFFFF : quantifier->max - 1;
 					mxBreak;
@@ -2126,6 +2799,7 @@ txBoolean fxMatchRegExp(void* the, txInteger* code, txInteger* data, txString su
 					step = firstState->step;
 					offset = firstState->offset;
 					c_memcpy(captures, firstState->captures, captureCount * sizeof(txCaptureData));
+					c_memcpy(quantifiers, firstState->captures + captureCount, quantifierCount * sizeof(txQuantifierData));
 					if (firstState->the)
 						firstState = firstState->nextState;
 					else {
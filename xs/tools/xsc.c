@@ -261,6 +261,7 @@ int main(int argc, char* argv[])
 	txString map = NULL;
 	txString dot = NULL;
 	FILE* file = NULL;
+	txParserSource source;
 	txScript* script = NULL;
 	txSize size;
 	txByte byte;
@@ -291,6 +292,8 @@ int main(int argc, char* argv[])
 			}
 			else if (!strcmp(argv[argi], "-m"))
 				flags |= mxCommonModuleFlag;
+			else if (!strcmp(argv[argi], "-O"))
+				parser->optimizeFlag = 1;
 			else if (!strcmp(argv[argi], "-p"))
 				flags |= mxProgramFlag;
 			else if (!strcmp(argv[argi], "-r")) {
@@ -331,17 +334,19 @@ int main(int argc, char* argv[])
 		parser->origin = parser->path = fxNewParserSymbol(parser, input);
 		file = fopen(input, "r");
 		mxParserThrowElse(file);
-		fxParserTree(parser, file, (txGetter)fgetc, flags, &name);
+		fxReadParserSource(parser, file, &source);
 		fclose(file);
 		file = NULL;
+		fxParserTree(parser, &source, fxParserSourceGetter, flags, &name);
 		if (name) {
 			map = fxCombinePath(parser, input, name);
 			parser->path = fxNewParserSymbol(parser, map);
 			file = fopen(map, "r");
 			mxParserThrowElse(file);
-			fxParserSourceMap(parser, file, (txGetter)fgetc, flags, &name);
+			fxReadParserSource(parser, file, &source);
 			fclose(file);
 			file = NULL;
+			fxParserSourceMap(parser, &source, fxParserSourceGetter, flags, &name);
 			map = fxCombinePath(parser, map, name);
 			parser->path = fxNewParserSymbol(parser, map);
 		}
@@ -36,6 +36,7 @@
 	#define fxLockMutex(MUTEX) EnterCriticalSection(MUTEX)
 	#define fxUnlockMutex(MUTEX) LeaveCriticalSection(MUTEX)
 	#define fxSleepCondition(CONDITION,MUTEX) SleepConditionVariableCS(CONDITION,MUTEX,INFINITE)
+	#define fxWakeAllConditions(CONDITION) WakeAllConditionVariable(CONDITION)
 	#define fxWakeCondition(CONDITION) WakeConditionVariable(CONDITION)
 #else
 	#include <dirent.h>
@@ -52,16 +53,20 @@
 	#define fxLockMutex(MUTEX) pthread_mutex_lock(MUTEX)
 	#define fxUnlockMutex(MUTEX) pthread_mutex_unlock(MUTEX)
 	#define fxSleepCondition(CONDITION,MUTEX) pthread_cond_wait(CONDITION,MUTEX)
+	#define fxWakeAllConditions(CONDITION) pthread_cond_broadcast(CONDITION)
 	#define fxWakeCondition(CONDITION) pthread_cond_signal(CONDITION)
 #endif
 
 typedef struct sxAgent txAgent;
 typedef struct sxAgentCluster txAgentCluster;
 typedef struct sxAgentReport txAgentReport;
+typedef struct sxBuffer txBuffer;
 typedef struct sxContext txContext;
 typedef struct sxJob txJob;
 typedef void (*txJobCallback)(txJob*);
+typedef struct sxQueue txQueue;
 typedef struct sxResult txResult;
+typedef struct sxTask txTask;
 
 struct sxAgent {
 	txAgent* next;
@@ -97,10 +102,17 @@ struct sxAgentCluster {
 	txMutex reportMutex;
 };
 
+struct sxBuffer {
+	char* data;
+	size_t size;
+	size_t length;
+};
+
 struct sxContext {
 	char harnessPath[C_PATH_MAX];
 	int testPathLength;
 	txResult* current;
+	txTask* task;
 	yaml_document_t* document;
 	yaml_node_t* includes;
 	yaml_node_t* negative;
@@ -122,6 +134,15 @@ struct sxJob {
 	txNumber interval;
 };
 
+struct sxQueue {
+	txTask* firstTask;
+	txTask* lastTask;
+	txTask* nextTask;
+	int threadCount;
+	txCondition condition;
+	txMutex mutex;
+};
+
 struct sxResult {
 	txResult* next;
 	txResult* parent;
@@ -133,13 +154,44 @@ struct sxResult {
 	char path[1];
 };
 
+enum {
+	XST_TASK_WAITING = 0,
+	XST_TASK_RUNNING,
+	XST_TASK_DONE,
+	XST_TASK_MAIN,
+};
+
+struct sxTask {
+	txTask* next;
+	txResult* result;
+	int state;
+	int deferred;
+	int testCount;
+	int successCount;
+	int pendingCount;
+	txBuffer error;
+	txBuffer output;
+	char path[1];
+};
+
 static void fxCountResult(txContext* context, int success, int pending);
 static yaml_node_t *fxGetMappingValue(yaml_document_t* document, yaml_node_t* mapping, char* name);
 static void fxPopResult(txContext* context);
+static xsMachine* fxPrepareMachine(txContext* context);
+static void fxPrintBuffer(txBuffer* buffer, char* format, va_list arguments);
+static void fxPrintContext(txContext* context, FILE* file, char* format, ...);
 static void fxPrintResult(txContext* context, txResult* result, int c);
 static void fxPushResult(txContext* context, char* path);
+static void fxPushTask(txContext* context, char* path);
 static void fxRunDirectory(txContext* context, char* path);
 static void fxRunFile(txContext* context, char* path);
+static void fxRunHarness(txContext* context, txMachine* the);
+static void fxRunQueue(txContext* context);
+#if mxWindows
+static unsigned int __stdcall fxRunTasks(void* it);
+#else
+static void* fxRunTasks(void* it);
+#endif
 static int fxRunTestCase(txContext* context, char* path, txUnsigned flags, char* message);
 static int fxStringEndsWith(const char *string, const char *suffix);
 
@@ -182,6 +234,9 @@ static txHostHooks gxTimerHooks = {
 };
 
 static txAgentCluster gxAgentCluster;
+static txQueue gxQueue;
+static xsMachine* gxSharedMachine = C_NULL;
+static xsSnapshot* gxSnapshot = C_NULL;
 
 int main(int argc, char* argv[]) 
 {
@@ -189,6 +244,8 @@ int main(int argc, char* argv[])
 	char separator[2];
 	char path[C_PATH_MAX];
 	int error = 0;
+	int share = 0;
+	int snapshot = 0;
 	int argi = 1;
 	
 	c_memset(&context, 0, sizeof(txContext));
@@ -199,6 +256,28 @@ int main(int argc, char* argv[])
 	fxCreateCondition(&(gxAgentCluster.dataCondition));
 	fxCreateMutex(&(gxAgentCluster.dataMutex));
 	fxCreateMutex(&(gxAgentCluster.reportMutex));
+	
+	c_memset(&gxQueue, 0, sizeof(txQueue));
+	gxQueue.threadCount = 1;
+	while (argc > argi) {
+		if (!c_strncmp(argv[argi], "-j", 2)) {
+			if (argv[argi][2])
+				gxQueue.threadCount = (int)c_strtol(argv[argi] + 2, C_NULL, 10);
+			else if (argc > argi + 1)
+				gxQueue.threadCount = (int)c_strtol(argv[++argi], C_NULL, 10);
+			if (gxQueue.threadCount < 1) {
+				fprintf(stderr, "### invalid thread count: %s\n", argv[argi]);
+				return 1;
+			}
+		}
+		else if (!c_strcmp(argv[argi], "-s"))
+			share = 1;
+		else if (!c_strcmp(argv[argi], "-r"))
+			snapshot = 1;
+		else
+			break;
+		argi++;
+	}
 
 	separator[0] = mxSeparator;
 	separator[1] = 0;
@@ -218,6 +297,25 @@ int main(int argc, char* argv[])
 	context.testPathLength = c_strlen(path);
 	context.current = NULL;
 	fxPushResult(&context, "");
+	if (share) {
+		gxSharedMachine = fxPrepareMachine(&context);
+		if (!gxSharedMachine) {
+			fprintf(stderr, "### cannot prepare shared machine\n");
+			return 1;
+		}
+		xsShareMachine(gxSharedMachine);
+	}
+	else if (snapshot) {
+		xsMachine* machine = fxPrepareMachine(&context);
+		if (machine) {
+			gxSnapshot = xsSnapshotMachine(machine);
+			xsDeleteMachine(machine);
+		}
+		if (!gxSnapshot) {
+			fprintf(stderr, "### cannot snapshot machine\n");
+			return 1;
+		}
+	}
 	
 	while (argi < argc) {
 		if (c_realpath(argv[argi], path)) {
@@ -244,7 +342,13 @@ int main(int argc, char* argv[])
 		}
 		argi++;
 	}
+	if (gxQueue.threadCount > 1)
+		fxRunQueue(&context);
 	fxPrintResult(&context, context.current, 0);
+	if (gxSharedMachine)
+		xsDeleteMachine(gxSharedMachine);
+	if (gxSnapshot)
+		xsDeleteSnapshot(gxSnapshot);
 #ifdef mxInstrument
 	fprintf(stderr, "# parser chunks: %d bytes\n", context.parserTotal);
 	fprintf(stderr, "# heap chunks: %d bytes\n", context.peakChunksSize);
@@ -257,6 +361,13 @@ int main(int argc, char* argv[])
 void fxCountResult(txContext* context, int success, int pending) 
 {
 	txResult* result = context->current;
+	txTask* task = context->task;
+	if (task) {
+		task->testCount++;
+		task->successCount += success;
+		task->pendingCount += pending;
+		return;
+	}
 	while (result) {
 		result->testCount++;
 		result->successCount += success;
@@ -283,6 +394,76 @@ void fxPopResult(txContext* context)
 	context->current = context->current->parent;
 }
 
+xsMachine* fxPrepareMachine(txContext* context)
+{
+	xsCreation _creation = {
+		1 * 1024 * 1024, 	/* initialChunkSize */
+		1 * 1024 * 1024, 	/* incrementalChunkSize */
+		64 * 1024, 		/* initialHeapCount */
+		16 * 1024, 		/* incrementalHeapCount */
+		1024, 		/* stackCount */
+		4096*3, 		/* keyCount */
+		1993, 		/* nameModulo */
+		127 		/* symbolModulo */
+	};
+	xsCreation* creation = &_creation;
+	xsMachine* machine;
+	int success = 1;
+	machine = xsCreateMachine(creation, "xst-shared", NULL);
+	if (!machine)
+		return C_NULL;
+	machine->host = context;
+	xsBeginHost(machine);
+	{
+		xsTry {
+			fxRunHarness(context, the);
+		}
+		xsCatch {
+			success = 0;
+		}
+	}
+	xsEndHost(machine);
+	if (!success) {
+		xsDeleteMachine(machine);
+		return C_NULL;
+	}
+	machine->host = C_NULL;
+	return machine;
+}
+
+void fxPrintBuffer(txBuffer* buffer, char* format, va_list arguments)
+{
+	va_list copy;
+	int length;
+	va_copy(copy, arguments);
+	length = vsnprintf(C_NULL, 0, format, copy);
+	va_end(copy);
+	if (length < 0)
+		return;
+	if (buffer->length + length + 1 > buffer->size) {
+		size_t size = 2 * (buffer->length + length + 1);
+		char* data = c_realloc(buffer->data, size);
+		if (!data) {
+			c_exit(1);
+		}
+		buffer->data = data;
+		buffer->size = size;
+	}
+	vsnprintf(buffer->data + buffer->length, length + 1, format, arguments);
+	buffer->length += length;
+}
+
+void fxPrintContext(txContext* context, FILE* file, char* format, ...)
+{
+	va_list arguments;
+	va_start(arguments, format);
+	if (context && context->task)
+		fxPrintBuffer((file == stdout) ? &context->task->output : &context->task->error, format, arguments);
+	else
+		vfprintf(file, format, arguments);
+	va_end(arguments);
+}
+
 void fxPrintResult(txContext* context, txResult* result, int c)
 {
 	int i = 0;
@@ -331,6 +512,22 @@ void fxPushResult(txContext* context, char* path)
 	context->current = result;
 }
 
+void fxPushTask(txContext* context, char* path) 
+{
+	txTask* task = c_malloc(sizeof(txTask) + c_strlen(path));
+	if (!task) {
+		c_exit(1);
+	}
+	c_memset(task, 0, sizeof(txTask));
+	task->result = context->current;
+	c_strcpy(task->path, path);
+	if (gxQueue.lastTask)
+		gxQueue.lastTask->next = task;
+	else
+		gxQueue.firstTask = task;
+	gxQueue.lastTask = task;
+}
+
 void fxRunDirectory(txContext* context, char* path)
 {
 	typedef struct sxEntry txEntry;
@@ -461,6 +658,10 @@ void fxRunFile(txContext* context, char* path)
 	int pending = 0;
 	char message[1024];
 	
+	if ((gxQueue.threadCount > 1) && !context->task) {
+		fxPushTask(context, path);
+		return;
+	}
 	file = fopen(path, "rb");
 	if (!file) goto bail;
 	fseek(file, 0, SEEK_END);
@@ -479,6 +680,14 @@ void fxRunFile(txContext* context, char* path)
 	begin += 5;
 	end = strstr(begin, "---*/");
 	if (!end) goto bail;
+	
+	if (context->task && (context->task->state == XST_TASK_RUNNING)) {
+		// agents and Atomics.wait depend on process wide state and on the main thread
+		if (strstr(buffer, "$262.agent") || strstr(buffer, "Atomics")) {
+			context->task->deferred = 1;
+			goto bail;
+		}
+	}
 
 	if (!yaml_parser_initialize(&_parser)) goto bail;
 	parser = &_parser;
@@ -549,28 +758,28 @@ void fxRunFile(txContext* context, char* path)
 	}
 
 	if (sloppy) {
-		fprintf(stderr, "### %s (sloppy): ", path + context->testPathLength);
+		fxPrintContext(context, stderr, "### %s (sloppy): ", path + context->testPathLength);
 		if (fxRunTestCase(context, path, mxProgramFlag | mxDebugFlag, message))
-			fprintf(stderr, "%s\n", message);
+			fxPrintContext(context, stderr, "%s\n", message);
 		else
-			fprintf(stderr, "%s\n", message);
+			fxPrintContext(context, stderr, "%s\n", message);
 	}
 	if (strict) {
-		fprintf(stderr, "### %s (strict): ", path + context->testPathLength);
+		fxPrintContext(context, stderr, "### %s (strict): ", path + context->testPathLength);
 		if (fxRunTestCase(context, path, mxProgramFlag | mxDebugFlag | mxStrictFlag, message))
-			fprintf(stderr, "%s\n", message);
+			fxPrintContext(context, stderr, "%s\n", message);
 		else
-			fprintf(stderr, "%s\n", message);
+			fxPrintContext(context, stderr, "%s\n", message);
 	}
 	if (module) {
-		fprintf(stderr, "### %s (module): ", path + context->testPathLength);
+		fxPrintContext(context, stderr, "### %s (module): ", path + context->testPathLength);
 		if (fxRunTestCase(context, path, 0, message))
-			fprintf(stderr, "%s\n", message);
+			fxPrintContext(context, stderr, "%s\n", message);
 		else
-			fprintf(stderr, "%s\n", message);
+			fxPrintContext(context, stderr, "%s\n", message);
 	}
 	if (pending) {
-		fprintf(stderr, "### %s: SKIP\n", path + context->testPathLength);
+		fxPrintContext(context, stderr, "### %s: SKIP\n", path + context->testPathLength);
 		fxCountResult(context, 0, 1);
 	}
 bail:	
@@ -587,6 +796,165 @@ bail:
 		fclose(file);
 }
 
+void fxRunHarness(txContext* context, txMachine* the)
+{
+	char buffer[C_PATH_MAX];
+	fxNewHostFunctionGlobal(the, fx_print, 1, xsID("print"), XS_DONT_ENUM_FLAG);
+	the->stack++;
+	fxNewHostFunctionGlobal(the, fx_clearTimer, 1, xsID("clearInterval"), XS_DONT_ENUM_FLAG);
+	the->stack++;
+	fxNewHostFunctionGlobal(the, fx_clearTimer, 1, xsID("clearTimeout"), XS_DONT_ENUM_FLAG);
+	the->stack++;
+	fxNewHostFunctionGlobal(the, fx_setInterval, 1, xsID("setInterval"), XS_DONT_ENUM_FLAG);
+	the->stack++;
+	fxNewHostFunctionGlobal(the, fx_setTimeout, 1, xsID("setTimeout"), XS_DONT_ENUM_FLAG);
+	the->stack++;
+	fxNewHostFunctionGlobal(the, fx_done, 1, xsID("$DONE"), XS_DONT_ENUM_FLAG);
+	the->stack++;
+
+	c_strcpy(buffer, context->harnessPath);
+	c_strcat(buffer, "sta.js");
+	fxRunProgram(the, buffer, mxProgramFlag | mxDebugFlag);
+	c_strcpy(buffer, context->harnessPath);
+	c_strcat(buffer, "assert.js");
+	fxRunProgram(the, buffer, mxProgramFlag | mxDebugFlag);
+}
+
+void fxRunQueue(txContext* context)
+{
+	txContext* contexts;
+#if mxWindows
+	HANDLE* threads;
+#else
+	pthread_t* threads;
+#endif
+	txTask* task;
+	txResult* result;
+	int count = 0, started, i;
+	
+	task = gxQueue.firstTask;
+	while (task && (count < gxQueue.threadCount)) {
+		count++;
+		task = task->next;
+	}
+	if (!count)
+		return;
+	contexts = c_calloc(count, sizeof(txContext));
+	threads = c_calloc(count, sizeof(*threads));
+	if (!contexts || !threads) {
+		c_exit(1);
+	}
+	fxCreateCondition(&(gxQueue.condition));
+	fxCreateMutex(&(gxQueue.mutex));
+	gxQueue.nextTask = gxQueue.firstTask;
+	fxInitializeSharedCluster();
+	for (i = 0; i < count; i++) {
+		c_strcpy(contexts[i].harnessPath, context->harnessPath);
+		contexts[i].testPathLength = context->testPathLength;
+	#if mxWindows
+		threads[i] = (HANDLE)_beginthreadex(NULL, 0, fxRunTasks, &contexts[i], 0, NULL);
+		if (!threads[i])
+			break;
+	#else	
+		if (pthread_create(&threads[i], NULL, &fxRunTasks, &contexts[i]))
+			break;
+	#endif
+	}
+	started = i;
+	if (started < count)
+		fprintf(stderr, "### %d threads started instead of %d\n", started, count);
+	if (!started)
+		fxRunTasks(&contexts[0]);
+	while ((task = gxQueue.firstTask)) {
+		fxLockMutex(&(gxQueue.mutex));
+		while (task->state < XST_TASK_DONE)
+			fxSleepCondition(&(gxQueue.condition), &(gxQueue.mutex));
+		fxUnlockMutex(&(gxQueue.mutex));
+		if (task->state == XST_TASK_MAIN) {
+			context->task = task;
+			fxRunFile(context, task->path);
+			context->task = C_NULL;
+		}
+		if (task->error.length)
+			fwrite(task->error.data, 1, task->error.length, stderr);
+		if (task->output.length)
+			fwrite(task->output.data, 1, task->output.length, stdout);
+		fflush(stdout);
+		result = task->result;
+		while (result) {
+			result->testCount += task->testCount;
+			result->successCount += task->successCount;
+			result->pendingCount += task->pendingCount;
+			result = result->parent;
+		}
+		gxQueue.firstTask = task->next;
+		if (task->error.data)
+			c_free(task->error.data);
+		if (task->output.data)
+			c_free(task->output.data);
+		c_free(task);
+	}
+	gxQueue.lastTask = C_NULL;
+	for (i = 0; i < count; i++) {
+		if (i < started) {
+		#if mxWindows
+			WaitForSingleObject(threads[i], INFINITE);
+			CloseHandle(threads[i]);
+		#else
+			pthread_join(threads[i], NULL);
+		#endif
+		}
+	#ifdef mxInstrument
+		if (context->peakChunksSize < contexts[i].peakChunksSize)
+			context->peakChunksSize = contexts[i].peakChunksSize;
+		if (context->peakHeapCount < contexts[i].peakHeapCount)
+			context->peakHeapCount = contexts[i].peakHeapCount;
+		if (context->peakStackCount < contexts[i].peakStackCount)
+			context->peakStackCount = contexts[i].peakStackCount;
+		if (context->parserTotal < contexts[i].parserTotal)
+			context->parserTotal = contexts[i].parserTotal;
+	#endif
+	}
+	fxTerminateSharedCluster();
+	fxDeleteMutex(&(gxQueue.mutex));
+	fxDeleteCondition(&(gxQueue.condition));
+	c_free(threads);
+	c_free(contexts);
+}
+
+#if mxWindows
+unsigned int __stdcall fxRunTasks(void* it)
+#else
+void* fxRunTasks(void* it)
+#endif
+{
+	txContext* context = it;
+	txTask* task;
+	for (;;) {
+		fxLockMutex(&(gxQueue.mutex));
+		task = gxQueue.nextTask;
+		if (task) {
+			gxQueue.nextTask = task->next;
+			task->state = XST_TASK_RUNNING;
+		}
+		fxUnlockMutex(&(gxQueue.mutex));
+		if (!task)
+			break;
+		context->task = task;
+		fxRunFile(context, task->path);
+		context->task = C_NULL;
+		fxLockMutex(&(gxQueue.mutex));
+		task->state = (task->deferred) ? XST_TASK_MAIN : XST_TASK_DONE;
+		fxWakeAllConditions(&(gxQueue.condition));
+		fxUnlockMutex(&(gxQueue.mutex));
+	}
+#if mxWindows
+	return 0;
+#else
+	return NULL;
+#endif
+}
+
 int fxRunTestCase(txContext* context, char* path, txUnsigned flags, char* message)
 {
 	xsCreation _creation = {
@@ -603,8 +971,15 @@ int fxRunTestCase(txContext* context, char* path, txUnsigned flags, char* messag
 	xsMachine* machine;
 	char buffer[C_PATH_MAX];
 	int success = 0;
-	fxInitializeSharedCluster();
-	machine = xsCreateMachine(creation, "xst", NULL);
+	if (gxQueue.threadCount == 1)
+		fxInitializeSharedCluster();
+	if (gxSharedMachine)
+		machine = xsCloneMachine(creation, gxSharedMachine, "xst", NULL);
+	else if (gxSnapshot)
+		machine = xsRestoreMachine(creation, gxSnapshot, "xst", NULL);
+	else
+		machine = xsCreateMachine(creation, "xst", NULL);
+	machine->host = context;
 	xsBeginHost(machine);
 	{
 		xsTry {
@@ -632,25 +1007,8 @@ int fxRunTestCase(txContext* context, char* path, txUnsigned flags, char* messag
 			
 			the->stack++;
 		
-			fxNewHostFunctionGlobal(the, fx_print, 1, xsID("print"), XS_DONT_ENUM_FLAG);
-			the->stack++;
-			fxNewHostFunctionGlobal(the, fx_clearTimer, 1, xsID("clearInterval"), XS_DONT_ENUM_FLAG);
-			the->stack++;
-			fxNewHostFunctionGlobal(the, fx_clearTimer, 1, xsID("clearTimeout"), XS_DONT_ENUM_FLAG);
-			the->stack++;
-			fxNewHostFunctionGlobal(the, fx_setInterval, 1, xsID("setInterval"), XS_DONT_ENUM_FLAG);
-			the->stack++;
-			fxNewHostFunctionGlobal(the, fx_setTimeout, 1, xsID("setTimeout"), XS_DONT_ENUM_FLAG);
-			the->stack++;
-			fxNewHostFunctionGlobal(the, fx_done, 1, xsID("$DONE"), XS_DONT_ENUM_FLAG);
-			the->stack++;
-
-			c_strcpy(buffer, context->harnessPath);
-			c_strcat(buffer, "sta.js");
-			fxRunProgram(the, buffer, mxProgramFlag | mxDebugFlag);
-			c_strcpy(buffer, context->harnessPath);
-			c_strcat(buffer, "assert.js");
-			fxRunProgram(the, buffer, mxProgramFlag | mxDebugFlag);
+			if (!gxSharedMachine && !gxSnapshot)
+				fxRunHarness(context, the);
 			if (context->includes) {
 				yaml_node_item_t* item = context->includes->data.sequence.items.start;
 				while (item < context->includes->data.sequence.items.top) {
@@ -713,7 +1071,8 @@ int fxRunTestCase(txContext* context, char* path, txUnsigned flags, char* messag
 #endif
 	xsEndHost(the);
 	xsDeleteMachine(machine);
-	fxTerminateSharedCluster();
+	if (gxQueue.threadCount == 1)
+		fxTerminateSharedCluster();
 	fxCountResult(context, success, 0);
 	return success;
 }
@@ -848,7 +1207,13 @@ void* fx_agent_start_aux(void* it)
 		127 		/* symbolModulo */
 	};
 	txAgent* agent = it;
-	xsMachine* machine = xsCreateMachine(&creation, "xst-agent", NULL);
+	xsMachine* machine;
+	if (gxSharedMachine)
+		machine = xsCloneMachine(&creation, gxSharedMachine, "xst-agent", NULL);
+	else if (gxSnapshot)
+		machine = xsRestoreMachine(&creation, gxSnapshot, "xst-agent", NULL);
+	else
+		machine = xsCreateMachine(&creation, "xst-agent", NULL);
 	machine->host = it;
 	xsBeginHost(machine);
 	{
@@ -893,7 +1258,12 @@ void* fx_agent_start_aux(void* it)
 
 void fx_agent_stop(xsMachine* the)
 {
+	txContext* context = the->host;
 	txAgent* agent = gxAgentCluster.firstAgent;
+	if (!agent)
+		return;
+	if (context && context->task && (context->task->state == XST_TASK_RUNNING))
+		return;
 	while (agent) {
 		txAgent* next = agent->next;
 		if (agent->thread) {
@@ -955,7 +1325,7 @@ void fx_evalScript(xsMachine* the)
 
 void fx_print(xsMachine* the)
 {
-	fprintf(stdout, "%s\n", xsToString(xsArg(0)));
+	fxPrintContext(the->host, stdout, "%s\n", xsToString(xsArg(0)));
 }
 
 void fx_clearTimer(txMachine* the)
@@ -1137,6 +1507,8 @@ void fxConnect(txMachine* the)
 	char* colon;
 	int port;
 	struct sockaddr_in address;
+	if (gxQueue.threadCount > 1)
+		return;
 #if mxWindows
 	if (GetEnvironmentVariable("XSBUG_HOST", name, sizeof(name))) {
 #else
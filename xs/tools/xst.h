@@ -74,12 +74,14 @@
 	#include <arpa/inet.h>
 	#include <netdb.h>
 	#include <linux/futex.h>
+	#include <sys/mman.h>
 	#include <sys/syscall.h>
 	#include <unistd.h>
 	typedef int txSocket;
 	#define mxNoSocket -1
 	#define mxUseGCCAtomics 1
 	#define mxUseLinuxFutex 1
+	#define mxProtectSharedMachine 1
 	#define mxMachinePlatform \
 		txSocket connection; \
 		void* host;